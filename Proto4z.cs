@@ -275,6 +275,76 @@ static public ulong decodeUI64(byte[] binData, ref int pos)
             return v;
         }
 
+        //fixedN(range,precision): round(v / precision) clamp to +-limit, little endian signed integer of bytes width.
+        static public System.Collections.Generic.List<byte> encodeFixed(float v, double precision, long limit, int bytes)
+        {
+            double q = v * (1.0 / precision);
+            q = double.IsNaN(q) ? 0 : System.Math.Min(System.Math.Max(q, -limit), limit);
+            long n = (long)(q < 0 ? q - 0.5 : q + 0.5);
+            var ret = new System.Collections.Generic.List<byte>(bytes);
+            for (int i = 0; i < bytes; i++)
+                ret.Add((byte)(n >> (8 * i)));
+            return ret;
+        }
+        static public float decodeFixed(byte[] binData, ref int pos, double precision, int bytes)
+        {
+            long n = 0;
+            for (int i = 0; i < bytes; i++)
+                n |= (long)binData[pos + i] << (8 * i);
+            n = (n << (64 - 8 * bytes)) >> (64 - 8 * bytes);
+            pos += bytes;
+            return (float)(n * precision);
+        }
+        //angleN: degree, one turn is 2^N steps, little endian unsigned integer of bytes width.
+        static public System.Collections.Generic.List<byte> encodeAngle(float degree, int bytes)
+        {
+            double turn = degree / 360.0;
+            turn -= System.Math.Floor(turn);
+            turn = double.IsNaN(turn) ? 0 : turn;
+            ulong n = (ulong)(turn * (1UL << (8 * bytes)) + 0.5);
+            var ret = new System.Collections.Generic.List<byte>(bytes);
+            for (int i = 0; i < bytes; i++)
+                ret.Add((byte)(n >> (8 * i)));
+            return ret;
+        }
+        static public float decodeAngle(byte[] binData, ref int pos, int bytes)
+        {
+            ulong n = 0;
+            for (int i = 0; i < bytes; i++)
+                n |= (ulong)binData[pos + i] << (8 * i);
+            pos += bytes;
+            return (float)(n * 360.0 / (1UL << (8 * bytes)));
+        }
+
+        //bool and bits:N members share one bitmap, bit 0 is the lowest bit of the first byte.
+        //a field is moved with one shift and mask per touched byte.
+        static public void encodeBits(byte[] bits, int bitPos, ulong v, int count)
+        {
+            while (count > 0)
+            {
+                int shift = bitPos & 7;
+                int take = System.Math.Min(8 - shift, count);
+                bits[bitPos >> 3] |= (byte)((v & ((1UL << take) - 1)) << shift);
+                v >>= take;
+                bitPos += take;
+                count -= take;
+            }
+        }
+        static public ulong decodeBits(byte[] binData, int pos, int bitPos, int count)
+        {
+            ulong v = 0;
+            int got = 0;
+            while (got < count)
+            {
+                int shift = bitPos & 7;
+                int take = System.Math.Min(8 - shift, count - got);
+                v |= (ulong)((binData[pos + (bitPos >> 3)] >> shift) & ((1 << take) - 1)) << got;
+                bitPos += take;
+                got += take;
+            }
+            return v;
+        }
+
         static public System.Collections.Generic.List<byte> encodeSingle(float v)
         {
             byte[] bin = System.BitConverter.GetBytes(v);
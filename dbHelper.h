@@ -40,6 +40,11 @@
 
 namespace  zsummer
 {
+    namespace proto4z
+    {
+        template<unsigned int Capacity>
+        class FixedString;
+    }
     namespace mysql
     {
         //! the result error code when excute mysql querys.
@@ -565,6 +570,13 @@ namespace  zsummer
             t = result.popOrgField();
             return result;
         }
+        //! genProto store maxlen string member as proto4z::FixedString. throw when the field over capacity.
+        template<unsigned int Capacity>
+        inline DBResult & operator >>(DBResult &result, zsummer::proto4z::FixedString<Capacity> & t)
+        {
+            t = result.popOrgField();
+            return result;
+        }
 
 
 
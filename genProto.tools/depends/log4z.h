@@ -174,6 +174,7 @@
 #endif
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <list>
 #include <queue>
 #include <deque>
@@ -506,6 +507,8 @@ public:
     inline Log4zStream & operator <<(const std::queue<_Elem, _Alloc> & t){ *this << "queue[size="; *this << t.size(); return *this << "]"; }
     template<class _K, class _V, class _Pr, class _Alloc>
     inline Log4zStream & operator <<(const std::map<_K, _V, _Pr, _Alloc> & t){ *this << "map[size="; *this << t.size(); return *this << "]"; }
+    template<class _K, class _V, class _Hash, class _Eq, class _Alloc>
+    inline Log4zStream & operator <<(const std::unordered_map<_K, _V, _Hash, _Eq, _Alloc> & t){ *this << "unordered_map[size="; *this << t.size(); return *this << "]"; }
 
 private:
     Log4zStream(){}
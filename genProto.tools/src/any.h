@@ -94,6 +94,10 @@ struct DataArray
     std::string _type;
     std::string _arrayName;
     std::string _desc;
+    bool _columnar = false; //encode packet member by member as column
+    unsigned int _capacity = 0; //inline fixed capacity storage if not 0
+    bool _luaCodec = false; //genLUA emit string.pack codec
+    std::vector<std::pair<std::string, std::string>> _columns; //columnar member name and type, filled after parse
 };
 
 //dict type
@@ -103,6 +107,8 @@ struct DataMap
     std::string _typeValue;
     std::string _mapName;
     std::string _desc;
+    std::string _impl; //C++ container, empty is std::map, flat is zsummer::proto4z::FlatMap, hash is std::unordered_map
+    bool _luaCodec = false; //genLUA emit string.pack codec
 };
 
 //const type
@@ -130,12 +136,16 @@ struct DataStruct
     std::string _desc;
     std::string _store;
     bool _hadLog4z = false;
+    bool _tagged = false; //encode with offset and member presence tag
+    bool _luaCodec = false; //genLUA emit string.pack codec
     struct DataMember
     {
         std::string _type;
         std::string _name;
         std::string _desc;
         short _tag; //MemberTag
+        unsigned int _maxlen = 0; //inline fixed string storage if not 0
+        std::string _emplace; //emplace builder of array and map member, empty if not generated
     };
     std::vector<DataMember> _members;
 };
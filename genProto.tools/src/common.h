@@ -51,6 +51,7 @@
 #include <fstream>
 #include <sstream>
 #include <list>
+#include <set>
 #include <time.h>
 #include <algorithm>
 #include "../depends/utls.h"
@@ -6,6 +6,7 @@
 #include "genBase.h"
 #include <time.h>
 #include <algorithm>
+#include <cmath>
 
 
 
@@ -35,9 +36,102 @@ std::string GenBase::getRealType(const std::string & xmltype)
     return xmltype;
 }
 
+unsigned int getBitWidth(const std::string & xmltype)
+{
+    if (xmltype == "bool")
+    {
+        return 1;
+    }
+    if (xmltype.compare(0, 5, "bits:") == 0)
+    {
+        return fromString<unsigned int>(xmltype.substr(5), 0);
+    }
+    return 0;
+}
+
+std::string getEmplaceName(const std::string & member)
+{
+    size_t begin = member.find_first_not_of('_');
+    if (begin == std::string::npos)
+    {
+        return "";
+    }
+    std::string builder = member.substr(begin);
+    builder[0] = (char)toupper(builder[0]);
+    return "emplace" + builder;
+}
+
+BitGroup getBitGroup(const DataStruct & ds, size_t index)
+{
+    BitGroup group = { index, index, 0 };
+    unsigned int bits = 0;
+    while (group._end < ds._members.size() && getBitWidth(ds._members[group._end]._type) > 0)
+    {
+        bits += getBitWidth(ds._members[group._end]._type);
+        group._end++;
+    }
+    group._bytes = (bits + 7) / 8;
+    return group;
+}
+
+QuantType getQuantType(const std::string & xmltype)
+{
+    QuantType qt;
+    if (xmltype == "angle8" || xmltype == "angle16")
+    {
+        qt._bits = xmltype == "angle8" ? 8 : 16;
+        qt._angle = true;
+        qt._wire = qt._bits == 8 ? "ui8" : "ui16";
+        return qt;
+    }
+    size_t open = xmltype.find('(');
+    size_t comma = xmltype.find(',');
+    size_t close = xmltype.find(')');
+    if (xmltype.compare(0, 5, "fixed") != 0 || open == std::string::npos || comma == std::string::npos || close != xmltype.length() - 1
+        || open > comma || comma > close)
+    {
+        return qt;
+    }
+    std::string bits = xmltype.substr(5, open - 5);
+    if (bits != "8" && bits != "16" && bits != "32")
+    {
+        return qt;
+    }
+    std::string range = trim(xmltype.substr(open + 1, comma - open - 1));
+    std::string precision = trim(xmltype.substr(comma + 1, close - comma - 1));
+    char * rangeEnd = nullptr;
+    char * precisionEnd = nullptr;
+    double rangeValue = strtod(range.c_str(), &rangeEnd);
+    double precisionValue = strtod(precision.c_str(), &precisionEnd);
+    if (range.empty() || precision.empty() || *rangeEnd != '\0' || *precisionEnd != '\0' || !(rangeValue > 0) || !(precisionValue > 0))
+    {
+        return qt;
+    }
+    double limit = std::floor(rangeValue / precisionValue + 1e-6);
+    unsigned int width = fromString<unsigned int>(bits, 0);
+    //the member is float, more than 24 bits steps are not exact.
+    if (limit < 1 || limit > (double)((1ULL << (std::min(width, 25U) - 1)) - 1))
+    {
+        return qt;
+    }
+    qt._bits = width;
+    qt._precision = precision;
+    qt._limit = (unsigned long long)limit;
+    qt._wire = "i" + bits;
+    return qt;
+}
+
+bool isQuantLike(const std::string & xmltype)
+{
+    return (xmltype.compare(0, 5, "fixed") == 0 || xmltype.compare(0, 5, "angle") == 0) && xmltype.length() > 5 && isdigit((unsigned char)xmltype[5]);
+}
+
 std::string GenBase::getTypeDefault(const std::string & xmltype)
 {
-    if (xmltype == "i8") return "0";
+    if (xmltype == "bool") return "false";
+    else if (getBitWidth(xmltype) > 0) return "0";
+    else if (getQuantType(xmltype)._bits > 0) return "0.0";
+    else if (xmltype == "i8") return "0";
     else if (xmltype == "ui8") return "0";
     else if (xmltype == "i16") return "0";
     else if (xmltype == "ui16") return "0";
@@ -57,6 +57,34 @@ protected:
     SupportLanguageType _type = SL_NORMAL;
 };
 
+//bit width of bool and bits:N member type, 0 if the type is not bit packed.
+unsigned int getBitWidth(const std::string & xmltype);
+
+//emplace builder of array and map member, leading '_' stripped and first letter upper. empty if the name is all '_'.
+std::string getEmplaceName(const std::string & member);
+
+//consecutive bool and bits:N members share one bitmap on the wire.
+struct BitGroup
+{
+    size_t _begin;
+    size_t _end;
+    unsigned int _bytes;
+};
+//return the group begin at member index, the group is empty if the member is not bit packed.
+BitGroup getBitGroup(const DataStruct & ds, size_t index);
+
+//fixedN(range,precision) and angleN type. the member is float, the wire is a N bits integer.
+struct QuantType
+{
+    unsigned int _bits = 0; //0 if the type is not quantized or malformed
+    bool _angle = false;
+    std::string _precision; //precision text of the schema
+    unsigned long long _limit = 0; //fixed only, max abs of the quantized value
+    std::string _wire; //wire base type, i8 i16 i32 ui8 ui16
+};
+QuantType getQuantType(const std::string & xmltype);
+//the type name is in the quantized family, maybe malformed.
+bool isQuantLike(const std::string & xmltype);
 
 void writeCSharpReflection(std::map<unsigned short, std::string> & keys, std::map<unsigned short, std::string> & errCodes);
 void writeCPPReflection(std::map<unsigned short, std::string> & keys, std::map<unsigned short, std::string> & errCodes);
@@ -17,9 +17,73 @@ std::string GenCPP::getRealType(const std::string & xmltype)
     else if ( xmltype == "float") return "float";
     else if ( xmltype == "double") return "double";
     else if ( xmltype == "string") return "std::string";
+    else if ( xmltype == "bool") return "bool";
+    else if (getBitWidth(xmltype) > 0)
+    {
+        unsigned int width = getBitWidth(xmltype);
+        if (width <= 8) return "unsigned char";
+        else if (width <= 16) return "unsigned short";
+        else if (width <= 32) return "unsigned int";
+        return "unsigned long long";
+    }
+    else if (getQuantType(xmltype)._bits > 0) return "float";
     return xmltype;
 }
 
+std::string GenCPP::getMemberType(const DataStruct::DataMember & m)
+{
+    if (m._maxlen > 0)
+    {
+        return "zsummer::proto4z::FixedString<" + toString(m._maxlen) + ">";
+    }
+    return getRealType(m._type);
+}
+
+unsigned int GenCPP::getFixedWireSize(const std::string & xmltype)
+{
+    if (xmltype == "i8" || xmltype == "ui8") return 1;
+    else if (xmltype == "i16" || xmltype == "ui16") return 2;
+    else if (xmltype == "i32" || xmltype == "ui32" || xmltype == "float") return 4;
+    else if (xmltype == "i64" || xmltype == "ui64" || xmltype == "double") return 8;
+    else if (getQuantType(xmltype)._bits > 0) return getQuantType(xmltype)._bits / 8;
+    auto founder = _fixedPackets.find(xmltype);
+    if (founder != _fixedPackets.end())
+    {
+        return founder->second;
+    }
+    return 0;
+}
+
+std::string GenCPP::getQuantizer(const std::string & xmltype)
+{
+    QuantType qt = getQuantType(xmltype);
+    if (qt._angle)
+    {
+        return "zsummer::proto4z::AngleQuantizer<" + getRealType(qt._wire) + ">()";
+    }
+    //char may be unsigned on some platform
+    std::string integral = qt._wire == "i8" ? std::string("signed char") : getRealType(qt._wire);
+    return "zsummer::proto4z::FixedQuantizer<" + integral + ">(" + qt._precision + ", " + toString(qt._limit) + ")";
+}
+
+std::string GenCPP::genWriteMember(const DataStruct::DataMember & m)
+{
+    if (getQuantType(m._type)._bits > 0)
+    {
+        return "zsummer::proto4z::writeQuantized(ws, data." + m._name + ", " + getQuantizer(m._type) + ");";
+    }
+    return "ws << data." + m._name + ";";
+}
+
+std::string GenCPP::genReadMember(const DataStruct::DataMember & m)
+{
+    if (getQuantType(m._type)._bits > 0)
+    {
+        return "data." + m._name + " = zsummer::proto4z::readQuantized(rs, " + getQuantizer(m._type) + ");";
+    }
+    return "rs >> data." + m._name + ";";
+}
+
 std::string getMysqlType(const DataStruct::DataMember & m)
 {
     if (m._type == "string" && getBitFlag(m._tag, MT_DB_BLOB))
@@ -97,11 +161,130 @@ std::string GenCPP::genRealContent(const std::list<AnyData> & stores)
         }
 
     }
+    text += genDispatchIndex(stores);
     text += LFCR + "#endif" + LFCR;
 
     return std::move(text);
 }
 
+//same as zsummer::proto4z::protoNameHash
+static unsigned int protoNameHash(const std::string & name, unsigned int seed)
+{
+    unsigned int h = 2166136261U;
+    for (auto ch : name)
+    {
+        h ^= (unsigned char)ch;
+        h *= 16777619U;
+    }
+    h ^= seed;
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+std::string GenCPP::genDispatchIndex(const std::list<AnyData> & stores)
+{
+    std::map<unsigned int, std::string> packets;
+    for (auto &info : stores)
+    {
+        if (info._type == GT_DataPacket)
+        {
+            packets[fromString<unsigned int>(info._proto._const._value, 0)] = info._proto._struct._name;
+        }
+    }
+    if (packets.empty())
+    {
+        return "";
+    }
+    unsigned int minID = packets.begin()->first;
+    unsigned int maxID = packets.rbegin()->first;
+    if (maxID >= 0xffff)
+    {
+        E("protoID 65535 is reserved as InvalidProtoID. proto=" << packets.rbegin()->second);
+    }
+
+    //perfect hash: find a seed which map all names to different slot. 0 is a valid protoID, the empty slot is InvalidProtoID.
+    const unsigned int emptySlot = 0xffff;
+    unsigned int slotSize = 1;
+    while (slotSize < packets.size() * 2)
+    {
+        slotSize <<= 1;
+    }
+    unsigned int seed = 0;
+    std::vector<unsigned int> slots;
+    while (true)
+    {
+        slots.assign(slotSize, emptySlot);
+        bool collision = false;
+        for (auto & kv : packets)
+        {
+            unsigned int & slot = slots[protoNameHash(kv.second, seed) & (slotSize - 1)];
+            if (slot != emptySlot)
+            {
+                collision = true;
+                break;
+            }
+            slot = kv.first;
+        }
+        if (!collision)
+        {
+            break;
+        }
+        if (++seed % 100000 == 0)
+        {
+            slotSize <<= 1;
+        }
+    }
+
+    std::string indexName = _filename + "ProtoIndex";
+    std::string text = LFCR;
+    text += "typedef zsummer::proto4z::ProtoDispatcher<" + toString(minID) + ", " + toString(maxID - minID + 1) + "> " + _filename + "Dispatcher;" + LFCR;
+    text += LFCR;
+    text += "struct " + indexName + " //protoID <-> protoName lookup" + LFCR;
+    text += "{" + LFCR;
+    text += "    static const unsigned short MinProtoID = " + toString(minID) + ";" + LFCR;
+    text += "    static const unsigned short MaxProtoID = " + toString(maxID) + ";" + LFCR;
+    text += "    static const char * getProtoName(unsigned short protoID)" + LFCR;
+    text += "    {" + LFCR;
+    text += "        static const char * names[] = { ";
+    for (unsigned int id = minID; id <= maxID; id++)
+    {
+        auto founder = packets.find(id);
+        text += founder == packets.end() ? std::string("nullptr") : "\"" + founder->second + "\"";
+        text += id == maxID ? " " : ", ";
+    }
+    text += "};" + LFCR;
+    text += "        if (protoID < MinProtoID || protoID > MaxProtoID) return nullptr;" + LFCR;
+    text += "        return names[protoID - MinProtoID];" + LFCR;
+    text += "    }" + LFCR;
+    text += "    static unsigned short getProtoID(const char * name, size_t len)" + LFCR;
+    text += "    {" + LFCR;
+    text += "        struct Slot { const char * name; size_t len; unsigned short protoID; };" + LFCR;
+    text += "        static const Slot slots[" + toString(slotSize) + "] = { ";
+    for (unsigned int i = 0; i < slotSize; i++)
+    {
+        if (slots[i] == emptySlot)
+        {
+            text += "{ \"\", 0, zsummer::proto4z::InvalidProtoID }";
+        }
+        else
+        {
+            const std::string & name = packets[slots[i]];
+            text += "{ \"" + name + "\", " + toString(name.length()) + ", " + toString(slots[i]) + " }";
+        }
+        text += i + 1 == slotSize ? " " : ", ";
+    }
+    text += "};" + LFCR;
+    text += "        const Slot & slot = slots[zsummer::proto4z::protoNameHash(name, len, " + toString(seed) + "U) & " + toString(slotSize - 1) + "];" + LFCR;
+    text += "        return slot.len == len && memcmp(slot.name, name, len) == 0 ? slot.protoID : zsummer::proto4z::InvalidProtoID;" + LFCR;
+    text += "    }" + LFCR;
+    text += "};" + LFCR;
+    return text;
+}
+
 
 std::string GenCPP::genDataConst(const DataConstValue & dc)
 {
@@ -134,18 +317,116 @@ std::string GenCPP::genDataEnum(const DataEnum & de)
 std::string GenCPP::genDataArray(const DataArray & da)
 {
     std::string text;
-    text += LFCR + "typedef std::vector<" + getRealType(da._type) + "> " + da._arrayName + "; ";
+    _arrays[da._arrayName] = getRealType(da._type);
+    if (da._capacity > 0)
+    {
+        text += LFCR + "typedef zsummer::proto4z::FixedVector<" + getRealType(da._type) + ", " + toString(da._capacity) + "> " + da._arrayName + "; ";
+        if (!da._desc.empty())
+        {
+            text += "//" + da._desc + " ";
+        }
+        text += LFCR;
+        return text;
+    }
+    if (getQuantType(da._type)._bits > 0)
+    {
+        //quantized array is a distinct type of float vector, quantize by chunk in its stream operator.
+        text += LFCR + "struct " + da._arrayName + " : public std::vector<float> ";
+        if (!da._desc.empty())
+        {
+            text += "//" + da._desc + " ";
+        }
+        text += LFCR;
+        text += "{" + LFCR;
+        text += "    using std::vector<float>::vector;" + LFCR;
+        text += "};" + LFCR;
+        text += "inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const " + da._arrayName + " & data)" + LFCR;
+        text += "{" + LFCR;
+        text += "    zsummer::proto4z::writeQuantizedArray(ws, data, " + getQuantizer(da._type) + ");" + LFCR;
+        text += "    return ws;" + LFCR;
+        text += "}" + LFCR;
+        text += "inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, " + da._arrayName + " & data)" + LFCR;
+        text += "{" + LFCR;
+        text += "    zsummer::proto4z::readQuantizedArray(rs, data, " + getQuantizer(da._type) + ");" + LFCR;
+        text += "    return rs;" + LFCR;
+        text += "}" + LFCR;
+        return text;
+    }
+    if (!da._columnar)
+    {
+        text += LFCR + "typedef std::vector<" + getRealType(da._type) + "> " + da._arrayName + "; ";
+        if (!da._desc.empty())
+        {
+            text += "//" + da._desc + " ";
+        }
+        text += LFCR;
+        return text;
+    }
+
+    //columnar array is a distinct type, so it has itself stream operator.
+    std::string vectorType = "std::vector<" + getRealType(da._type) + ">";
+    unsigned int minWireSize = 0;
+    for (const auto & column : da._columns)
+    {
+        minWireSize += column.second == "string" ? 4 : getFixedWireSize(column.second);
+    }
+    text += LFCR + "struct " + da._arrayName + " : public " + vectorType + " ";
     if (!da._desc.empty())
     {
         text += "//" + da._desc + " ";
     }
     text += LFCR;
+    text += "{" + LFCR;
+    text += "    using " + vectorType + "::vector;" + LFCR;
+    text += "};" + LFCR;
+
+    text += "inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const " + da._arrayName + " & data)" + LFCR;
+    text += "{" + LFCR;
+    text += "    ws << (zsummer::proto4z::Integer)data.size();" + LFCR;
+    for (const auto & column : da._columns)
+    {
+        text += "    zsummer::proto4z::writeColumn(ws, data, &" + da._type + "::" + column.first + ");" + LFCR;
+    }
+    text += "    return ws;" + LFCR;
+    text += "}" + LFCR;
+
+    text += "inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, " + da._arrayName + " & data)" + LFCR;
+    text += "{" + LFCR;
+    text += "    zsummer::proto4z::Integer totalCount = 0;" + LFCR;
+    text += "    rs >> totalCount;" + LFCR;
+    text += "    if (totalCount > rs.getStreamUnreadLen() / " + toString(minWireSize) + ")" + LFCR;
+    text += "    {" + LFCR;
+    text += "        PROTO4Z_THROW(\"" + da._arrayName + " column count over stream. totalCount=\" << totalCount);" + LFCR;
+    text += "    }" + LFCR;
+    text += "    data.clear();" + LFCR;
+    text += "    data.resize(totalCount);" + LFCR;
+    std::string cursors;
+    size_t index = 0;
+    for (const auto & column : da._columns)
+    {
+        std::string cursor = "column" + toString(index++);
+        text += "    auto " + cursor + " = zsummer::proto4z::peekColumn(rs, data, &" + da._type + "::" + column.first + ");" + LFCR;
+        cursors += (cursors.empty() ? "" : ", ") + cursor;
+    }
+    text += "    zsummer::proto4z::scatterColumns(data, " + cursors + ");" + LFCR;
+    text += "    return rs;" + LFCR;
+    text += "}" + LFCR;
     return text;
 }
 std::string GenCPP::genDataMap(const DataMap & dm)
 {
     std::string text;
-    text += LFCR + "typedef std::map<"
+    _maps.insert(dm._mapName);
+    std::string container = "std::map";
+    if (dm._impl == "flat")
+    {
+        container = "zsummer::proto4z::FlatMap";
+    }
+    else if (dm._impl == "hash")
+    {
+        container = "std::unordered_map";
+    }
+    text += LFCR + "typedef " + container + "<"
         + getRealType(dm._typeKey) + ", " + getRealType(dm._typeValue)
         + "> " + dm._mapName + "; ";
     if (!dm._desc.empty())
@@ -184,13 +465,20 @@ std::string GenCPP::genDataPacket(const DataPacket & dp)
 
     for (const auto & m : dp._struct._members)
     {
-        text += "    " + getRealType(m._type) + " " + m._name + "; ";
+        text += "    " + getMemberType(m) + " " + m._name + "; ";
         if (!m._desc.empty())
         {
             text += "//" + m._desc + " ";
         }
         text += LFCR;
     }
+    std::string fullTag;
+    if (dp._struct._tagged)
+    {
+        fullTag = dp._struct._members.size() >= 64 ? std::string("0xffffffffffffffffULL")
+            : toString((1ULL << dp._struct._members.size()) - 1) + "ULL";
+        text += "    zsummer::proto4z::ProtoTag __tag = " + fullTag + "; //member presence, bit n-1 for member n " + LFCR;
+    }
 
     if (!dp._struct._members.empty())
     {    //struct init
@@ -209,22 +497,204 @@ std::string GenCPP::genDataPacket(const DataPacket & dp)
 
     if (!dp._struct._members.empty())
     {    //struct init
+        //by value then move, the caller's temporary is moved all the way into the member.
         text += "    " + dp._struct._name + "(";
         for (size_t i = 0; i < dp._struct._members.size(); i++)
         {
             const auto & m = dp._struct._members[i];
             if (i != 0) text += ", ";
-            text += "const " + getRealType(m._type) + " & " + m._name;
+            text += getMemberType(m) + " " + m._name;
         }
-        text += ")" + LFCR;
+        text += ") : ";
+        for (size_t i = 0; i < dp._struct._members.size(); i++)
+        {
+            const auto & m = dp._struct._members[i];
+            if (i != 0) text += ", ";
+            if ((getFixedWireSize(m._type) > 0 && _fixedPackets.find(m._type) == _fixedPackets.end()) || getBitWidth(m._type) > 0)
+            {
+                text += m._name + "(" + m._name + ")";
+            }
+            else
+            {
+                text += m._name + "(std::move(" + m._name + "))";
+            }
+        }
+        text += LFCR;
         text += "    {" + LFCR;
+        text += "    }" + LFCR;
+    }
+    else
+    {
+        text += "    " + dp._struct._name + "() = default;" + LFCR;
+    }
+    text += "    " + dp._struct._name + "(const " + dp._struct._name + " &) = default;" + LFCR;
+    text += "    " + dp._struct._name + "(" + dp._struct._name + " &&) noexcept = default;" + LFCR;
+    text += "    " + dp._struct._name + " & operator = (const " + dp._struct._name + " &) = default;" + LFCR;
+    text += "    " + dp._struct._name + " & operator = (" + dp._struct._name + " &&) noexcept = default;" + LFCR;
+
+    //emplace builder for array and map members
+    for (const auto &m : dp._struct._members)
+    {
+        const std::string & builder = m._emplace;
+        if (builder.empty())
+        {
+            continue;
+        }
+        if (_arrays.find(m._type) != _arrays.end())
+        {
+            text += "    template<class ... Args>" + LFCR;
+            text += "    inline " + _arrays[m._type] + " & " + builder + "(Args && ... args) { " + m._name + ".emplace_back(std::forward<Args>(args)...); return " + m._name + ".back(); }" + LFCR;
+        }
+        else if (_maps.find(m._type) != _maps.end())
+        {
+            text += "    template<class Key, class ... Args>" + LFCR;
+            text += "    inline " + m._type + "::mapped_type & " + builder + "(Key && key, Args && ... args) { return " + m._name
+                + ".emplace(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...)).first->second; }" + LFCR;
+        }
+    }
+
+    //tagged. n is the member index begin from 1, same as Proto4zUtil.setTag
+    if (dp._struct._tagged)
+    {
+        text += "    inline " + dp._struct._name + " & setTag(int n) { __tag |= (1ULL << (n - 1)); return *this; }" + LFCR;
+        text += "    inline " + dp._struct._name + " & unsetTag(int n) { __tag &= ~(1ULL << (n - 1)); return *this; }" + LFCR;
+        text += "    inline " + dp._struct._name + " & clearTag() { __tag = 0; return *this; }" + LFCR;
+        text += "    inline bool testTag(int n) const { return (__tag & (1ULL << (n - 1))) != 0; }" + LFCR;
+    }
+
+    //reflection
+    bool memberWise = !dp._struct._tagged;
+    for (const auto &m : dp._struct._members)
+    {
+        if (getBitWidth(m._type) > 0 || getQuantType(m._type)._bits > 0)
+        {
+            memberWise = false;
+        }
+    }
+    if (!memberWise)
+    {
+        text += "    static const bool MemberWise = false; //wire layout is not one value per member, reflectWrite/reflectRead not usable" + LFCR;
+    }
+    text += "    static constexpr unsigned int getMemberCount() { return " + toString(dp._struct._members.size()) + ";}" + LFCR;
+    text += "    template<class Visitor>" + LFCR;
+    text += "    static void forEachMember(Visitor && visitor)" + LFCR;
+    text += "    {" + LFCR;
+    for (const auto &m : dp._struct._members)
+    {
+        text += "        visitor(zsummer::proto4z::makeProtoMember(\"" + m._name + "\", \"" + m._type + "\", " + toString(m._tag)
+            + ", &" + dp._struct._name + "::" + m._name + "));" + LFCR;
+    }
+    text += "    }" + LFCR;
+
+    //reset, keep the container capacity. see zsummer::proto4z::ProtoPool
+    text += "    inline void reset()" + LFCR;
+    text += "    {" + LFCR;
+    for (const auto &m : dp._struct._members)
+    {
+        text += "        zsummer::proto4z::resetMember(" + m._name + ");" + LFCR;
+    }
+    if (dp._struct._tagged)
+    {
+        text += "        __tag = " + fullTag + ";" + LFCR;
+    }
+    text += "    }" + LFCR;
+
+    //memory usage, base type members have no heap.
+    text += "    inline size_t memoryUsage() const" + LFCR;
+    text += "    {" + LFCR;
+    text += "        return sizeof(*this)";
+    for (const auto &m : dp._struct._members)
+    {
+        bool isBase = getBitWidth(m._type) > 0 || getQuantType(m._type)._bits > 0
+            || (getFixedWireSize(m._type) > 0 && _fixedPackets.find(m._type) == _fixedPackets.end());
+        if (!isBase)
+        {
+            text += " + zsummer::proto4z::heapUsage(" + m._name + ")";
+        }
+    }
+    text += ";" + LFCR;
+    text += "    }" + LFCR;
+
+    //fixed wire layout. all members are fixed width, the wire offsets are known at compile time.
+    unsigned int fixedWireSize = 0;
+    for (const auto &m : dp._struct._members)
+    {
+        unsigned int size = getFixedWireSize(m._type);
+        if (size == 0 || dp._struct._tagged)
+        {
+            fixedWireSize = 0;
+            break;
+        }
+        fixedWireSize += size;
+    }
+    if (fixedWireSize > 0)
+    {
+        _fixedPackets[dp._struct._name] = fixedWireSize;
+        text += "    static const zsummer::proto4z::Integer FixedWireSize = " + toString(fixedWireSize) + ";" + LFCR;
+        text += "    inline void fixedEncode(char * stream) const" + LFCR;
+        text += "    {" + LFCR;
+        unsigned int offset = 0;
         for (const auto &m : dp._struct._members)
         {
-            text += "        this->" + m._name + " = " + m._name + ";" + LFCR;
+            if (_fixedPackets.find(m._type) != _fixedPackets.end())
+            {
+                text += "        " + m._name + ".fixedEncode(stream + " + toString(offset) + ");" + LFCR;
+            }
+            else if (getQuantType(m._type)._bits > 0)
+            {
+                text += "        zsummer::proto4z::encodeQuantized(stream + " + toString(offset) + ", " + m._name + ", " + getQuantizer(m._type) + ");" + LFCR;
+            }
+            else
+            {
+                text += "        memcpy(stream + " + toString(offset) + ", &" + m._name + ", " + toString(getFixedWireSize(m._type)) + ");" + LFCR;
+            }
+            offset += getFixedWireSize(m._type);
+        }
+        text += "    }" + LFCR;
+        text += "    inline void fixedDecode(const char * stream)" + LFCR;
+        text += "    {" + LFCR;
+        offset = 0;
+        for (const auto &m : dp._struct._members)
+        {
+            if (_fixedPackets.find(m._type) != _fixedPackets.end())
+            {
+                text += "        " + m._name + ".fixedDecode(stream + " + toString(offset) + ");" + LFCR;
+            }
+            else if (getQuantType(m._type)._bits > 0)
+            {
+                text += "        " + m._name + " = zsummer::proto4z::decodeQuantized(stream + " + toString(offset) + ", " + getQuantizer(m._type) + ");" + LFCR;
+            }
+            else
+            {
+                text += "        memcpy(&" + m._name + ", stream + " + toString(offset) + ", " + toString(getFixedWireSize(m._type)) + ");" + LFCR;
+            }
+            offset += getFixedWireSize(m._type);
         }
         text += "    }" + LFCR;
     }
     text += "};" + LFCR;
+    if (fixedWireSize > 0)
+    {
+        text += "static_assert(";
+        for (size_t i = 0; i < dp._struct._members.size(); i++)
+        {
+            const auto & m = dp._struct._members[i];
+            if (i != 0) text += " + ";
+            if (_fixedPackets.find(m._type) != _fixedPackets.end())
+            {
+                text += m._type + "::FixedWireSize";
+            }
+            else if (getQuantType(m._type)._bits > 0)
+            {
+                text += "sizeof(" + getRealType(getQuantType(m._type)._wire) + ")";
+            }
+            else
+            {
+                text += "sizeof(" + dp._struct._name + "::" + m._name + ")";
+            }
+        }
+        text += " == " + dp._struct._name + "::FixedWireSize, \"" + dp._struct._name + " fixed wire layout error.\");" + LFCR;
+    }
 
     if (!dp._struct._store.empty())
     {
@@ -548,9 +1018,44 @@ std::string GenCPP::genDataPacket(const DataPacket & dp)
     //input stream operator
     text += "inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const " + dp._struct._name + " & data)" + LFCR;
     text += "{" + LFCR;
-    for (const auto &m : dp._struct._members)
+    if (fixedWireSize > 0)
+    {
+        text += "    char stream[" + dp._struct._name + "::FixedWireSize];" + LFCR;
+        text += "    data.fixedEncode(stream);" + LFCR;
+        text += "    ws.appendOriginalData(stream, " + dp._struct._name + "::FixedWireSize);" + LFCR;
+    }
+    else if (dp._struct._tagged)
     {
-        text += "    ws << data." + m._name + "; " + LFCR;
+        text += "    zsummer::proto4z::Integer pos = zsummer::proto4z::beginTaggedWrite(ws, data.__tag & " + fullTag + ");" + LFCR;
+        for (size_t i = 0; i < dp._struct._members.size(); i++)
+        {
+            text += "    if (data.testTag(" + toString(i + 1) + ")) " + genWriteMember(dp._struct._members[i]) + LFCR;
+        }
+        text += "    zsummer::proto4z::endTaggedWrite(ws, pos);" + LFCR;
+    }
+    else
+    {
+        for (size_t i = 0; i < dp._struct._members.size(); i++)
+        {
+            BitGroup group = getBitGroup(dp._struct, i);
+            if (group._bytes == 0)
+            {
+                text += "    " + genWriteMember(dp._struct._members[i]) + " " + LFCR;
+                continue;
+            }
+            text += "    {" + LFCR;
+            text += "        char bits[" + toString(group._bytes) + "] = { 0 };" + LFCR;
+            unsigned int pos = 0;
+            for (size_t j = group._begin; j < group._end; j++)
+            {
+                const auto & m = dp._struct._members[j];
+                text += "        zsummer::proto4z::packBits(bits, " + toString(pos) + ", (unsigned long long)data." + m._name + ", " + toString(getBitWidth(m._type)) + ");" + LFCR;
+                pos += getBitWidth(m._type);
+            }
+            text += "        ws.appendOriginalData(bits, " + toString(group._bytes) + ");" + LFCR;
+            text += "    }" + LFCR;
+            i = group._end - 1;
+        }
     }
 
     text += "    return ws;" + LFCR;
@@ -560,15 +1065,100 @@ std::string GenCPP::genDataPacket(const DataPacket & dp)
     //output stream operator
     text += "inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, " + dp._struct._name + " & data)" + LFCR;
     text += "{" + LFCR;
-
-    for (const auto &m : dp._struct._members)
+    if (fixedWireSize > 0)
+    {
+        text += "    data.fixedDecode(rs.peekOriginalData(" + dp._struct._name + "::FixedWireSize));" + LFCR;
+        text += "    rs.skipOriginalData(" + dp._struct._name + "::FixedWireSize);" + LFCR;
+    }
+    else if (dp._struct._tagged)
     {
-        text += "    rs >> data." + m._name + "; " + LFCR;
+        text += "    zsummer::proto4z::Integer tail = zsummer::proto4z::beginTaggedRead(rs, data.__tag);" + LFCR;
+        for (size_t i = 0; i < dp._struct._members.size(); i++)
+        {
+            text += "    if (data.testTag(" + toString(i + 1) + ")) " + genReadMember(dp._struct._members[i]) + LFCR;
+        }
+        text += "    zsummer::proto4z::endTaggedRead(rs, tail);" + LFCR;
+    }
+    else
+    {
+        for (size_t i = 0; i < dp._struct._members.size(); i++)
+        {
+            BitGroup group = getBitGroup(dp._struct, i);
+            if (group._bytes == 0)
+            {
+                text += "    " + genReadMember(dp._struct._members[i]) + " " + LFCR;
+                continue;
+            }
+            text += "    {" + LFCR;
+            text += "        const char * bits = rs.peekOriginalData(" + toString(group._bytes) + ");" + LFCR;
+            unsigned int pos = 0;
+            for (size_t j = group._begin; j < group._end; j++)
+            {
+                const auto & m = dp._struct._members[j];
+                std::string value = "zsummer::proto4z::unpackBits(bits, " + toString(pos) + ", " + toString(getBitWidth(m._type)) + ")";
+                if (m._type == "bool")
+                {
+                    text += "        data." + m._name + " = " + value + " != 0;" + LFCR;
+                }
+                else
+                {
+                    text += "        data." + m._name + " = (" + getRealType(m._type) + ")" + value + ";" + LFCR;
+                }
+                pos += getBitWidth(m._type);
+            }
+            text += "        rs.skipOriginalData(" + toString(group._bytes) + ");" + LFCR;
+            text += "    }" + LFCR;
+            i = group._end - 1;
+        }
     }
 
     text += "    return rs;" + LFCR;
     text += "}" + LFCR;
 
+    //lua table bridge, the member name is the same as proto4z.lua
+    text += "#ifdef PROTO4Z_WITH_LUA" + LFCR;
+    text += "inline void pushLua(lua_State * L, const " + dp._struct._name + " & data)" + LFCR;
+    text += "{" + LFCR;
+    text += "    using zsummer::proto4z::pushLua;" + LFCR;
+    text += "    zsummer::proto4z::checkLuaStack(L, 3);" + LFCR;
+    text += "    lua_createtable(L, 0, " + toString(dp._struct._members.size()) + ");" + LFCR;
+    for (size_t i = 0; i < dp._struct._members.size(); i++)
+    {
+        const auto & m = dp._struct._members[i];
+        std::string push = "pushLua(L, data." + m._name + "); lua_setfield(L, -2, \"" + m._name + "\");";
+        if (dp._struct._tagged)
+        {
+            text += "    if (data.testTag(" + toString(i + 1) + ")) { " + push + " }" + LFCR;
+        }
+        else
+        {
+            text += "    " + push + LFCR;
+        }
+    }
+    text += "}" + LFCR;
+    text += "inline void readLua(lua_State * L, int index, " + dp._struct._name + " & data)" + LFCR;
+    text += "{" + LFCR;
+    text += "    using zsummer::proto4z::readLua;" + LFCR;
+    text += "    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, \"table\");" + LFCR;
+    text += "    index = lua_absindex(L, index);" + LFCR;
+    text += "    zsummer::proto4z::checkLuaStack(L, 3);" + LFCR;
+    for (size_t i = 0; i < dp._struct._members.size(); i++)
+    {
+        const auto & m = dp._struct._members[i];
+        text += "    lua_getfield(L, index, \"" + m._name + "\");" + LFCR;
+        if (dp._struct._tagged)
+        {
+            text += "    if (lua_isnil(L, -1)) data.unsetTag(" + toString(i + 1) + "); else { readLua(L, -1, data." + m._name + "); data.setTag(" + toString(i + 1) + "); }" + LFCR;
+        }
+        else
+        {
+            text += "    if (!lua_isnil(L, -1)) readLua(L, -1, data." + m._name + ");" + LFCR;
+        }
+        text += "    lua_pop(L, 1);" + LFCR;
+    }
+    text += "}" + LFCR;
+    text += "#endif" + LFCR;
+
     //input log4z operator
     if (dp._struct._hadLog4z)
     {
@@ -620,7 +1210,7 @@ public:
     content += R"---OOO(
         }
         char buf[20];
-        printf(buf, protoID);
+        sprintf(buf, "%u", (unsigned int)protoID);
         return std::string("UnknownProtoID_") + buf;
     }
 )---OOO";
@@ -638,7 +1228,7 @@ public:
     content += R"---OOO(
         }
         char buf[20];
-        printf(buf, errCode);
+        sprintf(buf, "%u", (unsigned int)errCode);
         return std::string("UnknownErrorCode_") + buf;
     }
 };
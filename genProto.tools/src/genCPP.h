@@ -48,6 +48,20 @@ public:
     std::string genDataArray(const DataArray & da);
     std::string genDataMap(const DataMap & dm);
     std::string genDataPacket(const DataPacket & dp);
+    //dispatch table typedef and perfect hash protoName lookup for all packets in this file.
+    std::string genDispatchIndex(const std::list<AnyData> & stores);
+    //member type, string with maxlen use inline storage.
+    std::string getMemberType(const DataStruct::DataMember & m);
+    //wire size of fixed width type, 0 if the type has variable length.
+    unsigned int getFixedWireSize(const std::string & xmltype);
+    //quantizer object expression of fixedN(range,precision) and angleN type.
+    std::string getQuantizer(const std::string & xmltype);
+    std::string genWriteMember(const DataStruct::DataMember & m);
+    std::string genReadMember(const DataStruct::DataMember & m);
+protected:
+    std::map<std::string, unsigned int> _fixedPackets;
+    std::map<std::string, std::string> _arrays; //array name -> element type, used by emplace builder
+    std::set<std::string> _maps; //map name, used by emplace builder
 };
 
 #endif
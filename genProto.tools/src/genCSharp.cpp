@@ -20,14 +20,54 @@ CSharpType GenCSharp::getCSharpType(const std::string & xmltype)
     if (xmltype == "float") return{ true, "float", "Proto4z.BaseProtoObject.encodeSingle", "Proto4z.BaseProtoObject.decodeSingle" };
     if (xmltype == "double") return{ true, "double", "Proto4z.BaseProtoObject.encodeDouble", "Proto4z.BaseProtoObject.decodeDouble" };
     if (xmltype == "string") return{ true, "string", "Proto4z.BaseProtoObject.encodeString", "Proto4z.BaseProtoObject.decodeString" };
+    //bool and bits:N are packed by group, see encodeBits and decodeBits
+    if (xmltype == "bool") return{ true, "bool", "", "" };
+    //fixedN(range,precision) and angleN are quantized by genEncodeValue and genDecodeValue
+    if (getQuantType(xmltype)._bits > 0) return{ true, "float", "", "" };
+    if (getBitWidth(xmltype) > 0)
+    {
+        unsigned int width = getBitWidth(xmltype);
+        if (width <= 8) return{ true, "byte", "", "" };
+        else if (width <= 16) return{ true, "ushort", "", "" };
+        else if (width <= 32) return{ true, "uint", "", "" };
+        return{ true, "ulong", "", "" };
+    }
 
     return{ false, xmltype, "", "" };
 }
 
+std::string GenCSharp::genEncodeValue(const std::string & xmltype, const std::string & value)
+{
+    QuantType qt = getQuantType(xmltype);
+    if (qt._bits == 0)
+    {
+        return getCSharpType(xmltype).baseEncode + "(" + value + ")";
+    }
+    if (qt._angle)
+    {
+        return "Proto4z.BaseProtoObject.encodeAngle(" + value + ", " + toString(qt._bits / 8) + ")";
+    }
+    return "Proto4z.BaseProtoObject.encodeFixed(" + value + ", " + qt._precision + ", " + toString(qt._limit) + ", " + toString(qt._bits / 8) + ")";
+}
+
+std::string GenCSharp::genDecodeValue(const std::string & xmltype)
+{
+    QuantType qt = getQuantType(xmltype);
+    if (qt._bits == 0)
+    {
+        return getCSharpType(xmltype).baseDecode + "(binData, ref pos)";
+    }
+    if (qt._angle)
+    {
+        return "Proto4z.BaseProtoObject.decodeAngle(binData, ref pos, " + toString(qt._bits / 8) + ")";
+    }
+    return "Proto4z.BaseProtoObject.decodeFixed(binData, ref pos, " + qt._precision + ", " + toString(qt._bits / 8) + ")";
+}
+
 std::string  GenCSharp::getTypeDefault(const std::string & xmltype)
 {
     if (xmltype == "i8") return "'\\0'";
-    else if (xmltype == "float") return "0.0f";
+    else if (xmltype == "float" || getQuantType(xmltype)._bits > 0) return "0.0f";
     else if (xmltype == "string") return "\"\"";
     return GenBase::getTypeDefault(xmltype);
 }
@@ -129,11 +169,74 @@ std::string GenCSharp::genDataArray(const DataArray & da)
     text += "            "   "var ret = new System.Collections.Generic.List<byte>();" + LFCR;
     text += "            "   "int len = (int)this.Count;" + LFCR;
     text += "            "   "ret.AddRange(Proto4z.BaseProtoObject.encodeI32(len));" + LFCR;
+    if (da._columnar)
+    {
+        //columnar, member by member
+        for (const auto & column : da._columns)
+        {
+            if (column.second == "string")
+            {
+                text += "            "   "for (int i = 0; i < this.Count; i++ )" + LFCR;
+                text += "            "   "{" + LFCR;
+                text += "                "  "ret.AddRange(Proto4z.BaseProtoObject.encodeI32(System.Text.Encoding.UTF8.GetByteCount(this[i]." + column.first + ")));" + LFCR;
+                text += "            "   "}" + LFCR;
+                text += "            "   "for (int i = 0; i < this.Count; i++ )" + LFCR;
+                text += "            "   "{" + LFCR;
+                text += "                "  "ret.AddRange(System.Text.Encoding.UTF8.GetBytes(this[i]." + column.first + "));" + LFCR;
+                text += "            "   "}" + LFCR;
+            }
+            else
+            {
+                text += "            "   "for (int i = 0; i < this.Count; i++ )" + LFCR;
+                text += "            "   "{" + LFCR;
+                text += "                "  "ret.AddRange(" + getCSharpType(column.second).baseEncode + "(this[i]." + column.first + "));" + LFCR;
+                text += "            "   "}" + LFCR;
+            }
+        }
+        text += "            "   "return ret;" + LFCR;
+        text += "        }" + LFCR;
+        text += LFCR;
+        text += "        "   "public int __decode(byte[] binData, ref int pos)" + LFCR;
+        text += "        {" + LFCR;
+        text += "            "   "int len = Proto4z.BaseProtoObject.decodeI32(binData, ref pos);" + LFCR;
+        text += "            "   "int begin = this.Count;" + LFCR;
+        text += "            "   "for (int i = 0; i < len; i++)" + LFCR;
+        text += "            "   "{" + LFCR;
+        text += "                "  "this.Add(new " + getCSharpType(da._type).realType + "());" + LFCR;
+        text += "            "   "}" + LFCR;
+        for (const auto & column : da._columns)
+        {
+            if (column.second == "string")
+            {
+                text += "            "   "var " + column.first + "Lens = new int[len];" + LFCR;
+                text += "            "   "for (int i = 0; i < len; i++)" + LFCR;
+                text += "            "   "{" + LFCR;
+                text += "                "  + column.first + "Lens[i] = Proto4z.BaseProtoObject.decodeI32(binData, ref pos);" + LFCR;
+                text += "            "   "}" + LFCR;
+                text += "            "   "for (int i = 0; i < len; i++)" + LFCR;
+                text += "            "   "{" + LFCR;
+                text += "                "  "this[begin + i]." + column.first + " = System.Text.Encoding.UTF8.GetString(binData, pos, " + column.first + "Lens[i]);" + LFCR;
+                text += "                "  "pos += " + column.first + "Lens[i];" + LFCR;
+                text += "            "   "}" + LFCR;
+            }
+            else
+            {
+                text += "            "   "for (int i = 0; i < len; i++)" + LFCR;
+                text += "            "   "{" + LFCR;
+                text += "                "  "this[begin + i]." + column.first + " = " + getCSharpType(column.second).baseDecode + "(binData, ref pos);" + LFCR;
+                text += "            "   "}" + LFCR;
+            }
+        }
+        text += "            "   "return pos;" + LFCR;
+        text += "        }" + LFCR;
+        text += "    }" + LFCR;
+        return text;
+    }
     text += "            "   "for (int i = 0; i < this.Count; i++ )" + LFCR;
     text += "            "   "{" + LFCR;
     if (getCSharpType(da._type).isBase)
     {
-        text += "                "  "ret.AddRange(" + getCSharpType(da._type).baseEncode + "(this[i])); " + LFCR;
+        text += "                "  "ret.AddRange(" + genEncodeValue(da._type, "this[i]") + "); " + LFCR;
     }
     else
     {
@@ -153,7 +256,7 @@ std::string GenCSharp::genDataArray(const DataArray & da)
     text += "                "   "{" + LFCR;
     if (getCSharpType(da._type).isBase)
     {
-        text += "                    "  "this.Add(" + getCSharpType(da._type).baseDecode + "(binData, ref pos));" + LFCR;
+        text += "                    "  "this.Add(" + genDecodeValue(da._type) + ");" + LFCR;
     }
     else
     {
@@ -274,6 +377,17 @@ std::string GenCSharp::genDataPacket(const DataPacket & dp)
         }
         text += LFCR;
     }
+    std::string fullTag;
+    if (dp._struct._tagged)
+    {
+        fullTag = dp._struct._members.size() >= 64 ? std::string("0xffffffffffffffffUL")
+            : toString((1ULL << dp._struct._members.size()) - 1) + "UL";
+        text += "        public ulong __tag = " + fullTag + "; //member presence, bit n-1 for member n " + LFCR;
+        text += "        public void setTag(int n) { __tag |= (1UL << (n - 1)); }" + LFCR;
+        text += "        public void unsetTag(int n) { __tag &= ~(1UL << (n - 1)); }" + LFCR;
+        text += "        public void clearTag() { __tag = 0; }" + LFCR;
+        text += "        public bool testTag(int n) { return (__tag & (1UL << (n - 1))) != 0; }" + LFCR;
+    }
     //default struct ()
     text += "        public " + dp._struct._name + "() " + LFCR;
     text += "        {" + LFCR;
@@ -316,42 +430,127 @@ std::string GenCSharp::genDataPacket(const DataPacket & dp)
     text += "        public System.Collections.Generic.List<byte> __encode()" + LFCR;
     text += "        {" + LFCR;
     text += "            "   "var data = new System.Collections.Generic.List<byte>();" + LFCR;
-    for (const auto &m : dp._struct._members)
+    for (size_t i = 0; i < dp._struct._members.size(); i++)
     {
+        const auto & m = dp._struct._members[i];
+        std::string indent = "            ";
+        BitGroup group = getBitGroup(dp._struct, i);
+        if (group._bytes > 0)
+        {
+            text += "            {" + LFCR;
+            text += "                "  "var bits = new byte[" + toString(group._bytes) + "];" + LFCR;
+            unsigned int pos = 0;
+            for (size_t j = group._begin; j < group._end; j++)
+            {
+                const auto & bm = dp._struct._members[j];
+                std::string value = bm._type == "bool" ? "(this." + bm._name + " ? 1UL : 0UL)" : "(ulong)this." + bm._name;
+                text += "                "  "Proto4z.BaseProtoObject.encodeBits(bits, " + toString(pos) + ", " + value + ", " + toString(getBitWidth(bm._type)) + ");" + LFCR;
+                pos += getBitWidth(bm._type);
+            }
+            text += "                "  "data.AddRange(bits);" + LFCR;
+            text += "            }" + LFCR;
+            i = group._end - 1;
+            continue;
+        }
+        if (dp._struct._tagged)
+        {
+            text += "            if (testTag(" + toString(i + 1) + "))" + LFCR;
+            text += "            {" + LFCR;
+            indent += "    ";
+        }
         //null
         if (!getCSharpType(m._type).isBase)
         {
-            text += "            if (this." + m._name + " == null) this." + m._name + " = new " + m._type + "();" + LFCR;
+            text += indent + "if (this." + m._name + " == null) this." + m._name + " = new " + m._type + "();" + LFCR;
         }
 
 
         //encode
         if (getCSharpType(m._type).isBase)
         {
-            text += "            "  "data.AddRange(" + getCSharpType(m._type).baseEncode + "(this." + m._name + "));" + LFCR;
+            text += indent + "data.AddRange(" + genEncodeValue(m._type, "this." + m._name) + ");" + LFCR;
         }
         else
         {
-            text += "            "  "data.AddRange(this." + m._name + ".__encode());" + LFCR;
+            text += indent + "data.AddRange(this." + m._name + ".__encode());" + LFCR;
         }
+        if (dp._struct._tagged)
+        {
+            text += "            }" + LFCR;
+        }
+    }
+    if (dp._struct._tagged)
+    {
+        text += "            "  "var tagged = new System.Collections.Generic.List<byte>();" + LFCR;
+        text += "            "  "tagged.AddRange(Proto4z.BaseProtoObject.encodeUI32((uint)data.Count + 8));" + LFCR;
+        text += "            "  "tagged.AddRange(Proto4z.BaseProtoObject.encodeUI64(__tag & " + fullTag + "));" + LFCR;
+        text += "            "  "tagged.AddRange(data);" + LFCR;
+        text += "            "  "return tagged;" + LFCR;
+    }
+    else
+    {
+        text += "            "  "return data;" + LFCR;
     }
-    text += "            "  "return data;" + LFCR;
     text += "        }" + LFCR;
 
     //decode
     text += "        public int __decode(byte[] binData, ref int pos)" + LFCR;
     text += "        {" + LFCR;
-    for (const auto &m : dp._struct._members)
+    if (dp._struct._tagged)
+    {
+        text += "            "  "int end = (int)Proto4z.BaseProtoObject.decodeUI32(binData, ref pos);" + LFCR;
+        text += "            "  "end += pos;" + LFCR;
+        text += "            "  "__tag = Proto4z.BaseProtoObject.decodeUI64(binData, ref pos);" + LFCR;
+    }
+    for (size_t i = 0; i < dp._struct._members.size(); i++)
     {
+        const auto & m = dp._struct._members[i];
+        std::string indent = "            ";
+        BitGroup group = getBitGroup(dp._struct, i);
+        if (group._bytes > 0)
+        {
+            unsigned int pos = 0;
+            for (size_t j = group._begin; j < group._end; j++)
+            {
+                const auto & bm = dp._struct._members[j];
+                std::string value = "Proto4z.BaseProtoObject.decodeBits(binData, pos, " + toString(pos) + ", " + toString(getBitWidth(bm._type)) + ")";
+                if (bm._type == "bool")
+                {
+                    text += indent + "this." + bm._name + " = " + value + " != 0;" + LFCR;
+                }
+                else
+                {
+                    text += indent + "this." + bm._name + " = (" + getCSharpType(bm._type).realType + ")" + value + ";" + LFCR;
+                }
+                pos += getBitWidth(bm._type);
+            }
+            text += indent + "pos += " + toString(group._bytes) + ";" + LFCR;
+            i = group._end - 1;
+            continue;
+        }
+        if (dp._struct._tagged)
+        {
+            text += "            if (testTag(" + toString(i + 1) + "))" + LFCR;
+            text += "            {" + LFCR;
+            indent += "    ";
+        }
         if (getCSharpType(m._type).isBase)
         {
-            text += "            this." + m._name + " = " + getCSharpType(m._type).baseDecode + "(binData, ref pos);" + LFCR;
+            text += indent + "this." + m._name + " = " + genDecodeValue(m._type) + ";" + LFCR;
         }
         else
         {
-            text += "            this." + m._name + " = new " + getCSharpType(m._type).realType + "();" + LFCR;
-            text += "            this." + m._name + ".__decode(binData, ref pos);" + LFCR;
+            text += indent + "this." + m._name + " = new " + getCSharpType(m._type).realType + "();" + LFCR;
+            text += indent + "this." + m._name + ".__decode(binData, ref pos);" + LFCR;
         }
+        if (dp._struct._tagged)
+        {
+            text += "            }" + LFCR;
+        }
+    }
+    if (dp._struct._tagged)
+    {
+        text += "            "  "pos = end;" + LFCR;
     }
     text += "            return pos;" + LFCR;
     text += "        }" + LFCR;
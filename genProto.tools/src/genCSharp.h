@@ -55,6 +55,9 @@ class GenCSharp : public GenBase
 {
 public:
     CSharpType getCSharpType(const std::string & xmltype);
+    //encode and decode expression of base type, include fixedN(range,precision) and angleN.
+    std::string genEncodeValue(const std::string & xmltype, const std::string & value);
+    std::string genDecodeValue(const std::string & xmltype);
     virtual std::string getTypeDefault(const std::string & xmltype);
     virtual std::string genRealContent(const std::list<AnyData> & stores);
     std::string genDataConst(const DataConstValue & dc);
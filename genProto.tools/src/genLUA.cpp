@@ -6,6 +6,21 @@
 std::string GenLUA::genRealContent(const std::list<AnyData> & stores)
 {
     std::string text;
+    _codecs.clear();
+    for (auto &info : stores)
+    {
+        if (canGenCodec(info))
+        {
+            _codecs.insert(info._type == GT_DataArray ? info._array._arrayName
+                : (info._type == GT_DataMap ? info._map._mapName : info._proto._struct._name));
+        }
+    }
+    if (!_codecs.empty())
+    {
+        text += LFCR;
+        text += "local spack, sunpack, concat = string.pack, string.unpack, table.concat" + LFCR;
+        text += "local toint, quantize, dequantize, empty = Proto4z.__toInteger, Proto4z.__quantize, Proto4z.__dequantize, {}" + LFCR;
+    }
     for (auto &info : stores)
     {
         if (info._type == GT_DataConstValue)
@@ -22,16 +37,28 @@ std::string GenLUA::genRealContent(const std::list<AnyData> & stores)
         {
             text += LFCR;
             text += genDataArray(info._array);
+            if (_codecs.find(info._array._arrayName) != _codecs.end())
+            {
+                text += genCodecArray(info._array);
+            }
         }
         else if (info._type == GT_DataMap)
         {
             text += LFCR;
             text += genDataMap(info._map);
+            if (_codecs.find(info._map._mapName) != _codecs.end())
+            {
+                text += genCodecMap(info._map);
+            }
         }
         else if (info._type == GT_DataPacket)
         {
             text += LFCR;
             text += genDataPacket(info._proto);
+            if (_codecs.find(info._proto._struct._name) != _codecs.end())
+            {
+                text += genCodecPacket(info._proto);
+            }
         }
     }
 
@@ -65,6 +92,17 @@ std::string GenLUA::genDataEnum(const DataEnum & de)
     }
     return text;
 }
+//quantize description used by proto4z.lua, the value on the wire is the integer type of wire.
+static std::string genQuant(const std::string & xmltype)
+{
+    QuantType qt = getQuantType(xmltype);
+    if (qt._angle)
+    {
+        return "{wire=\"" + qt._wire + "\", angle=" + toString(1ULL << qt._bits) + "}";
+    }
+    return "{wire=\"" + qt._wire + "\", precision=" + qt._precision + ", limit=" + toString(qt._limit) + "}";
+}
+
 std::string GenLUA::genDataArray(const DataArray & da)
 {
     std::string text;
@@ -78,6 +116,14 @@ std::string GenLUA::genDataArray(const DataArray & da)
     text += "Proto4z." + da._arrayName + ".__protoName = \"" + da._arrayName + "\"" + LFCR;
     text += "Proto4z." + da._arrayName + ".__protoDesc = \"array\"" + LFCR;
     text += "Proto4z." + da._arrayName + ".__protoTypeV = \"" + da._type + "\"" + LFCR;
+    if (da._columnar)
+    {
+        text += "Proto4z." + da._arrayName + ".__columnar = true" + LFCR;
+    }
+    if (getQuantType(da._type)._bits > 0)
+    {
+        text += "Proto4z." + da._arrayName + ".__quant = " + genQuant(da._type) + LFCR;
+    }
     return text;
 }
 std::string GenLUA::genDataMap(const DataMap & dm)
@@ -113,11 +159,23 @@ std::string GenLUA::genDataPacket(const DataPacket & dp)
 
     text += "Proto4z." + dp._struct._name + ".__protoID = " + dp._const._value + "" + LFCR;
     text += "Proto4z." + dp._struct._name + ".__protoName = \"" + dp._struct._name + "\"" + LFCR;
+    if (dp._struct._tagged)
+    {
+        text += "Proto4z." + dp._struct._name + ".__withTag = true" + LFCR;
+    }
 
     for (size_t i = 0; i < dp._struct._members.size(); ++i)
     {
         text += "Proto4z." + dp._struct._name + "[" + toString(i + 1)
             + "] = {name=\"" + dp._struct._members[i]._name + "\", type=\"" + dp._struct._members[i]._type + "\"";
+        if (getBitWidth(dp._struct._members[i]._type) > 0)
+        {
+            text += ", bits=" + toString(getBitWidth(dp._struct._members[i]._type));
+        }
+        if (getQuantType(dp._struct._members[i]._type)._bits > 0)
+        {
+            text += ", quant=" + genQuant(dp._struct._members[i]._type);
+        }
         text += " } ";
         if (!dp._struct._members[i]._desc.empty())
         {
@@ -129,3 +187,436 @@ std::string GenLUA::genDataPacket(const DataPacket & dp)
 }
 
 
+//////////////////////////////////////////////////////////////////////////
+//string.pack codec, emitted when LuaCodec is set in ProtoTraits.
+//consecutive fixed width members and strings share one string.pack format, only the containers loop.
+//////////////////////////////////////////////////////////////////////////
+
+//string.pack format of base type and string, empty if not.
+static std::string getPackFormat(const std::string & xmltype)
+{
+    static const std::map<std::string, std::string> formats = {
+        { "i8", "i1" }, { "ui8", "I1" }, { "i16", "i2" }, { "ui16", "I2" }, { "i32", "i4" }, { "ui32", "I4" },
+        { "i64", "i8" }, { "ui64", "I8" }, { "float", "f" }, { "double", "d" }, { "string", "s4" } };
+    auto founder = formats.find(xmltype);
+    return founder == formats.end() ? std::string() : founder->second;
+}
+
+//member access, a lua keyword can not follow the dot.
+static std::string luaField(const std::string & name)
+{
+    static const std::set<std::string> keywords = { "and", "break", "do", "else", "elseif", "end", "false", "for", "function",
+        "goto", "if", "in", "local", "nil", "not", "or", "repeat", "return", "then", "true", "until", "while" };
+    if (keywords.find(name) != keywords.end())
+    {
+        return "[\"" + name + "\"]";
+    }
+    return "." + name;
+}
+
+static std::string hexMask(unsigned int width)
+{
+    std::stringstream ss;
+    ss << "0x" << std::hex << ((1ULL << width) - 1);
+    return ss.str();
+}
+
+bool GenLUA::canGenCodec(const AnyData & info)
+{
+    if (info._type == GT_DataArray)
+    {
+        return info._array._luaCodec && !info._array._columnar;
+    }
+    if (info._type == GT_DataMap)
+    {
+        return info._map._luaCodec;
+    }
+    if (info._type != GT_DataPacket || !info._proto._struct._luaCodec || info._proto._struct._tagged)
+    {
+        return false;
+    }
+    const DataStruct & ds = info._proto._struct;
+    for (size_t i = 0; i < ds._members.size(); i++)
+    {
+        BitGroup group = getBitGroup(ds, i);
+        if (group._bytes > 8)
+        {
+            return false; //the bitmap is wider than a lua integer
+        }
+        if (group._bytes > 0)
+        {
+            i = group._end - 1;
+        }
+    }
+    return true;
+}
+
+//encode expression of one value v, return the string.pack format or empty if the expression is already a binary string.
+//integer narrower than 64 bits is masked and packed unsigned, it's the same truncation as Proto4zUtil.pack.
+std::string GenLUA::genEncodeValue(const std::string & xmltype, const std::string & v, const std::string & quant, std::string & expr)
+{
+    QuantType qt = getQuantType(xmltype);
+    if (qt._bits > 0)
+    {
+        expr = "quantize(" + v + ", " + quant + ")";
+        return getPackFormat(qt._wire);
+    }
+    static const std::map<std::string, unsigned int> widths = {
+        { "i8", 8 }, { "ui8", 8 }, { "i16", 16 }, { "ui16", 16 }, { "i32", 32 }, { "ui32", 32 } };
+    auto founder = widths.find(xmltype);
+    if (founder != widths.end())
+    {
+        expr = "((" + v + " or 0) & " + hexMask(founder->second) + ")";
+        return "I" + toString(founder->second / 8);
+    }
+    if (xmltype == "i64" || xmltype == "ui64")
+    {
+        expr = "toint(" + v + ")";
+    }
+    else if (xmltype == "float" || xmltype == "double")
+    {
+        expr = "(" + v + " or 0)";
+    }
+    else if (xmltype == "string")
+    {
+        expr = "(" + v + " or \"\")";
+    }
+    else if (_codecs.find(xmltype) != _codecs.end())
+    {
+        expr = "Proto4z." + xmltype + ".__encoder(" + v + ")";
+    }
+    else
+    {
+        expr = "Proto4z.encode(" + v + ", \"" + xmltype + "\")";
+    }
+    return getPackFormat(xmltype);
+}
+
+//decode one nested value of xmltype into the lvalue target.
+std::string GenLUA::genDecodeNested(const std::string & xmltype, const std::string & target, const std::string & indent)
+{
+    std::string text = indent + target + " = {}" + LFCR;
+    if (_codecs.find(xmltype) != _codecs.end())
+    {
+        text += indent + "pos = Proto4z." + xmltype + ".__decoder(bin, pos, " + target + ")" + LFCR;
+    }
+    else
+    {
+        text += indent + "pos = Proto4z.__decode(bin, pos, \"" + xmltype + "\", " + target + ")" + LFCR;
+    }
+    return text;
+}
+
+std::string GenLUA::genCodecArray(const DataArray & da)
+{
+    const int Unroll = 8;
+    std::string name = "Proto4z." + da._arrayName;
+    QuantType qt = getQuantType(da._type);
+    std::string wire = qt._bits > 0 ? qt._wire : da._type;
+    std::string expr;
+    std::string format = genEncodeValue(da._type, "obj[i]", "quant", expr);
+
+    std::string text;
+    text += "do" + LFCR;
+    if (qt._bits > 0)
+    {
+        text += "    local quant = " + name + ".__quant" + LFCR;
+    }
+    text += "    " + name + ".__encoder = function(obj)" + LFCR;
+    text += "        if type(obj) ~= \"table\" then obj = empty end" + LFCR;
+    text += "        local n = #obj" + LFCR;
+    text += "        local parts, i = {spack(\"<I4\", n)}, 1" + LFCR;
+    if (!format.empty() && format != "s4")
+    {
+        //fixed width element, 8 elements one string.pack
+        std::string unrolled;
+        std::string args;
+        for (int k = 0; k < Unroll; k++)
+        {
+            std::string e;
+            genEncodeValue(da._type, k == 0 ? "obj[i]" : "obj[i + " + toString(k) + "]", "quant", e);
+            unrolled += format;
+            args += ", " + e;
+        }
+        text += "        while i + " + toString(Unroll - 1) + " <= n do" + LFCR;
+        text += "            parts[#parts + 1] = spack(\"<" + unrolled + "\"" + args + ")" + LFCR;
+        text += "            i = i + " + toString(Unroll) + LFCR;
+        text += "        end" + LFCR;
+    }
+    text += "        for i = i, n do" + LFCR;
+    if (format.empty())
+    {
+        text += "            parts[#parts + 1] = " + expr + LFCR;
+    }
+    else
+    {
+        text += "            parts[#parts + 1] = spack(\"<" + format + "\", " + expr + ")" + LFCR;
+    }
+    text += "        end" + LFCR;
+    text += "        return concat(parts)" + LFCR;
+    text += "    end" + LFCR;
+
+    text += "    " + name + ".__decoder = function(bin, pos, result)" + LFCR;
+    text += "        local n, v" + LFCR;
+    text += "        n, pos = sunpack(\"<I4\", bin, pos)" + LFCR;
+    text += "        for i = 1, n do" + LFCR;
+    if (qt._bits > 0)
+    {
+        text += "            v, pos = sunpack(\"<" + getPackFormat(wire) + "\", bin, pos)" + LFCR;
+        text += "            result[i] = dequantize(v, quant)" + LFCR;
+    }
+    else if (!format.empty())
+    {
+        text += "            result[i], pos = sunpack(\"<" + getPackFormat(wire) + "\", bin, pos)" + LFCR;
+    }
+    else
+    {
+        text += genDecodeNested(da._type, "v", "            ");
+        text += "            result[i] = v" + LFCR;
+    }
+    text += "        end" + LFCR;
+    text += "        return pos" + LFCR;
+    text += "    end" + LFCR;
+    text += "end" + LFCR;
+    return text;
+}
+
+std::string GenLUA::genCodecMap(const DataMap & dm)
+{
+    std::string name = "Proto4z." + dm._mapName;
+    std::string keyExpr;
+    std::string keyFormat = genEncodeValue(dm._typeKey, "k", "", keyExpr);
+    std::string valueExpr;
+    std::string valueFormat = genEncodeValue(dm._typeValue, "v", "", valueExpr);
+    if (keyFormat.empty())
+    {
+        E("map key must be base type or string. map=" << dm._mapName);
+    }
+
+    std::string text;
+    text += "do" + LFCR;
+    text += "    " + name + ".__encoder = function(obj)" + LFCR;
+    text += "        if type(obj) ~= \"table\" then obj = empty end" + LFCR;
+    text += "        local parts, n = {false}, 0" + LFCR;
+    text += "        for k, v in pairs(obj) do" + LFCR;
+    text += "            n = n + 1" + LFCR;
+    if (valueFormat.empty())
+    {
+        text += "            parts[n + 1] = spack(\"<" + keyFormat + "\", " + keyExpr + ") .. " + valueExpr + LFCR;
+    }
+    else
+    {
+        text += "            parts[n + 1] = spack(\"<" + keyFormat + valueFormat + "\", " + keyExpr + ", " + valueExpr + ")" + LFCR;
+    }
+    text += "        end" + LFCR;
+    text += "        parts[1] = spack(\"<I4\", n)" + LFCR;
+    text += "        return concat(parts)" + LFCR;
+    text += "    end" + LFCR;
+
+    text += "    " + name + ".__decoder = function(bin, pos, result)" + LFCR;
+    text += "        local n, k, v" + LFCR;
+    text += "        n, pos = sunpack(\"<I4\", bin, pos)" + LFCR;
+    text += "        for i = 1, n do" + LFCR;
+    if (valueFormat.empty())
+    {
+        text += "            k, pos = sunpack(\"<" + getPackFormat(dm._typeKey) + "\", bin, pos)" + LFCR;
+        text += genDecodeNested(dm._typeValue, "v", "            ");
+    }
+    else
+    {
+        text += "            k, v, pos = sunpack(\"<" + getPackFormat(dm._typeKey) + getPackFormat(dm._typeValue) + "\", bin, pos)" + LFCR;
+    }
+    text += "            result[k] = v" + LFCR;
+    text += "        end" + LFCR;
+    text += "        return pos" + LFCR;
+    text += "    end" + LFCR;
+    text += "end" + LFCR;
+    return text;
+}
+
+std::string GenLUA::genCodecPacket(const DataPacket & dp)
+{
+    const size_t MaxRun = 32;
+    const size_t MaxConcat = 32;
+    const DataStruct & ds = dp._struct;
+    std::string name = "Proto4z." + ds._name;
+
+    //a segment is one string.pack run or one nested value.
+    struct Segment
+    {
+        std::string encodeFormat;
+        std::string decodeFormat;
+        std::vector<std::string> values;
+        std::vector<std::string> targets;
+        std::vector<std::string> assigns; //decode assignments after unpack
+        std::string nested;
+    };
+    std::vector<Segment> segments;
+    std::string quantNames;
+    std::string quantValues;
+    std::string temps;
+    auto appendList = [](std::string & list, const std::string & item)
+    {
+        list += (list.empty() ? "" : ", ") + item;
+    };
+    auto runSegment = [&segments, MaxRun]() -> Segment &
+    {
+        if (segments.empty() || !segments.back().nested.empty() || segments.back().values.size() >= MaxRun)
+        {
+            segments.push_back(Segment());
+        }
+        return segments.back();
+    };
+
+    for (size_t i = 0; i < ds._members.size(); i++)
+    {
+        const auto & m = ds._members[i];
+        BitGroup group = getBitGroup(ds, i);
+        if (group._bytes > 0)
+        {
+            //encode the bitmap as one integer, bit order is the same as Proto4zUtil.packBits
+            std::string temp = "b" + toString(i + 1);
+            std::string packed;
+            Segment & seg = runSegment();
+            unsigned int offset = 0;
+            for (size_t j = group._begin; j < group._end; j++)
+            {
+                const auto & bm = ds._members[j];
+                unsigned int width = getBitWidth(bm._type);
+                std::string v = "obj" + luaField(bm._name);
+                std::string value = bm._type == "bool" ? "(" + v + " == true and 1 or (" + v + " or 0))" : "(" + v + " or 0)";
+                std::string bits = offset > 0 ? "(" + temp + " >> " + toString(offset) + ")" : temp;
+                if (width < 64)
+                {
+                    value = "(" + value + " & " + hexMask(width) + ")";
+                    bits = "(" + bits + " & " + hexMask(width) + ")";
+                }
+                if (offset > 0)
+                {
+                    value = "(" + value + " << " + toString(offset) + ")";
+                }
+                packed += (packed.empty() ? "" : " | ") + value;
+                seg.assigns.push_back("result" + luaField(bm._name) + " = " + (bm._type == "bool" ? bits + " ~= 0" : bits));
+                offset += width;
+            }
+            seg.encodeFormat += "I" + toString(group._bytes);
+            seg.decodeFormat += "I" + toString(group._bytes);
+            seg.values.push_back(packed);
+            seg.targets.push_back(temp);
+            appendList(temps, temp);
+            i = group._end - 1;
+            continue;
+        }
+
+        std::string quant;
+        QuantType qt = getQuantType(m._type);
+        if (qt._bits > 0)
+        {
+            quant = "q" + toString(i + 1);
+            appendList(quantNames, quant);
+            appendList(quantValues, name + "[" + toString(i + 1) + "].quant");
+        }
+        std::string expr;
+        std::string format = genEncodeValue(m._type, "obj" + luaField(m._name), quant, expr);
+        std::string target = "result" + luaField(m._name);
+        if (format.empty())
+        {
+            Segment seg;
+            seg.nested = m._type;
+            seg.values.push_back(expr);
+            seg.targets.push_back(target);
+            segments.push_back(seg);
+            continue;
+        }
+        Segment & seg = runSegment();
+        seg.encodeFormat += format;
+        seg.decodeFormat += getPackFormat(qt._bits > 0 ? qt._wire : m._type);
+        seg.values.push_back(expr);
+        if (qt._bits > 0)
+        {
+            seg.targets.push_back(quant + "v");
+            seg.assigns.push_back(target + " = dequantize(" + quant + "v, " + quant + ")");
+            appendList(temps, quant + "v");
+        }
+        else
+        {
+            seg.targets.push_back(target);
+        }
+    }
+
+    std::vector<std::string> pieces;
+    for (const auto & seg : segments)
+    {
+        if (!seg.nested.empty())
+        {
+            pieces.push_back(seg.values.front());
+            continue;
+        }
+        std::string piece = "spack(\"<" + seg.encodeFormat + "\"";
+        for (const auto & v : seg.values)
+        {
+            piece += ", " + v;
+        }
+        pieces.push_back(piece + ")");
+    }
+
+    std::string text;
+    text += "do" + LFCR;
+    if (!quantNames.empty())
+    {
+        text += "    local " + quantNames + " = " + quantValues + LFCR;
+    }
+    text += "    " + name + ".__encoder = function(obj)" + LFCR;
+    text += "        if type(obj) ~= \"table\" then obj = empty end" + LFCR;
+    if (pieces.empty())
+    {
+        text += "        return \"\"" + LFCR;
+    }
+    else if (pieces.size() > MaxConcat)
+    {
+        text += "        return concat({" + LFCR;
+        for (const auto & piece : pieces)
+        {
+            text += "            " + piece + "," + LFCR;
+        }
+        text += "        })" + LFCR;
+    }
+    else
+    {
+        text += "        return " + pieces.front() + LFCR;
+        for (size_t i = 1; i < pieces.size(); i++)
+        {
+            text += "            .. " + pieces[i] + LFCR;
+        }
+    }
+    text += "    end" + LFCR;
+
+    text += "    " + name + ".__decoder = function(bin, pos, result)" + LFCR;
+    if (!temps.empty())
+    {
+        text += "        local " + temps + LFCR;
+    }
+    for (const auto & seg : segments)
+    {
+        if (!seg.nested.empty())
+        {
+            text += genDecodeNested(seg.nested, seg.targets.front(), "        ");
+            continue;
+        }
+        text += "        ";
+        for (const auto & t : seg.targets)
+        {
+            text += t + ", ";
+        }
+        text += "pos = sunpack(\"<" + seg.decodeFormat + "\", bin, pos)" + LFCR;
+        for (const auto & a : seg.assigns)
+        {
+            text += "        " + a + LFCR;
+        }
+    }
+    text += "        return pos" + LFCR;
+    text += "    end" + LFCR;
+    text += "end" + LFCR;
+    return text;
+}
+
@@ -46,6 +46,16 @@ public:
     std::string genDataArray(const DataArray & da);
     std::string genDataMap(const DataMap & dm);
     std::string genDataPacket(const DataPacket & dp);
+
+    //string.pack codec
+    bool canGenCodec(const AnyData & info);
+    std::string genEncodeValue(const std::string & xmltype, const std::string & v, const std::string & quant, std::string & expr);
+    std::string genDecodeNested(const std::string & xmltype, const std::string & target, const std::string & indent);
+    std::string genCodecArray(const DataArray & da);
+    std::string genCodecMap(const DataMap & dm);
+    std::string genCodecPacket(const DataPacket & dp);
+private:
+    std::set<std::string> _codecs; //type names with codec in this file
 };
 
 #endif
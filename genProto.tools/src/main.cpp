@@ -6,9 +6,73 @@
 #include "genBase.h"
 #include "parseCache.h"
 #include "parseProto.h"
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
 std::map<unsigned short, std::string> _cacheKeys;
 std::map<unsigned short, std::string> _errCodes;
-//#define __WITH_TAG
+
+//one xml file. parsed once, then shared by all language generator.
+struct GenFile
+{
+    std::string filename;
+    ParseCache cache;
+    bool needUpdate = false;
+    std::list<AnyData> stores;
+    double parseTime = 0.0;
+    double genTime[SL_END] = {};
+    bool written[SL_END] = {};
+};
+
+inline double elapsedMS(std::chrono::steady_clock::time_point begin)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+}
+
+//run tasks on a thread pool, the first exception be rethrow after all worker done.
+void runTasks(const std::vector<std::function<void()>> & tasks)
+{
+    std::atomic<size_t> next(0);
+    std::mutex lock;
+    std::exception_ptr error;
+    auto worker = [&]()
+    {
+        size_t index;
+        while ((index = next++) < tasks.size())
+        {
+            try
+            {
+                tasks[index]();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (!error)
+                {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+    size_t threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1U), tasks.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; i++)
+    {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto & t : threads)
+    {
+        t.join();
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
 int main(int argc, char *argv[])
 {
     zsummer::log4z::ILog4zManager::getRef().setLoggerFileLine(LOG4Z_MAIN_LOGGER_ID, false);
@@ -24,55 +88,115 @@ int main(int argc, char *argv[])
     }
     try
     {
+        auto beginTime = std::chrono::steady_clock::now();
+        std::vector<GenFile> genFiles(files.size());
+        std::vector<std::function<void()>> tasks;
+
+        //parse all xml.
+        for (size_t i = 0; i < files.size(); i++)
+        {
+            genFiles[i].filename = subString(files[i].filename, ".", true, true).first;
+            GenFile & gf = genFiles[i];
+            tasks.push_back([&gf]()
+            {
+                auto begin = std::chrono::steady_clock::now();
+                gf.cache.parse(gf.filename);
+                gf.needUpdate = gf.cache.isNeedUpdate();
+                gf.stores = parseProto(gf.filename, gf.cache);
+                gf.parseTime = elapsedMS(begin);
+            });
+        }
+        runTasks(tasks);
+        double parseTime = elapsedMS(beginTime);
+
+        //generate file and language, skip the output which content not changed.
+        auto genBegin = std::chrono::steady_clock::now();
         bool updateReflection = false;
-        for (auto & file : files)
+        tasks.clear();
+        for (auto & gf : genFiles)
         {
-            std::string filename = subString(file.filename, ".", true, true).first;
-            ParseCache cache;
-            cache.parse(filename);
-            if (cache.isNeedUpdate())
+            if (!gf.needUpdate)
             {
-                updateReflection = true;
-                auto stores = parseProto(filename, cache);
-                for (int i = SL_NORMAL + 1; i < SL_END; i++)
+                continue;
+            }
+            updateReflection = true;
+            for (int i = SL_NORMAL + 1; i < SL_END; i++)
+            {
+                GenFile * pgf = &gf;
+                tasks.push_back([pgf, i]()
                 {
+                    auto begin = std::chrono::steady_clock::now();
                     auto gen = createGenerate((SupportLanguageType)i);
                     if (!gen)
                     {
-                        continue;
+                        return;
+                    }
+                    gen->init(pgf->filename, (SupportLanguageType)i);
+                    auto content = gen->genRealContent(pgf->stores);
+                    if (pgf->cache.isContentChanged((SupportLanguageType)i, content))
+                    {
+                        gen->write(content);
+                        pgf->written[i] = true;
                     }
-                    gen->init(filename, (SupportLanguageType)i);
-                    auto content = gen->genRealContent(stores);
-                    gen->write(content);
                     destroyGenerate(gen);
-                }
-                cache.write();
+                    pgf->genTime[i] = elapsedMS(begin);
+                });
+            }
+        }
+        runTasks(tasks);
+        tasks.clear();
+        for (auto & gf : genFiles)
+        {
+            if (gf.needUpdate)
+            {
+                tasks.push_back([&gf]() { gf.cache.write(); });
             }
-            if (true)
+        }
+        runTasks(tasks);
+        double genTime = elapsedMS(genBegin);
+
+        auto reflectionBegin = std::chrono::steady_clock::now();
+        for (auto & gf : genFiles)
+        {
+            for (auto & store : gf.stores)
             {
-                auto stores = parseProto(filename, cache);
-                for (auto & store : stores)
+                if (store._type == GT_DataEnum && trim(store._enum._name) == "ERROR_CODE")
                 {
-                    if (store._type == GT_DataEnum && trim(store._enum._name) == "ERROR_CODE")
+                    for (auto & kv : store._enum._members)
                     {
-                        for (auto & kv : store._enum._members)
-                        {
-                            _errCodes[fromString<unsigned short>(kv._value, 0)] = kv._desc;
-                        }
+                        _errCodes[fromString<unsigned short>(kv._value, 0)] = kv._desc;
                     }
                 }
-                for (auto & kv : cache._cacheNumber)
-                {
-                    _cacheKeys[kv.second] = kv.first;
-                }
+            }
+            for (auto & kv : gf.cache._cacheNumber)
+            {
+                _cacheKeys[kv.second] = kv.first;
             }
         }
         if (updateReflection)
         {
-            writeCSharpReflection(_cacheKeys, _errCodes);
-            writeCPPReflection(_cacheKeys, _errCodes);
+            tasks.clear();
+            tasks.push_back([]() { writeCSharpReflection(_cacheKeys, _errCodes); });
+            tasks.push_back([]() { writeCPPReflection(_cacheKeys, _errCodes); });
+            runTasks(tasks);
         }
+        double reflectionTime = elapsedMS(reflectionBegin);
 
+        //timing report
+        for (auto & gf : genFiles)
+        {
+            std::string report = "parse=" + toString((int)gf.parseTime) + "ms";
+            for (int i = SL_NORMAL + 1; i < SL_END; i++)
+            {
+                if (gf.needUpdate && i != SL_XML)
+                {
+                    report += std::string(", ") + SupportLanguageFilePath[i] + "=" + toString((int)gf.genTime[i]) + "ms" + (gf.written[i] ? "" : "(unchanged)");
+                }
+            }
+            LOGI("[" << gf.filename << "] " << (gf.needUpdate ? "" : "up to date, ") << report);
+        }
+        LOGA("files=" << genFiles.size() << ", parse used " << (int)parseTime << "ms, generate used " << (int)genTime
+            << "ms, reflection used " << (int)reflectionTime << "ms, total used " << (int)elapsedMS(beginTime) << "ms.");
     }
     catch (const std::exception & e)
     {
@@ -85,9 +209,3 @@ int main(int argc, char *argv[])
 
     return 0;
 }
-
-
-
-
-
-
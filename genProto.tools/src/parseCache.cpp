@@ -111,28 +111,31 @@ bool   ParseCache::write()
 
 bool ParseCache::isNeedUpdate()
 {
+    bool needUpdate = false;
     for (int i = SL_NORMAL+1; i < SL_END; i++)
     {
-        if (_md5Cache[i].empty())
-        {
-            return true;
-        }
-        std::string md5;
         if (i != SL_XML)
         {
-            md5 = genFileMD5(_configPath + "/" + SupportLanguageFilePath[i] + "/" + _configFileName + SupportLanguageFileSuffix[i]);
+            _md5Current[i] = genFileMD5(_configPath + "/" + SupportLanguageFilePath[i] + "/" + _configFileName + SupportLanguageFileSuffix[i]);
         }
         else
         {
-            md5 = genFileMD5(_configPath + "/" + _configFileName + SupportLanguageFileSuffix[i]);
+            _md5Current[i] = genFileMD5(_configPath + "/" + _configFileName + SupportLanguageFileSuffix[i]);
         }
         
-        if (md5 != _md5Cache[i])
+        if (_md5Cache[i].empty() || _md5Current[i] != _md5Cache[i])
         {
-            return true;
+            needUpdate = true;
         }
     }
-    return false;
+    return needUpdate;
+}
+
+bool ParseCache::isContentChanged(SupportLanguageType t, const std::string & content)
+{
+    MD5Data md5;
+    md5 << content;
+    return _md5Current[t].empty() || md5.genMD5() != _md5Current[t];
 }
 
 unsigned short ParseCache::getCacheNumber(std::string key)
@@ -62,6 +62,7 @@ class ParseCache
     std::string _configPath;
     std::string _cacheFile;
     std::string _md5Cache[SL_END];
+    std::string _md5Current[SL_END]; //md5 of the file on disk now.
     //cache data
     unsigned short _currentProtoID = 0;
 public:
@@ -70,6 +71,8 @@ public:
     void parse(std::string filename);
     bool  write();
     bool isNeedUpdate();
+    //compare generated content with the file on disk, call after isNeedUpdate.
+    bool isContentChanged(SupportLanguageType t, const std::string & content);
     inline void setCurrentProtoID(unsigned short n){ _currentProtoID = n; }
     inline unsigned short getCurrentProtoID(){ return _currentProtoID; }
     unsigned short genProtoID(std::string key, unsigned short minProtoID, unsigned short maxProtoID);
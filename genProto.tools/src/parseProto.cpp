@@ -52,6 +52,7 @@ std::list<AnyData> parseProto(std::string fileName, ParseCache & cache)
     unsigned short minProtoID = 0;
     unsigned short maxProtoID = 0;
     bool hadLog4z = false;
+    bool luaCodec = false;
     std::list<AnyData> anydata;
     std::string filename = fileName + ".xml";
 
@@ -78,6 +79,7 @@ std::list<AnyData> parseProto(std::string fileName, ParseCache & cache)
         auto minNo = ele->FirstChildElement("MinNo");
         auto maxNo = ele->FirstChildElement("MaxNo");
         auto lgz = ele->FirstChildElement("UseLog4z");
+        auto luc = ele->FirstChildElement("LuaCodec");
         if (!minNo || !minNo->GetText() || !maxNo || !maxNo->GetText())
         {
             E("FirstChildElement(\"MinNo\") || FirstChildElement(\"MaxNo\")  Error");
@@ -86,6 +88,10 @@ std::list<AnyData> parseProto(std::string fileName, ParseCache & cache)
         {
             hadLog4z = true;
         }
+        if (luc && luc->GetText() && (strcmp(luc->GetText(), "1") == 0 || strcmp(luc->GetText(), "true") == 0))
+        {
+            luaCodec = true;
+        }
         
         minProtoID = atoi(minNo->GetText());
         maxProtoID = atoi(maxNo->GetText());
@@ -206,6 +212,27 @@ std::list<AnyData> parseProto(std::string fileName, ParseCache & cache)
                 {
                     ar._desc = ele->Attribute("desc");
                 }
+                if (ele->Attribute("columnar") && compareStringIgnCase(ele->Attribute("columnar"), "true"))
+                {
+                    ar._columnar = true;
+                }
+                if (ele->Attribute("capacity"))
+                {
+                    ar._capacity = fromString<unsigned int>(ele->Attribute("capacity"), 0);
+                    if (ar._capacity == 0 || ar._columnar)
+                    {
+                        E("array capacity must be positive and can not be columnar. array=" << ar._arrayName);
+                    }
+                }
+                if (isQuantLike(ar._type) && (getQuantType(ar._type)._bits == 0 || ar._capacity > 0))
+                {
+                    E("array quantized type error or with capacity. array=" << ar._arrayName << ", type=" << ar._type);
+                }
+                if (ar._type == "bool" || ar._type.compare(0, 5, "bits:") == 0)
+                {
+                    E("array not support bool and bits:N type, they only pack in packet members. array=" << ar._arrayName << ", type=" << ar._type);
+                }
+                ar._luaCodec = luaCodec;
                 AnyData info;
                 info._type = GT_DataArray;
                 info._array = ar;
@@ -222,10 +249,34 @@ std::list<AnyData> parseProto(std::string fileName, ParseCache & cache)
                 dm._typeKey = trim(ele->Attribute("key"));
                 dm._typeValue = trim(ele->Attribute("value"));
                 dm._mapName = trim(ele->Attribute("name"));
+                if (isQuantLike(dm._typeKey) || isQuantLike(dm._typeValue))
+                {
+                    E("map not support quantized key or value. map=" << dm._mapName);
+                }
+                if (dm._typeKey == "bool" || dm._typeKey.compare(0, 5, "bits:") == 0
+                    || dm._typeValue == "bool" || dm._typeValue.compare(0, 5, "bits:") == 0)
+                {
+                    E("map not support bool and bits:N key or value, they only pack in packet members. map=" << dm._mapName);
+                }
+                if (ele->Attribute("impl"))
+                {
+                    dm._impl = trim(ele->Attribute("impl"));
+                    if (dm._impl != "flat" && dm._impl != "hash")
+                    {
+                        E("map impl must be flat or hash. map=" << dm._mapName << ", impl=" << dm._impl);
+                    }
+                    const std::string & k = dm._typeKey;
+                    if (dm._impl == "hash" && k != "i8" && k != "ui8" && k != "i16" && k != "ui16" && k != "i32" && k != "ui32"
+                        && k != "i64" && k != "ui64" && k != "string")
+                    {
+                        E("hash map key must be integer or string. map=" << dm._mapName << ", key=" << k);
+                    }
+                }
                 if (ele->Attribute("desc"))
                 {
                     dm._desc = ele->Attribute("desc");
                 }
+                dm._luaCodec = luaCodec;
                 AnyData info;
                 info._type = GT_DataMap;
                 info._map = dm;
@@ -256,7 +307,12 @@ std::list<AnyData> parseProto(std::string fileName, ParseCache & cache)
                     }
                     
                 }
+                if (ele->Attribute("tagged") && compareStringIgnCase(ele->Attribute("tagged"), "true"))
+                {
+                    dp._struct._tagged = true;
+                }
                 dp._struct._hadLog4z = hadLog4z;
+                dp._struct._luaCodec = luaCodec;
 
                 dp._const._type = ProtoIDType;
                 dp._const._name = dp._struct._name;
@@ -319,10 +375,37 @@ std::list<AnyData> parseProto(std::string fileName, ParseCache & cache)
                     {
                         dm._desc = member->Attribute("desc");
                     }
+                    if (member->Attribute("maxlen"))
+                    {
+                        dm._maxlen = fromString<unsigned int>(member->Attribute("maxlen"), 0);
+                        if (dm._maxlen == 0 || dm._type != "string")
+                        {
+                            E("maxlen only support positive length on string member. member=" << dm._name);
+                        }
+                    }
                     dp._struct._members.push_back(dm);
                     member = member->NextSiblingElement("member");
 
                 } while (true);
+                if (dp._struct._tagged && dp._struct._members.size() > 64)
+                {
+                    E("tagged packet member count over 64. packet=" << dp._struct._name);
+                }
+                for (const auto & m : dp._struct._members)
+                {
+                    if (m._type.compare(0, 5, "bits:") == 0 && (getBitWidth(m._type) == 0 || getBitWidth(m._type) > 64))
+                    {
+                        E("bits:N member need 1 <= N <= 64. member=" << m._name);
+                    }
+                    if (dp._struct._tagged && getBitWidth(m._type) > 0)
+                    {
+                        E("tagged packet not support bool and bits:N member. member=" << m._name);
+                    }
+                    if (isQuantLike(m._type) && getQuantType(m._type)._bits == 0)
+                    {
+                        E("quantized member need fixed8/16/32(range,precision) with range/precision in the integer range, or angle8/16. member=" << m._name << ", type=" << m._type);
+                    }
+                }
 
                 AnyData info;
                 info._type = GT_DataPacket;
@@ -335,6 +418,71 @@ std::list<AnyData> parseProto(std::string fileName, ParseCache & cache)
         } while (true);
     }
 
+    //columnar array only support the packet which members are all base type or string.
+    for (auto &info : anydata)
+    {
+        if (info._type != GT_DataArray || !info._array._columnar)
+        {
+            continue;
+        }
+        auto founder = std::find_if(anydata.begin(), anydata.end(), [&info](const AnyData & packet)
+        {
+            return packet._type == GT_DataPacket && packet._proto._struct._name == info._array._type;
+        });
+        if (founder == anydata.end() || founder->_proto._struct._tagged || founder->_proto._struct._members.empty())
+        {
+            E("columnar array need a untagged packet with members in the same file. array=" << info._array._arrayName);
+        }
+        for (const auto & m : founder->_proto._struct._members)
+        {
+            if (m._type != "i8" && m._type != "ui8" && m._type != "i16" && m._type != "ui16" && m._type != "i32" && m._type != "ui32"
+                && m._type != "i64" && m._type != "ui64" && m._type != "float" && m._type != "double" && m._type != "string")
+            {
+                E("columnar array member must be base type or string. array=" << info._array._arrayName << ", member=" << m._name);
+            }
+            info._array._columns.push_back(std::make_pair(m._name, m._type));
+        }
+    }
+
+    //array and map member get a emplace builder. skip it when nothing left after '_' stripped or the name is already used in the packet.
+    for (auto &info : anydata)
+    {
+        if (info._type != GT_DataPacket)
+        {
+            continue;
+        }
+        std::map<std::string, std::string> builders;
+        for (const auto & m : info._proto._struct._members)
+        {
+            builders[m._name] = m._name;
+        }
+        for (auto & m : info._proto._struct._members)
+        {
+            auto founder = std::find_if(anydata.begin(), anydata.end(), [&m](const AnyData & container)
+            {
+                return (container._type == GT_DataArray && container._array._arrayName == m._type)
+                    || (container._type == GT_DataMap && container._map._mapName == m._type);
+            });
+            if (founder == anydata.end())
+            {
+                continue;
+            }
+            std::string builder = getEmplaceName(m._name);
+            if (builder.empty())
+            {
+                LOGW("skip emplace builder, array or map member name has no letter besides '_'. packet=" << info._proto._struct._name << ", member=" << m._name);
+                continue;
+            }
+            if (!builders.insert(std::make_pair(builder, m._name)).second)
+            {
+                LOGW("skip emplace builder " << builder << ", the name is already used. packet=" << info._proto._struct._name
+                    << ", used by=" << builders[builder] << ", member=" << m._name);
+                continue;
+            }
+            m._emplace = builder;
+        }
+    }
+
     for (auto &info : anydata)
     {
         if (info._type != GT_DataPacket)
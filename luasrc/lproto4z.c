@@ -42,6 +42,7 @@
 #include <string.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <math.h>
 #ifdef WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -409,6 +410,1865 @@ static int unpack(lua_State * L)
     return 2;
 }
 
+//bit pos is counted from the lowest bit of the first byte, a field is moved with one shift and mask per touched byte.
+static void p4PutBits(unsigned char * data, size_t pos, unsigned long long value, int width)
+{
+    while (width > 0)
+    {
+        int shift = (int)(pos & 7);
+        int take = 8 - shift < width ? 8 - shift : width;
+        data[pos >> 3] |= (unsigned char)((value & ((1U << take) - 1)) << shift);
+        value >>= take;
+        pos += take;
+        width -= take;
+    }
+}
+
+static unsigned long long p4GetBits(const unsigned char * data, size_t pos, int width)
+{
+    unsigned long long value = 0;
+    int got = 0;
+    while (got < width)
+    {
+        int shift = (int)(pos & 7);
+        int take = 8 - shift < width - got ? 8 - shift : width - got;
+        value |= (unsigned long long)((data[pos >> 3] >> shift) & ((1U << take) - 1)) << got;
+        pos += take;
+        got += take;
+    }
+    return value;
+}
+
+static int packBits(lua_State * L)
+{
+    char bits[8 * 64] = { 0 };
+    size_t pos = 0;
+    int count = 0;
+    int i = 0;
+    luaL_checktype(L, 1, LUA_TTABLE);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    count = (int)lua_rawlen(L, 2);
+    for (i = 1; i <= count; i++)
+    {
+        unsigned long long value = 0;
+        int width = 0;
+        lua_rawgeti(L, 1, i);
+        value = (unsigned long long)lua_tointeger(L, -1);
+        lua_rawgeti(L, 2, i);
+        width = (int)lua_tointeger(L, -1);
+        lua_pop(L, 2);
+        if (width < 1 || width > 64 || pos + width > sizeof(bits) * 8)
+        {
+            return luaL_error(L, "packBits error. member %d width %d", i, width);
+        }
+        p4PutBits((unsigned char *)bits, pos, value, width);
+        pos += width;
+    }
+    lua_pushlstring(L, bits, (pos + 7) / 8);
+    return 1;
+}
+
+static int unpackBits(lua_State * L)
+{
+    size_t dataLen = 0;
+    const char * data = luaL_checklstring(L, 1, &dataLen);
+    size_t pos = (size_t)luaL_checkinteger(L, 2);
+    size_t bitPos = 0;
+    size_t totalBits = 0;
+    int count = 0;
+    int i = 0;
+    luaL_checktype(L, 3, LUA_TTABLE);
+    count = (int)lua_rawlen(L, 3);
+    for (i = 1; i <= count; i++)
+    {
+        lua_rawgeti(L, 3, i);
+        totalBits += (size_t)lua_tointeger(L, -1);
+        lua_pop(L, 1);
+    }
+    if (pos < 1 || pos - 1 + (totalBits + 7) / 8 > dataLen)
+    {
+        return luaL_error(L, "unpackBits error. need %d bytes at pos %d, data len %d", (int)((totalBits + 7) / 8), (int)pos, (int)dataLen);
+    }
+    data += pos - 1;
+    lua_createtable(L, count, 0);
+    for (i = 1; i <= count; i++)
+    {
+        unsigned long long value = 0;
+        int width = 0;
+        lua_rawgeti(L, 3, i);
+        width = (int)lua_tointeger(L, -1);
+        lua_pop(L, 1);
+        if (width < 1 || width > 64)
+        {
+            return luaL_error(L, "unpackBits error. member %d width %d", i, width);
+        }
+        value = p4GetBits((const unsigned char *)data, bitPos, width);
+        bitPos += width;
+        lua_pushinteger(L, (lua_Integer)value);
+        lua_rawseti(L, -2, i);
+    }
+    lua_pushinteger(L, pos + (totalBits + 7) / 8);
+    return 2;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//schema compiled from the Proto4z tables, one full userdata per protocol.
+//the type string is parsed once here, the codec below only switch on the code.
+//////////////////////////////////////////////////////////////////////////
+
+enum P4Code
+{
+    P4_I8, P4_UI8, P4_I16, P4_UI16, P4_I32, P4_UI32, P4_I64, P4_UI64, P4_FLOAT, P4_DOUBLE, P4_STRING, P4_PROTO,
+};
+
+enum P4Kind
+{
+    P4_STRUCT, P4_ARRAY, P4_MAP, P4_COLUMNAR,
+};
+
+enum P4Quant
+{
+    P4_QUANT_NONE, P4_QUANT_FIXED, P4_QUANT_ANGLE,
+};
+
+struct P4Desc;
+
+typedef struct P4Field
+{
+    int code;
+    int bits; //width of bool and bits:N, 0 for the other.
+    int runBits; //total width of the bits run begin at this member, 0 if not the first one.
+    int isBool;
+    int del;
+    int quant;
+    double precision;
+    double scale; //1 / precision, the c++ quantizer multiply by the same reciprocal.
+    double limit;
+    double angle;
+    struct P4Desc * child; //P4_PROTO, kept alive by the uservalue of the owner.
+} P4Field;
+
+//the uservalue is a table, [0] is the userdata itself, [i] is the name of fields[i-1],
+//[lightuserdata child] is the uservalue of the child. the cache and the codec hold the uservalue.
+typedef struct P4Desc
+{
+    int kind;
+    int withTag;
+    int count;
+    P4Field key;
+    P4Field value;
+    P4Field fields[1];
+} P4Desc;
+
+static int p4CacheKey = 0;
+
+static const char * p4CodeNames[] = { "i8", "ui8", "i16", "ui16", "i32", "ui32", "i64", "ui64", "float", "double", "string" };
+
+static int p4InnerCode(const char * tp)
+{
+    int i = 0;
+    for (i = 0; i < (int)(sizeof(p4CodeNames) / sizeof(p4CodeNames[0])); i++)
+    {
+        if (strcmp(tp, p4CodeNames[i]) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static P4Desc * p4Compile(lua_State * L, int proto, const char * name);
+
+//the Proto4z table at the top of the stack, push the uservalue of the compiled protocol.
+static P4Desc * p4Find(lua_State * L, const char * name)
+{
+    P4Desc * desc = NULL;
+    lua_getfield(L, -1, name);
+    if (!lua_istable(L, -1))
+    {
+        luaL_error(L, "proto4z schema error. [%s] is not a registered protocol", name);
+    }
+    lua_rawgetp(L, LUA_REGISTRYINDEX, &p4CacheKey);
+    lua_pushvalue(L, -2);
+    if (lua_rawget(L, -2) == LUA_TTABLE)
+    {
+        lua_rawgeti(L, -1, 0);
+        desc = (P4Desc *)lua_touserdata(L, -1);
+        lua_pop(L, 1);
+    }
+    else
+    {
+        lua_pop(L, 1);
+        desc = p4Compile(L, lua_absindex(L, -2), name);
+    }
+    lua_replace(L, -3); //keep the uservalue, pop the proto and the cache.
+    lua_pop(L, 1);
+    return desc;
+}
+
+//field desc or type name at the top of stack, uservalue of the owner at uv.
+static void p4CompileField(lua_State * L, P4Field * f, const char * tp, int uv, const char * owner)
+{
+    memset(f, 0, sizeof(*f));
+    f->code = p4InnerCode(tp);
+    if (f->code >= 0)
+    {
+        return;
+    }
+    f->code = P4_PROTO;
+    if (lua_getglobal(L, "Proto4z") != LUA_TTABLE || lua_getfield(L, -1, tp) != LUA_TTABLE)
+    {
+        luaL_error(L, "proto4z schema error. unknown type [%s] in [%s]", tp, owner);
+    }
+    lua_pop(L, 1);
+    f->child = p4Find(L, tp);
+    lua_rawsetp(L, uv, f->child);
+    lua_pop(L, 1);
+}
+
+static void p4CompileQuant(lua_State * L, P4Field * f, int quant, const char * owner)
+{
+    lua_getfield(L, quant, "wire");
+    f->code = p4InnerCode(luaL_optstring(L, -1, ""));
+    lua_getfield(L, quant, "angle");
+    lua_getfield(L, quant, "precision");
+    lua_getfield(L, quant, "limit");
+    if (f->code < P4_I8 || f->code > P4_UI32)
+    {
+        luaL_error(L, "proto4z schema error. quantized wire type in [%s]", owner);
+    }
+    if (!lua_isnil(L, -3))
+    {
+        f->quant = P4_QUANT_ANGLE;
+        f->angle = lua_tonumber(L, -3);
+    }
+    else
+    {
+        f->quant = P4_QUANT_FIXED;
+        f->precision = lua_tonumber(L, -2);
+        f->scale = 1 / f->precision;
+        f->limit = lua_tonumber(L, -1);
+    }
+    lua_pop(L, 4);
+}
+
+static P4Desc * p4Compile(lua_State * L, int proto, const char * name)
+{
+    P4Desc * desc = NULL;
+    int kind = P4_STRUCT;
+    int count = 0;
+    int uv = 0;
+    int i = 0;
+    const char * protoDesc = NULL;
+    lua_getfield(L, proto, "__protoDesc");
+    protoDesc = lua_tostring(L, -1);
+    if (protoDesc != NULL && strcmp(protoDesc, "map") == 0)
+    {
+        kind = P4_MAP;
+    }
+    else if (protoDesc != NULL && strcmp(protoDesc, "array") == 0)
+    {
+        lua_getfield(L, proto, "__columnar");
+        kind = lua_toboolean(L, -1) ? P4_COLUMNAR : P4_ARRAY;
+        lua_pop(L, 1);
+    }
+    lua_pop(L, 1);
+    if (kind == P4_STRUCT)
+    {
+        count = (int)lua_rawlen(L, proto);
+    }
+    else if (kind == P4_COLUMNAR)
+    {
+        lua_getglobal(L, "Proto4z");
+        lua_getfield(L, proto, "__protoTypeV");
+        lua_rawget(L, -2);
+        if (!lua_istable(L, -1))
+        {
+            luaL_error(L, "proto4z schema error. columnar element of [%s]", name);
+        }
+        count = (int)lua_rawlen(L, -1);
+        lua_pop(L, 2);
+    }
+
+    luaL_checkstack(L, 8, "proto4z schema too deep");
+    desc = (P4Desc *)lua_newuserdata(L, sizeof(P4Desc) + sizeof(P4Field) * (count > 0 ? count - 1 : 0));
+    memset(desc, 0, sizeof(P4Desc));
+    desc->kind = kind;
+    desc->count = count;
+    lua_createtable(L, count, 4);
+    lua_pushvalue(L, -1);
+    lua_setuservalue(L, -3);
+    lua_insert(L, -2);
+    lua_rawseti(L, -2, 0);
+    uv = lua_gettop(L);
+
+    //cache before the members, so a self referenced type find itself.
+    lua_rawgetp(L, LUA_REGISTRYINDEX, &p4CacheKey);
+    lua_pushvalue(L, proto);
+    lua_pushvalue(L, uv);
+    lua_rawset(L, -3);
+    lua_pop(L, 1);
+
+    if (kind == P4_MAP)
+    {
+        lua_getfield(L, proto, "__protoTypeK");
+        p4CompileField(L, &desc->key, luaL_optstring(L, -1, ""), uv, name);
+        lua_getfield(L, proto, "__protoTypeV");
+        p4CompileField(L, &desc->value, luaL_optstring(L, -1, ""), uv, name);
+        lua_pop(L, 2);
+        if (desc->key.code == P4_PROTO)
+        {
+            luaL_error(L, "proto4z schema error. map key of [%s] must be base type", name);
+        }
+    }
+    else if (kind == P4_ARRAY)
+    {
+        lua_getfield(L, proto, "__quant");
+        if (lua_istable(L, -1))
+        {
+            p4CompileQuant(L, &desc->value, lua_gettop(L), name);
+        }
+        else
+        {
+            lua_getfield(L, proto, "__protoTypeV");
+            p4CompileField(L, &desc->value, luaL_optstring(L, -1, ""), uv, name);
+            lua_pop(L, 1);
+        }
+        lua_pop(L, 1);
+    }
+    else
+    {
+        int withTag = 0;
+        int elem = proto;
+        int run = -1;
+        if (kind == P4_COLUMNAR)
+        {
+            lua_getglobal(L, "Proto4z");
+            lua_getfield(L, proto, "__protoTypeV");
+            lua_rawget(L, -2);
+            elem = lua_gettop(L);
+        }
+        else
+        {
+            lua_getfield(L, proto, "__withTag");
+            withTag = lua_toboolean(L, -1);
+            lua_pop(L, 1);
+        }
+        desc->withTag = withTag;
+        for (i = 0; i < count; i++)
+        {
+            P4Field * f = &desc->fields[i];
+            lua_rawgeti(L, elem, i + 1);
+            lua_getfield(L, -1, "name");
+            lua_rawseti(L, uv, i + 1);
+            lua_getfield(L, -1, "quant");
+            if (lua_istable(L, -1))
+            {
+                memset(f, 0, sizeof(*f));
+                p4CompileQuant(L, f, lua_gettop(L), name);
+                lua_pop(L, 1);
+            }
+            else
+            {
+                lua_getfield(L, -2, "bits");
+                if (lua_isinteger(L, -1))
+                {
+                    memset(f, 0, sizeof(*f));
+                    f->code = P4_UI64;
+                    f->bits = (int)lua_tointeger(L, -1);
+                    lua_getfield(L, -3, "type");
+                    f->isBool = strcmp(luaL_optstring(L, -1, ""), "bool") == 0;
+                    lua_pop(L, 1);
+                    if (f->bits < 1 || f->bits > 64 || kind == P4_COLUMNAR)
+                    {
+                        luaL_error(L, "proto4z schema error. bits member %d of [%s]", i + 1, name);
+                    }
+                }
+                else
+                {
+                    lua_getfield(L, -3, "type");
+                    p4CompileField(L, f, luaL_optstring(L, -1, ""), uv, name);
+                    lua_pop(L, 1);
+                }
+                lua_pop(L, 2);
+            }
+            lua_getfield(L, -1, "del");
+            f->del = lua_toboolean(L, -1);
+            lua_pop(L, 2);
+            if (kind == P4_COLUMNAR && (f->code == P4_PROTO || f->quant != P4_QUANT_NONE))
+            {
+                luaL_error(L, "proto4z schema error. columnar member %d of [%s] must be base type", i + 1, name);
+            }
+            if (f->bits > 0 && run >= 0)
+            {
+                desc->fields[run].runBits += f->bits;
+            }
+            else if (f->bits > 0)
+            {
+                run = i;
+                f->runBits = f->bits;
+            }
+            else
+            {
+                run = -1;
+            }
+        }
+        if (kind == P4_COLUMNAR)
+        {
+            lua_pop(L, 2);
+        }
+    }
+    return desc;
+}
+
+//Proto4z.__with_tag force every struct tagged, same as proto4z.lua.
+static int p4ForceTag(lua_State * L)
+{
+    int force = 0;
+    lua_getfield(L, -1, "__with_tag");
+    force = lua_toboolean(L, -1);
+    lua_pop(L, 1);
+    return force;
+}
+
+//find the compiled protocol of name, push the uservalue and return it.
+static P4Desc * p4Check(lua_State * L, int nameIndex, int * forceTag)
+{
+    const char * name = luaL_checkstring(L, nameIndex);
+    P4Desc * desc = NULL;
+    lua_rawgetp(L, LUA_REGISTRYINDEX, &p4CacheKey);
+    if (lua_isnil(L, -1))
+    {
+        lua_newtable(L);
+        lua_createtable(L, 0, 1);
+        lua_pushstring(L, "k"); //a reloaded schema table get compiled again, the old one is collected.
+        lua_setfield(L, -2, "__mode");
+        lua_setmetatable(L, -2);
+        lua_rawsetp(L, LUA_REGISTRYINDEX, &p4CacheKey);
+    }
+    lua_pop(L, 1);
+    if (lua_getglobal(L, "Proto4z") != LUA_TTABLE)
+    {
+        luaL_error(L, "proto4z schema error. require proto4z.lua first");
+    }
+    *forceTag = p4ForceTag(L);
+    desc = p4Find(L, name);
+    lua_remove(L, -2);
+    return desc;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//decode
+//////////////////////////////////////////////////////////////////////////
+
+typedef struct P4Reader
+{
+    lua_State * L;
+    const char * data;
+    size_t len;
+    size_t pos; //0 based
+    int forceTag;
+    int pool; //index of the table pool with decodeInto, 0 with decode
+} P4Reader;
+
+static void p4ReadCheck(P4Reader * r, size_t need, const char * what)
+{
+    if (need > r->len - r->pos)
+    {
+        luaL_error(r->L, "unpack error. the current pos is invalid. cur pos=%d, type=%s, blockSize=%d", (int)r->pos + 1, what, (int)r->len);
+    }
+}
+
+static unsigned int p4ReadCount(P4Reader * r)
+{
+    unsigned int count = 0;
+    p4ReadCheck(r, 4, "ui32");
+    memcpy(&count, r->data + r->pos, 4);
+    r->pos += 4;
+    return count;
+}
+
+//read a base type value, return 1 if it is a integer.
+static int p4ReadNumber(P4Reader * r, int code, lua_Integer * i, lua_Number * n)
+{
+    static const size_t sizes[] = { 1, 1, 2, 2, 4, 4, 8, 8, 4, 8 };
+    const char * p = r->data + r->pos;
+    p4ReadCheck(r, sizes[code], "number");
+    r->pos += sizes[code];
+    switch (code)
+    {
+    case P4_I8: { signed char v; memcpy(&v, p, 1); *i = v; return 1; }
+    case P4_UI8: { unsigned char v; memcpy(&v, p, 1); *i = v; return 1; }
+    case P4_I16: { short v; memcpy(&v, p, 2); *i = v; return 1; }
+    case P4_UI16: { unsigned short v; memcpy(&v, p, 2); *i = v; return 1; }
+    case P4_I32: { int v; memcpy(&v, p, 4); *i = v; return 1; }
+    case P4_UI32: { unsigned int v; memcpy(&v, p, 4); *i = v; return 1; }
+    case P4_I64: { long long v; memcpy(&v, p, 8); *i = (lua_Integer)v; return 1; }
+    case P4_UI64: { unsigned long long v; memcpy(&v, p, 8); *i = (lua_Integer)v; return 1; }
+    case P4_FLOAT: { float v; memcpy(&v, p, 4); *n = v; return 0; }
+    default: { double v; memcpy(&v, p, 8); *n = v; return 0; }
+    }
+}
+
+//table pool of decodeInto, the tables released by decodeInto and recycle are reused by decodeInto and newTable.
+#define P4_POOL_LIMIT 4096
+#define P4_RECYCLE_DEPTH 16
+
+static int p4PoolKey = 0;
+
+//push the pool table.
+static int p4PushPool(lua_State * L)
+{
+    if (lua_rawgetp(L, LUA_REGISTRYINDEX, &p4PoolKey) != LUA_TTABLE)
+    {
+        lua_pop(L, 1);
+        lua_createtable(L, 64, 0);
+        lua_pushvalue(L, -1);
+        lua_rawsetp(L, LUA_REGISTRYINDEX, &p4PoolKey);
+    }
+    return lua_gettop(L);
+}
+
+//clear the table at index and put it into the pool, the nested tables too.
+static void p4Recycle(lua_State * L, int pool, int index, int depth)
+{
+    lua_Integer size = 0;
+    index = lua_absindex(L, index);
+    if (!lua_istable(L, index) || depth > P4_RECYCLE_DEPTH)
+    {
+        return;
+    }
+    if (lua_getmetatable(L, index))
+    {
+        lua_pop(L, 1); //not a plain table, leave it to the owner
+        return;
+    }
+    luaL_checkstack(L, 4, "proto4z recycle too deep");
+    lua_pushnil(L);
+    while (lua_next(L, index) != 0)
+    {
+        p4Recycle(L, pool, -1, depth + 1);
+        lua_pop(L, 1);
+        lua_pushvalue(L, -1);
+        lua_pushnil(L);
+        lua_rawset(L, index);
+    }
+    size = (lua_Integer)lua_rawlen(L, pool);
+    if (size < P4_POOL_LIMIT)
+    {
+        lua_pushvalue(L, index);
+        lua_rawseti(L, pool, size + 1);
+    }
+}
+
+//push a table from the pool if decodeInto, or a new one.
+static void p4NewTable(P4Reader * r, int narr, int nrec)
+{
+    lua_State * L = r->L;
+    lua_Integer size = r->pool ? (lua_Integer)lua_rawlen(L, r->pool) : 0;
+    if (size > 0)
+    {
+        lua_rawgeti(L, r->pool, size);
+        lua_pushnil(L);
+        lua_rawseti(L, r->pool, size);
+        return;
+    }
+    lua_createtable(L, narr, nrec);
+}
+
+//release the old value at index before it is replaced.
+static void p4Release(P4Reader * r, int index)
+{
+    if (r->pool && lua_istable(r->L, index))
+    {
+        p4Recycle(r->L, r->pool, index, 0);
+    }
+}
+
+static void p4DecodeDesc(P4Reader * r, const P4Desc * desc, int uv, int target);
+
+//push one value, uv is the uservalue of the owner.
+//old is the index of the old value to reuse with decodeInto, 0 if none.
+static void p4DecodeValue(P4Reader * r, const P4Field * f, int uv, int old)
+{
+    lua_State * L = r->L;
+    lua_Integer i = 0;
+    lua_Number n = 0;
+    if (f->code == P4_PROTO)
+    {
+        int target = old && lua_istable(L, old) ? old : 0;
+        lua_rawgetp(L, uv, f->child);
+        p4DecodeDesc(r, f->child, lua_gettop(L), target);
+        lua_remove(L, -2);
+        return;
+    }
+    if (old)
+    {
+        p4Release(r, old);
+    }
+    if (f->code == P4_STRING)
+    {
+        unsigned int len = p4ReadCount(r);
+        p4ReadCheck(r, len, "string");
+        lua_pushlstring(L, r->data + r->pos, len);
+        r->pos += len;
+    }
+    else if (p4ReadNumber(r, f->code, &i, &n))
+    {
+        if (f->quant == P4_QUANT_FIXED)
+        {
+            lua_pushnumber(L, (lua_Number)i * f->precision);
+        }
+        else if (f->quant == P4_QUANT_ANGLE)
+        {
+            lua_pushnumber(L, (lua_Number)(i * 360) / f->angle);
+        }
+        else
+        {
+            lua_pushinteger(L, i);
+        }
+    }
+    else
+    {
+        lua_pushnumber(L, n);
+    }
+}
+
+//the bits run begin at fields[first], set the members to the table at the top.
+static int p4DecodeBits(P4Reader * r, const P4Desc * desc, int first, int uv)
+{
+    lua_State * L = r->L;
+    const unsigned char * data = NULL;
+    size_t bytes = (desc->fields[first].runBits + 7) / 8;
+    size_t bitPos = 0;
+    int i = first;
+    p4ReadCheck(r, bytes, "bits");
+    data = (const unsigned char *)r->data + r->pos;
+    for (; i < desc->count && desc->fields[i].bits > 0 && (i == first || desc->fields[i].runBits == 0); i++)
+    {
+        const P4Field * f = &desc->fields[i];
+        unsigned long long value = p4GetBits(data, bitPos, f->bits);
+        bitPos += f->bits;
+        lua_rawgeti(L, uv, i + 1);
+        if (f->isBool)
+        {
+            lua_pushboolean(L, value != 0);
+        }
+        else
+        {
+            lua_pushinteger(L, (lua_Integer)value);
+        }
+        lua_rawset(L, -3);
+    }
+    r->pos += bytes;
+    return i;
+}
+
+//push the table of target, or a new table if target is 0.
+static int p4PushTarget(P4Reader * r, int target, int narr, int nrec)
+{
+    if (target)
+    {
+        lua_pushvalue(r->L, target);
+    }
+    else
+    {
+        p4NewTable(r, narr, nrec);
+    }
+    return lua_gettop(r->L);
+}
+
+static void p4DecodeStruct(P4Reader * r, const P4Desc * desc, int uv, int target)
+{
+    lua_State * L = r->L;
+    unsigned long long tag = 0;
+    size_t tail = 0;
+    int withTag = desc->withTag || r->forceTag;
+    int result = 0;
+    int i = 0;
+    if (withTag)
+    {
+        unsigned int offset = p4ReadCount(r);
+        p4ReadCheck(r, offset, "tag");
+        tail = r->pos + offset;
+        p4ReadCheck(r, 8, "tag");
+        memcpy(&tag, r->data + r->pos, 8);
+        r->pos += 8;
+    }
+    result = p4PushTarget(r, target, 0, desc->count);
+    while (i < desc->count)
+    {
+        const P4Field * f = &desc->fields[i];
+        if (f->bits > 0)
+        {
+            i = p4DecodeBits(r, desc, i, uv);
+            continue;
+        }
+        if ((!withTag && !f->del) || (withTag && i < 64 && (tag & ((unsigned long long)1 << i))))
+        {
+            lua_rawgeti(L, uv, i + 1);
+            if (target)
+            {
+                lua_pushvalue(L, -1);
+                lua_rawget(L, result);
+                p4DecodeValue(r, f, uv, lua_gettop(L));
+                lua_remove(L, -2);
+            }
+            else
+            {
+                p4DecodeValue(r, f, uv, 0);
+            }
+            lua_rawset(L, result);
+        }
+        else if (target)
+        {
+            //the member is absent, same as a new table
+            lua_rawgeti(L, uv, i + 1);
+            lua_pushvalue(L, -1);
+            lua_rawget(L, result);
+            p4Release(r, -1);
+            lua_pop(L, 1);
+            lua_pushnil(L);
+            lua_rawset(L, result);
+        }
+        i++;
+    }
+    if (withTag)
+    {
+        r->pos = tail;
+    }
+}
+
+//remove the elements after count of the array at index.
+static void p4Truncate(P4Reader * r, int index, lua_Integer count, lua_Integer oldCount)
+{
+    lua_State * L = r->L;
+    lua_Integer i = 0;
+    for (i = oldCount; i > count; i--)
+    {
+        lua_rawgeti(L, index, i);
+        p4Release(r, -1);
+        lua_pop(L, 1);
+        lua_pushnil(L);
+        lua_rawseti(L, index, i);
+    }
+}
+
+static void p4DecodeColumns(P4Reader * r, const P4Desc * desc, int uv, unsigned int count, int hint, int target)
+{
+    lua_State * L = r->L;
+    lua_Integer oldCount = target ? (lua_Integer)lua_rawlen(L, target) : 0;
+    unsigned int i = 0;
+    int c = 0;
+    int result = 0;
+    if (count > 0 && desc->count == 0)
+    {
+        luaL_error(L, "unpack error. columnar array without column.");
+    }
+    result = p4PushTarget(r, target, hint, 0);
+    for (i = 0; i < count; i++)
+    {
+        if (i < oldCount && lua_rawgeti(L, result, i + 1) == LUA_TTABLE)
+        {
+            lua_pop(L, 1); //every column is overwritten
+            continue;
+        }
+        if (i < oldCount)
+        {
+            lua_pop(L, 1);
+        }
+        p4NewTable(r, 0, desc->count);
+        lua_rawseti(L, result, i + 1);
+    }
+    p4Truncate(r, result, count, oldCount);
+    for (c = 0; c < desc->count; c++)
+    {
+        const P4Field * f = &desc->fields[c];
+        size_t lens = r->pos;
+        if (f->code == P4_STRING)
+        {
+            p4ReadCheck(r, (size_t)count * 4, "string");
+            r->pos += (size_t)count * 4;
+        }
+        for (i = 0; i < count; i++)
+        {
+            lua_rawgeti(L, result, i + 1);
+            lua_rawgeti(L, uv, c + 1);
+            if (f->code == P4_STRING)
+            {
+                unsigned int len = 0;
+                memcpy(&len, r->data + lens + (size_t)i * 4, 4);
+                p4ReadCheck(r, len, "string");
+                lua_pushlstring(L, r->data + r->pos, len);
+                r->pos += len;
+            }
+            else
+            {
+                p4DecodeValue(r, f, uv, 0);
+            }
+            lua_rawset(L, -3);
+            lua_pop(L, 1);
+        }
+    }
+}
+
+static size_t p4MinBytes(P4Reader * r, const P4Field * f);
+
+//the least wire bytes of the untagged members, also the row of a columnar array.
+static size_t p4FieldsMinBytes(P4Reader * r, const P4Desc * desc)
+{
+    size_t bytes = 0;
+    int i = 0;
+    for (i = 0; i < desc->count; i++)
+    {
+        const P4Field * f = &desc->fields[i];
+        if (f->bits > 0)
+        {
+            bytes += (f->runBits + 7) / 8;
+        }
+        else if (!f->del)
+        {
+            bytes += p4MinBytes(r, f);
+        }
+    }
+    return bytes;
+}
+
+//the least wire bytes of one value, a array or map only has the count, a tagged struct has the offset and the tag.
+static size_t p4MinBytes(P4Reader * r, const P4Field * f)
+{
+    static const size_t sizes[] = { 1, 1, 2, 2, 4, 4, 8, 8, 4, 8 };
+    if (f->code == P4_STRING)
+    {
+        return 4;
+    }
+    if (f->code != P4_PROTO)
+    {
+        return sizes[f->code];
+    }
+    if (f->child->kind != P4_STRUCT)
+    {
+        return 4;
+    }
+    if (f->child->withTag || r->forceTag)
+    {
+        return 12;
+    }
+    return p4FieldsMinBytes(r, f->child);
+}
+
+//push the result table, uv is the uservalue of desc.
+//target is the index of the table to decode into with decodeInto, 0 for a new table.
+static void p4DecodeDesc(P4Reader * r, const P4Desc * desc, int uv, int target)
+{
+    lua_State * L = r->L;
+    unsigned int count = 0;
+    unsigned int i = 0;
+    size_t row = 0;
+    int hint = 0;
+    int result = 0;
+    luaL_checkstack(L, 8, "proto4z decode too deep");
+    if (desc->kind == P4_STRUCT)
+    {
+        p4DecodeStruct(r, desc, uv, target);
+        return;
+    }
+    count = p4ReadCount(r);
+    if (desc->kind == P4_MAP)
+    {
+        row = p4MinBytes(r, &desc->key) + p4MinBytes(r, &desc->value);
+    }
+    else if (desc->kind == P4_ARRAY)
+    {
+        row = p4MinBytes(r, &desc->value);
+    }
+    else
+    {
+        row = p4FieldsMinBytes(r, desc);
+    }
+    //fail before any row is created. a empty struct row is counted as one byte, a forged count can not loop without input.
+    if ((unsigned long long)count * (row > 0 ? row : 1) > r->len - r->pos)
+    {
+        luaL_error(L, "unpack error. count over stream. count=%d, row bytes=%d, unread=%d", (int)count, (int)row, (int)(r->len - r->pos));
+    }
+    hint = count > r->len - r->pos ? (int)(r->len - r->pos) : (int)count; //never trust the count to preallocate.
+    if (desc->kind == P4_MAP)
+    {
+        result = p4PushTarget(r, target, 0, hint);
+        if (target)
+        {
+            //the keys change, the old values go to the pool and come back as the new values.
+            lua_pushnil(L);
+            while (lua_next(L, result) != 0)
+            {
+                p4Release(r, -1);
+                lua_pop(L, 1);
+                lua_pushvalue(L, -1);
+                lua_pushnil(L);
+                lua_rawset(L, result);
+            }
+        }
+        for (i = 0; i < count; i++)
+        {
+            p4DecodeValue(r, &desc->key, uv, 0);
+            p4DecodeValue(r, &desc->value, uv, 0);
+            lua_rawset(L, result);
+        }
+    }
+    else if (desc->kind == P4_ARRAY)
+    {
+        lua_Integer oldCount = target ? (lua_Integer)lua_rawlen(L, target) : 0;
+        result = p4PushTarget(r, target, hint, 0);
+        for (i = 0; i < count; i++)
+        {
+            if (i < oldCount)
+            {
+                lua_rawgeti(L, result, i + 1);
+                p4DecodeValue(r, &desc->value, uv, lua_gettop(L));
+                lua_remove(L, -2);
+            }
+            else
+            {
+                p4DecodeValue(r, &desc->value, uv, 0);
+            }
+            lua_rawseti(L, result, i + 1);
+        }
+        p4Truncate(r, result, count, oldCount);
+    }
+    else
+    {
+        p4DecodeColumns(r, desc, uv, count, hint, target);
+    }
+}
+
+//the host buffer type, a full userdata of raw bytes. other full userdata may hold a object of the host, they are never written.
+#define P4_BYTES_META "proto4z.bytes"
+
+//the memory of a string, a proto4z.bytes or a light userdata, the host buffer is used without copy.
+//len at lenIndex is required by light userdata, and limits the string and the proto4z.bytes.
+static char * p4CheckBytes(lua_State * L, int index, int lenIndex, size_t * len, int writable)
+{
+    int type = lua_type(L, index);
+    char * data = NULL;
+    if (type == LUA_TSTRING && !writable)
+    {
+        data = (char *)lua_tolstring(L, index, len);
+    }
+    else if (type == LUA_TUSERDATA && (data = (char *)luaL_testudata(L, index, P4_BYTES_META)) != NULL)
+    {
+        *len = lua_rawlen(L, index);
+    }
+    else if (type == LUA_TLIGHTUSERDATA)
+    {
+        lua_Integer limit = luaL_checkinteger(L, lenIndex);
+        luaL_argcheck(L, limit >= 0, lenIndex, "len out of range");
+        *len = (size_t)limit;
+        return (char *)lua_touserdata(L, index);
+    }
+    else
+    {
+        luaL_argerror(L, index, writable ? "proto4z.bytes or light userdata expected" : "string, proto4z.bytes or light userdata expected");
+    }
+    if (!lua_isnoneornil(L, lenIndex))
+    {
+        lua_Integer limit = luaL_checkinteger(L, lenIndex);
+        luaL_argcheck(L, limit >= 0 && (size_t)limit <= *len, lenIndex, "len out of range");
+        *len = (size_t)limit;
+    }
+    return data;
+}
+
+//a zero filled proto4z.bytes of size, data is copied to the front.
+//a c host create one with lua_newuserdata and luaL_setmetatable(L, "proto4z.bytes").
+//example: local buffer = newBytes(1024 [, data])
+static int newBytes(lua_State * L)
+{
+    lua_Integer size = luaL_checkinteger(L, 1);
+    size_t dataLen = 0;
+    const char * data = luaL_optlstring(L, 2, "", &dataLen);
+    char * bytes = NULL;
+    luaL_argcheck(L, size >= 0 && (size_t)size >= dataLen, 1, "size out of range");
+    bytes = (char *)lua_newuserdata(L, (size_t)size);
+    memset(bytes, 0, (size_t)size);
+    memcpy(bytes, data, dataLen);
+    luaL_setmetatable(L, P4_BYTES_META);
+    return 1;
+}
+
+//decode a protocol with the compiled schema, the result is the same as Proto4z.decode.
+//bin is a string, or the memory of a userdata with len.
+//example: local result, nextPos = Proto4zUtil.decode(bin, "EchoPack" [, pos [, len]])
+static int decode(lua_State * L)
+{
+    P4Reader r;
+    P4Desc * desc = NULL;
+    size_t pos = 0;
+    r.L = L;
+    r.pool = 0;
+    r.data = p4CheckBytes(L, 1, 4, &r.len, 0);
+    pos = (size_t)luaL_optinteger(L, 3, 1);
+    if (pos < 1 || pos > r.len + 1)
+    {
+        return luaL_error(L, "decode error. pos=%d, len=%d", (int)pos, (int)r.len);
+    }
+    r.pos = pos - 1;
+    desc = p4Check(L, 2, &r.forceTag);
+    p4DecodeDesc(&r, desc, lua_gettop(L), 0);
+    lua_pushinteger(L, (lua_Integer)r.pos + 1);
+    return 2;
+}
+
+//decode into the target table, reuse the nested tables and truncate the arrays in place.
+//the replaced tables go to the pool, the target tree is owned by decodeInto.
+//example: local target, nextPos = Proto4zUtil.decodeInto(bin, "EchoPack", target [, pos [, len]])
+static int decodeInto(lua_State * L)
+{
+    P4Reader r;
+    P4Desc * desc = NULL;
+    size_t pos = 0;
+    r.L = L;
+    r.data = p4CheckBytes(L, 1, 5, &r.len, 0);
+    luaL_checktype(L, 3, LUA_TTABLE);
+    pos = (size_t)luaL_optinteger(L, 4, 1);
+    if (pos < 1 || pos > r.len + 1)
+    {
+        return luaL_error(L, "decode error. pos=%d, len=%d", (int)pos, (int)r.len);
+    }
+    r.pos = pos - 1;
+    lua_settop(L, 3);
+    r.pool = p4PushPool(L);
+    desc = p4Check(L, 2, &r.forceTag);
+    p4DecodeDesc(&r, desc, lua_gettop(L), 3);
+    lua_pushinteger(L, (lua_Integer)r.pos + 1);
+    return 2;
+}
+
+//a table from the pool of decodeInto, or a new one.
+//example: local t = newTable()
+static int newTable(lua_State * L)
+{
+    P4Reader r;
+    r.L = L;
+    r.pool = p4PushPool(L);
+    p4NewTable(&r, 0, 0);
+    return 1;
+}
+
+//clear the table and the nested tables, put them into the pool of decodeInto.
+//example: recycle(t)
+static int recycle(lua_State * L)
+{
+    luaL_checktype(L, 1, LUA_TTABLE);
+    lua_settop(L, 1);
+    p4Recycle(L, p4PushPool(L), 1, 0);
+    return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//encode
+//////////////////////////////////////////////////////////////////////////
+
+//growable buffer in a full userdata, the shared one in the registry is reused by every encode.
+typedef struct P4Buffer
+{
+    char * data;
+    size_t len;
+    size_t cap;
+    int busy;
+    int fixed; //the memory of the host with encodeTo, never grow
+} P4Buffer;
+
+#define P4_BUFFER_META "proto4z.buffer"
+#define P4_BUFFER_KEEP (1024 * 1024)
+static int p4BufferKey = 0;
+
+static int p4BufferGC(lua_State * L)
+{
+    P4Buffer * buf = (P4Buffer *)luaL_checkudata(L, 1, P4_BUFFER_META);
+    free(buf->data);
+    buf->data = NULL;
+    buf->len = 0;
+    buf->cap = 0;
+    return 0;
+}
+
+static P4Buffer * p4NewBuffer(lua_State * L)
+{
+    P4Buffer * buf = (P4Buffer *)lua_newuserdata(L, sizeof(P4Buffer));
+    memset(buf, 0, sizeof(P4Buffer));
+    if (luaL_newmetatable(L, P4_BUFFER_META))
+    {
+        lua_pushcfunction(L, p4BufferGC);
+        lua_setfield(L, -2, "__gc");
+    }
+    lua_setmetatable(L, -2);
+    return buf;
+}
+
+//push the shared buffer, or a new one if the shared is in use by a metamethod which encode again.
+static P4Buffer * p4SharedBuffer(lua_State * L)
+{
+    P4Buffer * buf = NULL;
+    lua_rawgetp(L, LUA_REGISTRYINDEX, &p4BufferKey);
+    buf = (P4Buffer *)lua_touserdata(L, -1);
+    if (buf == NULL)
+    {
+        lua_pop(L, 1);
+        buf = p4NewBuffer(L);
+        lua_pushvalue(L, -1);
+        lua_rawsetp(L, LUA_REGISTRYINDEX, &p4BufferKey);
+    }
+    else if (buf->busy)
+    {
+        lua_pop(L, 1);
+        buf = p4NewBuffer(L);
+    }
+    buf->len = 0;
+    return buf;
+}
+
+//done with the buffer, a large one is not kept.
+static void p4ReleaseBuffer(P4Buffer * buf)
+{
+    buf->busy = 0;
+    buf->len = 0;
+    if (buf->cap > P4_BUFFER_KEEP)
+    {
+        free(buf->data);
+        buf->data = NULL;
+        buf->cap = 0;
+    }
+}
+
+typedef struct P4Writer
+{
+    lua_State * L;
+    P4Buffer * buf;
+    int forceTag;
+} P4Writer;
+
+static char * p4Reserve(P4Writer * w, size_t n)
+{
+    P4Buffer * buf = w->buf;
+    char * p = NULL;
+    if (n > buf->cap - buf->len)
+    {
+        size_t cap = buf->cap < 256 ? 256 : buf->cap;
+        char * data = NULL;
+        if (buf->fixed)
+        {
+            luaL_error(w->L, "pack error. the buffer is too small. size=%d", (int)buf->cap);
+        }
+        while (cap - buf->len < n)
+        {
+            cap *= 2;
+        }
+        data = (char *)realloc(buf->data, cap);
+        if (data == NULL)
+        {
+            luaL_error(w->L, "pack error. out of memory. size=%d", (int)cap);
+        }
+        buf->data = data;
+        buf->cap = cap;
+    }
+    p = buf->data + buf->len;
+    buf->len += n;
+    return p;
+}
+
+static void p4WriteCount(P4Writer * w, size_t pos, size_t count)
+{
+    unsigned int v = (unsigned int)count;
+    memcpy(w->buf->data + pos, &v, 4);
+}
+
+//same as Proto4z.__encode, string member must be string or nil, nil number is 0.
+static void p4WriteNumber(P4Writer * w, int code, int index)
+{
+    static const size_t sizes[] = { 1, 1, 2, 2, 4, 4, 8, 8, 4, 8 };
+    lua_State * L = w->L;
+    char * p = p4Reserve(w, sizes[code]);
+    int isnum = 1;
+    if (code <= P4_UI32)
+    {
+        lua_Integer v = lua_isnil(L, index) ? 0 : lua_tointegerx(L, index, &isnum);
+        switch (code)
+        {
+        case P4_I8: case P4_UI8: { unsigned char c = (unsigned char)v; memcpy(p, &c, 1); } break;
+        case P4_I16: case P4_UI16: { unsigned short c = (unsigned short)v; memcpy(p, &c, 2); } break;
+        default: { unsigned int c = (unsigned int)v; memcpy(p, &c, 4); } break;
+        }
+    }
+    else if (code <= P4_UI64)
+    {
+        long long v = 0;
+        if (lua_isinteger(L, index))
+        {
+            v = (long long)lua_tointeger(L, index);
+        }
+        else if (!lua_isnil(L, index))
+        {
+            lua_Number n = lua_tonumberx(L, index, &isnum);
+            v = code == P4_I64 ? (long long)n : (long long)(unsigned long long)n;
+        }
+        memcpy(p, &v, 8);
+    }
+    else
+    {
+        lua_Number n = lua_isnil(L, index) ? 0 : lua_tonumberx(L, index, &isnum);
+        if (code == P4_FLOAT)
+        {
+            float f = (float)n;
+            memcpy(p, &f, 4);
+        }
+        else
+        {
+            double d = (double)n;
+            memcpy(p, &d, 8);
+        }
+    }
+    if (!isnum)
+    {
+        luaL_error(L, "pack error. %s expected, got %s", code <= P4_UI32 ? "integer" : "number",
+            lua_type(L, index) == LUA_TNUMBER ? "non-integral number" : luaL_typename(L, index));
+    }
+}
+
+static void p4WriteString(P4Writer * w, int index)
+{
+    size_t len = 0;
+    const char * str = "";
+    if (lua_type(w->L, index) == LUA_TSTRING)
+    {
+        str = lua_tolstring(w->L, index, &len);
+    }
+    else if (!lua_isnil(w->L, index))
+    {
+        luaL_error(w->L, "pack error. string expected, got %s", luaL_typename(w->L, index));
+    }
+    p4Reserve(w, 4);
+    p4WriteCount(w, w->buf->len - 4, len);
+    memcpy(p4Reserve(w, len), str, len);
+}
+
+//same rounding and clamp as quantize in proto4z.lua.
+static void p4WriteQuant(P4Writer * w, const P4Field * f, int index)
+{
+    lua_Number v = lua_tonumber(w->L, index);
+    lua_Integer q = 0;
+    if (f->quant == P4_QUANT_ANGLE)
+    {
+        lua_Number turn = fmod(v, 360);
+        turn = turn < 0 ? turn + 360 : (turn == turn ? turn : 0);
+        q = (lua_Integer)floor(turn / 360 * f->angle + 0.5) % (lua_Integer)f->angle;
+    }
+    else
+    {
+        lua_Number r = v * f->scale;
+        r = r == r ? r : 0;
+        r = r > f->limit ? f->limit : (r < -f->limit ? -f->limit : r);
+        q = (lua_Integer)(r < 0 ? ceil(r - 0.5) : floor(r + 0.5));
+    }
+    lua_pushinteger(w->L, q);
+    p4WriteNumber(w, f->code, lua_gettop(w->L));
+    lua_pop(w->L, 1);
+}
+
+static void p4EncodeDesc(P4Writer * w, const P4Desc * desc, int uv, int obj);
+
+//encode the value at index, uv is the uservalue of the owner.
+static void p4EncodeValue(P4Writer * w, const P4Field * f, int uv, int index)
+{
+    lua_State * L = w->L;
+    index = lua_absindex(L, index);
+    if (f->code == P4_PROTO)
+    {
+        lua_rawgetp(L, uv, f->child);
+        p4EncodeDesc(w, f->child, lua_gettop(L), index);
+        lua_pop(L, 1);
+    }
+    else if (f->code == P4_STRING)
+    {
+        p4WriteString(w, index);
+    }
+    else if (f->quant != P4_QUANT_NONE)
+    {
+        p4WriteQuant(w, f, index);
+    }
+    else
+    {
+        p4WriteNumber(w, f->code, index);
+    }
+}
+
+//the bits run begin at fields[first], the members are read from obj.
+static int p4EncodeBits(P4Writer * w, const P4Desc * desc, int first, int uv, int obj)
+{
+    lua_State * L = w->L;
+    size_t bytes = (desc->fields[first].runBits + 7) / 8;
+    unsigned char * data = (unsigned char *)p4Reserve(w, bytes);
+    size_t bitPos = 0;
+    int i = first;
+    memset(data, 0, bytes);
+    for (; i < desc->count && desc->fields[i].bits > 0 && (i == first || desc->fields[i].runBits == 0); i++)
+    {
+        const P4Field * f = &desc->fields[i];
+        unsigned long long value = 0;
+        if (obj > 0)
+        {
+            lua_rawgeti(L, uv, i + 1);
+            lua_gettable(L, obj);
+            value = lua_isboolean(L, -1) ? (unsigned long long)lua_toboolean(L, -1) : (unsigned long long)lua_tointeger(L, -1);
+            lua_pop(L, 1);
+            data = (unsigned char *)w->buf->data + w->buf->len - bytes; //a metamethod may encode and move the buffer.
+        }
+        p4PutBits(data, bitPos, value, f->bits);
+        bitPos += f->bits;
+    }
+    return i;
+}
+
+static void p4EncodeStruct(P4Writer * w, const P4Desc * desc, int uv, int obj)
+{
+    lua_State * L = w->L;
+    unsigned long long tag = 0;
+    size_t head = 0;
+    int withTag = desc->withTag || w->forceTag;
+    int i = 0;
+    if (!lua_istable(L, obj))
+    {
+        obj = 0; //same as an empty table.
+    }
+    if (withTag)
+    {
+        head = w->buf->len;
+        p4Reserve(w, 12);
+    }
+    while (i < desc->count)
+    {
+        const P4Field * f = &desc->fields[i];
+        if (f->bits > 0)
+        {
+            i = p4EncodeBits(w, desc, i, uv, obj);
+            continue;
+        }
+        if (obj > 0)
+        {
+            lua_rawgeti(L, uv, i + 1);
+            lua_gettable(L, obj);
+        }
+        else
+        {
+            lua_pushnil(L);
+        }
+        if (!f->del && (!withTag || !lua_isnil(L, -1)))
+        {
+            if (withTag && i < 64)
+            {
+                tag |= (unsigned long long)1 << i;
+            }
+            p4EncodeValue(w, f, uv, -1);
+        }
+        lua_pop(L, 1);
+        i++;
+    }
+    if (withTag)
+    {
+        p4WriteCount(w, head, w->buf->len - head - 4);
+        memcpy(w->buf->data + head + 4, &tag, 8);
+    }
+}
+
+static void p4EncodeColumns(P4Writer * w, const P4Desc * desc, int uv, int obj, lua_Integer count)
+{
+    lua_State * L = w->L;
+    lua_Integer i = 0;
+    int c = 0;
+    int pass = 0;
+    for (c = 0; c < desc->count; c++)
+    {
+        const P4Field * f = &desc->fields[c];
+        //string column is all the lengths then all the bytes.
+        for (pass = (f->code == P4_STRING ? 0 : 1); pass < 2; pass++)
+        {
+            for (i = 1; i <= count; i++)
+            {
+                lua_geti(L, obj, i);
+                if (lua_istable(L, -1))
+                {
+                    lua_rawgeti(L, uv, c + 1);
+                    lua_gettable(L, -2);
+                }
+                else
+                {
+                    lua_pushnil(L);
+                }
+                if (f->code != P4_STRING)
+                {
+                    p4EncodeValue(w, f, uv, -1);
+                }
+                else
+                {
+                    size_t len = 0;
+                    const char * str = lua_type(L, -1) == LUA_TSTRING ? lua_tolstring(L, -1, &len) : "";
+                    if (pass == 0)
+                    {
+                        p4Reserve(w, 4);
+                        p4WriteCount(w, w->buf->len - 4, len);
+                    }
+                    else
+                    {
+                        memcpy(p4Reserve(w, len), str, len);
+                    }
+                }
+                lua_pop(L, 2);
+            }
+        }
+    }
+}
+
+//encode the value at obj, uv is the uservalue of desc.
+static void p4EncodeDesc(P4Writer * w, const P4Desc * desc, int uv, int obj)
+{
+    lua_State * L = w->L;
+    lua_Integer count = 0;
+    lua_Integer i = 0;
+    size_t head = 0;
+    luaL_checkstack(L, 8, "proto4z encode too deep");
+    if (desc->kind == P4_STRUCT)
+    {
+        p4EncodeStruct(w, desc, uv, obj);
+        return;
+    }
+    head = w->buf->len;
+    p4Reserve(w, 4);
+    if (!lua_istable(L, obj))
+    {
+        p4WriteCount(w, head, 0);
+        return;
+    }
+    if (desc->kind == P4_MAP)
+    {
+        lua_pushnil(L);
+        while (lua_next(L, obj) != 0)
+        {
+            p4EncodeValue(w, &desc->key, uv, -2);
+            p4EncodeValue(w, &desc->value, uv, -1);
+            lua_pop(L, 1);
+            count++;
+        }
+        p4WriteCount(w, head, (size_t)count);
+        return;
+    }
+    count = luaL_len(L, obj);
+    p4WriteCount(w, head, (size_t)count);
+    if (desc->kind == P4_ARRAY)
+    {
+        for (i = 1; i <= count; i++)
+        {
+            lua_geti(L, obj, i);
+            p4EncodeValue(w, &desc->value, uv, -1);
+            lua_pop(L, 1);
+        }
+    }
+    else
+    {
+        p4EncodeColumns(w, desc, uv, obj, count);
+    }
+}
+
+//protected part of encode, the shared buffer is released even if the obj is wrong.
+static int p4EncodeProtected(lua_State * L)
+{
+    P4Writer * w = (P4Writer *)lua_touserdata(L, 1);
+    P4Desc * desc = (P4Desc *)lua_touserdata(L, 2);
+    p4EncodeDesc(w, desc, 3, 4);
+    return 0;
+}
+
+//encode a protocol with the compiled schema, the result is the same as Proto4z.encode.
+//example: local bin = Proto4zUtil.encode(obj, "EchoPack")
+static int encode(lua_State * L)
+{
+    P4Writer w;
+    P4Desc * desc = NULL;
+    int ret = 0;
+    w.L = L;
+    lua_settop(L, 2);
+    desc = p4Check(L, 2, &w.forceTag);
+    w.buf = p4SharedBuffer(L);
+    w.buf->busy = 1;
+    lua_pushcfunction(L, p4EncodeProtected);
+    lua_pushlightuserdata(L, &w);
+    lua_pushlightuserdata(L, desc);
+    lua_pushvalue(L, 3);
+    lua_pushvalue(L, 1);
+    ret = lua_pcall(L, 4, 0, 0);
+    if (ret == LUA_OK)
+    {
+        lua_pushlstring(L, w.buf->data, w.buf->len);
+    }
+    p4ReleaseBuffer(w.buf);
+    if (ret != LUA_OK)
+    {
+        return lua_error(L);
+    }
+    return 1;
+}
+
+//encode into the memory of a proto4z.bytes or a light userdata at pos, the host buffer is written directly without a lua string.
+//len is the size of the memory, required by light userdata. return the next pos.
+//example: local nextPos = Proto4zUtil.encodeTo(obj, "EchoPack", buffer [, pos [, len]])
+static int encodeTo(lua_State * L)
+{
+    P4Writer w;
+    P4Buffer buf;
+    P4Desc * desc = NULL;
+    size_t len = 0;
+    size_t pos = 0;
+    char * data = NULL;
+    int ret = 0;
+    w.L = L;
+    data = p4CheckBytes(L, 3, 5, &len, 1);
+    pos = (size_t)luaL_optinteger(L, 4, 1);
+    if (pos < 1 || pos > len + 1)
+    {
+        return luaL_error(L, "encode error. pos=%d, len=%d", (int)pos, (int)len);
+    }
+    lua_settop(L, 2);
+    desc = p4Check(L, 2, &w.forceTag);
+    memset(&buf, 0, sizeof(buf));
+    buf.data = data + pos - 1;
+    buf.cap = len - (pos - 1);
+    buf.fixed = 1;
+    w.buf = &buf;
+    lua_pushcfunction(L, p4EncodeProtected);
+    lua_pushlightuserdata(L, &w);
+    lua_pushlightuserdata(L, desc);
+    lua_pushvalue(L, 3);
+    lua_pushvalue(L, 1);
+    ret = lua_pcall(L, 4, 0, 0);
+    if (ret != LUA_OK)
+    {
+        return lua_error(L);
+    }
+    lua_pushinteger(L, (lua_Integer)(pos + buf.len));
+    return 1;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//type code
+//the code of base type is resolved once by proto4z.lua, unpackCode and packCode switch on it without type string.
+//////////////////////////////////////////////////////////////////////////
+
+//example: local code = typeCode("ui32")
+static int typeCode(lua_State * L)
+{
+    int code = p4InnerCode(luaL_checkstring(L, 1));
+    if (code < 0)
+    {
+        return 0;
+    }
+    lua_pushinteger(L, code);
+    return 1;
+}
+
+static int p4CheckCode(lua_State * L, int index, int last)
+{
+    lua_Integer code = luaL_checkinteger(L, index);
+    luaL_argcheck(L, code >= 0 && code <= last, index, "invalid type code");
+    return (int)code;
+}
+
+static void p4CheckPos(lua_State * L, P4Reader * r, int index)
+{
+    lua_Integer pos = luaL_checkinteger(L, index);
+    if (pos < 1 || (size_t)pos > r->len + 1)
+    {
+        luaL_error(L, "unpack error. the current pos is invalid. cur pos=%d, blockSize=%d", (int)pos, (int)r->len);
+    }
+    r->pos = (size_t)pos - 1;
+}
+
+//same as unpack but the type is a code of typeCode.
+//example: local v, pos = unpackCode(block, pos, code)
+static int unpackCode(lua_State * L)
+{
+    P4Reader r;
+    P4Field f;
+    memset(&r, 0, sizeof(r));
+    memset(&f, 0, sizeof(f));
+    r.L = L;
+    r.data = luaL_checklstring(L, 1, &r.len);
+    p4CheckPos(L, &r, 2);
+    f.code = p4CheckCode(L, 3, P4_STRING);
+    p4DecodeValue(&r, &f, 0, 0);
+    lua_pushinteger(L, (lua_Integer)r.pos + 1);
+    return 2;
+}
+
+//unpack the key and the value of a map entry in one call.
+//example: local k, v, pos = unpackPair(block, pos, keyCode, valueCode)
+static int unpackPair(lua_State * L)
+{
+    P4Reader r;
+    P4Field key;
+    P4Field value;
+    memset(&r, 0, sizeof(r));
+    memset(&key, 0, sizeof(key));
+    memset(&value, 0, sizeof(value));
+    r.L = L;
+    r.data = luaL_checklstring(L, 1, &r.len);
+    p4CheckPos(L, &r, 2);
+    key.code = p4CheckCode(L, 3, P4_STRING);
+    value.code = p4CheckCode(L, 4, P4_STRING);
+    p4DecodeValue(&r, &key, 0, 0);
+    p4DecodeValue(&r, &value, 0, 0);
+    lua_pushinteger(L, (lua_Integer)r.pos + 1);
+    return 3;
+}
+
+//same as pack but the type is a code of typeCode, nil is packed as 0. the string is packed with the length.
+//example: local block = packCode(v, code)
+static int packCode(lua_State * L)
+{
+    P4Writer w;
+    P4Buffer buf;
+    char data[8];
+    int code = p4CheckCode(L, 2, P4_STRING);
+    if (lua_isnil(L, 1) && code != P4_STRING)
+    {
+        printPackError(L, p4CodeNames[code], luaL_optstring(L, 3, ""));
+    }
+    if (code == P4_STRING)
+    {
+        size_t len = 0;
+        const char * str = lua_isnil(L, 1) ? "" : luaL_checklstring(L, 1, &len);
+        unsigned int count = (unsigned int)len;
+        luaL_Buffer b;
+        luaL_buffinitsize(L, &b, len + 4);
+        luaL_addlstring(&b, (const char *)&count, 4);
+        luaL_addlstring(&b, str, len);
+        luaL_pushresult(&b);
+        return 1;
+    }
+    memset(&buf, 0, sizeof(buf));
+    buf.data = data;
+    buf.cap = sizeof(data);
+    buf.fixed = 1;
+    w.L = L;
+    w.buf = &buf;
+    w.forceTag = 0;
+    p4WriteNumber(&w, code, 1);
+    lua_pushlstring(L, buf.data, buf.len);
+    return 1;
+}
+
+
+//////////////////////////////////////////////////////////////////////////
+//profile
+//////////////////////////////////////////////////////////////////////////
+
+//the counters of one protocol, a full userdata in the stats table, [0] encode [1] decode.
+typedef struct P4Stat
+{
+    lua_Integer count[2];
+    lua_Integer bytes[2];
+    double total[2];
+    double max[2];
+} P4Stat;
+
+static int p4StatsKey = 0;
+static int p4ProfileKey = 0;
+
+//high resolution steady clock, millisecond.
+static double p4Clock(void)
+{
+#ifdef WIN32
+    LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&count);
+    return (double)count.QuadPart * 1000.0 / (double)freq.QuadPart;
+#elif defined(__APPLE__)
+    static mach_timebase_info_data_t timebase_info;
+    if (timebase_info.denom == 0)
+    {
+        mach_timebase_info(&timebase_info);
+    }
+    return (double)mach_absolute_time() * timebase_info.numer / timebase_info.denom / 1000000.0;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+#endif
+}
+
+//push the stats table.
+static int p4PushStats(lua_State * L)
+{
+    if (lua_rawgetp(L, LUA_REGISTRYINDEX, &p4StatsKey) != LUA_TTABLE)
+    {
+        lua_pop(L, 1);
+        lua_newtable(L);
+        lua_pushvalue(L, -1);
+        lua_rawsetp(L, LUA_REGISTRYINDEX, &p4StatsKey);
+    }
+    return lua_gettop(L);
+}
+
+static void p4Record(lua_State * L, int name, int kind, size_t bytes, double used)
+{
+    P4Stat * stat = NULL;
+    int stats = p4PushStats(L);
+    lua_pushvalue(L, name);
+    if (lua_rawget(L, stats) != LUA_TUSERDATA)
+    {
+        lua_pop(L, 1);
+        stat = (P4Stat *)lua_newuserdata(L, sizeof(P4Stat));
+        memset(stat, 0, sizeof(P4Stat));
+        lua_pushvalue(L, name);
+        lua_pushvalue(L, -2);
+        lua_rawset(L, stats);
+    }
+    stat = (P4Stat *)lua_touserdata(L, -1);
+    stat->count[kind]++;
+    stat->bytes[kind] += (lua_Integer)bytes;
+    stat->total[kind] += used;
+    if (used > stat->max[kind])
+    {
+        stat->max[kind] = used;
+    }
+    lua_pop(L, 2);
+}
+
+//the profiled encode or decode, upvalue 1 is the original function, upvalue 2 is the kind.
+//the bytes of encode is the result, the bytes of decode is the input.
+static int p4Profiled(lua_State * L)
+{
+    int kind = (int)lua_tointeger(L, lua_upvalueindex(2));
+    int args = lua_gettop(L);
+    size_t bytes = kind == 1 && lua_type(L, 1) == LUA_TSTRING ? lua_rawlen(L, 1) : 0;
+    double begin = 0;
+    luaL_checkstack(L, 2, "proto4z profile");
+    lua_pushvalue(L, 2);
+    lua_insert(L, 1);
+    lua_pushvalue(L, lua_upvalueindex(1));
+    lua_insert(L, 2);
+    begin = p4Clock();
+    lua_call(L, args, LUA_MULTRET);
+    begin = p4Clock() - begin;
+    if (kind == 0 && lua_type(L, 2) == LUA_TSTRING)
+    {
+        bytes = lua_rawlen(L, 2);
+    }
+    if (lua_type(L, 1) == LUA_TSTRING)
+    {
+        p4Record(L, 1, kind, bytes, begin);
+    }
+    return lua_gettop(L) - 1;
+}
+
+//switch the profile on or off, the profiled functions replace Proto4z.encode/decode and Proto4zUtil.encode/decode.
+//with the profile off the original functions are restored, no overhead is left.
+//example: profile(true)
+static int profile(lua_State * L)
+{
+    static const char * tables[] = { "Proto4z", "Proto4z", "Proto4zUtil", "Proto4zUtil" };
+    static const char * names[] = { "encode", "decode", "encode", "decode" };
+    int on = lua_toboolean(L, 1);
+    int i = 0;
+    lua_settop(L, 0);
+    if (lua_rawgetp(L, LUA_REGISTRYINDEX, &p4ProfileKey) == LUA_TTABLE)
+    {
+        //already on, restore the original functions first
+        for (i = 0; i < 4; i++)
+        {
+            if (lua_getglobal(L, tables[i]) == LUA_TTABLE)
+            {
+                lua_rawgeti(L, 1, i + 1);
+                lua_setfield(L, -2, names[i]);
+            }
+            lua_pop(L, 1);
+        }
+    }
+    lua_pushnil(L);
+    lua_rawsetp(L, LUA_REGISTRYINDEX, &p4ProfileKey);
+    if (!on)
+    {
+        return 0;
+    }
+    lua_newtable(L);
+    for (i = 0; i < 4; i++)
+    {
+        if (lua_getglobal(L, tables[i]) != LUA_TTABLE)
+        {
+            return luaL_error(L, "proto4z profile error. %s not found", tables[i]);
+        }
+        lua_getfield(L, -1, names[i]);
+        lua_pushvalue(L, -1);
+        lua_rawseti(L, 2, i + 1);
+        lua_pushinteger(L, i % 2);
+        lua_pushcclosure(L, p4Profiled, 2);
+        lua_setfield(L, -2, names[i]);
+        lua_pop(L, 1);
+    }
+    lua_rawsetp(L, LUA_REGISTRYINDEX, &p4ProfileKey);
+    return 0;
+}
+
+static void p4PushStat(lua_State * L, const P4Stat * stat, int kind)
+{
+    lua_createtable(L, 0, 4);
+    lua_pushinteger(L, stat->count[kind]);
+    lua_setfield(L, -2, "count");
+    lua_pushinteger(L, stat->bytes[kind]);
+    lua_setfield(L, -2, "bytes");
+    lua_pushnumber(L, stat->total[kind]);
+    lua_setfield(L, -2, "time");
+    lua_pushnumber(L, stat->max[kind]);
+    lua_setfield(L, -2, "maxTime");
+}
+
+//the counters by protocol name: {name = {encode = {count, bytes, time, maxTime}, decode = {...}}}, time is millisecond.
+//example: local stats = stats([reset])
+static int stats(lua_State * L)
+{
+    int reset = lua_toboolean(L, 1);
+    int statsIndex = 0;
+    lua_settop(L, 0);
+    statsIndex = p4PushStats(L);
+    lua_newtable(L);
+    lua_pushnil(L);
+    while (lua_next(L, statsIndex) != 0)
+    {
+        const P4Stat * stat = (const P4Stat *)lua_touserdata(L, -1);
+        lua_createtable(L, 0, 2);
+        if (stat->count[0] > 0)
+        {
+            p4PushStat(L, stat, 0);
+            lua_setfield(L, -2, "encode");
+        }
+        if (stat->count[1] > 0)
+        {
+            p4PushStat(L, stat, 1);
+            lua_setfield(L, -2, "decode");
+        }
+        lua_pushvalue(L, -3);
+        lua_insert(L, -2);
+        lua_rawset(L, -5);
+        lua_pop(L, 1);
+    }
+    if (reset)
+    {
+        lua_pushnil(L);
+        lua_rawsetp(L, LUA_REGISTRYINDEX, &p4StatsKey);
+    }
+    return 1;
+}
+
 static int steadyTime(lua_State * L)
 {
     unsigned int ret = 0;
@@ -456,6 +2316,67 @@ static luaL_Reg tagReg[] = {
     //example: local len , pos unpck(block, pos, "ui32")  
     { "unpack", unpack }, 
 
+    //把连续的bool和bits:N成员按位宽打包成一段位图, bool需要先转换成0和1.
+    //example: local block = packBits({1, 5, 0}, {1, 3, 1})
+    { "packBits", packBits },
+
+    //从二进制流中解出一段位图 返回每个成员的整数值和下一个元素开始的下标位置.
+    //example: local values, pos = unpackBits(block, pos, {1, 3, 1})
+    { "unpackBits", unpackBits },
+
+    //按注册的协议描述在C中解码整个协议, 结果和Proto4z.decode相同, 描述在第一次使用时编译并缓存.
+    //example: local result, nextPos = decode(block, "EchoPack", pos)
+    { "decode", decode },
+
+    //和decode相同, 但解码到已有的target中, 复用嵌套的表, 数组原地截断, 被替换的表放入表池.
+    //example: local target, nextPos = decodeInto(block, "EchoPack", target, pos)
+    { "decodeInto", decodeInto },
+
+    //从decodeInto的表池中取一个空表, 池空时新建.
+    //example: local t = newTable()
+    { "newTable", newTable },
+
+    //清空表和嵌套的表, 放入decodeInto的表池.
+    //example: recycle(t)
+    { "recycle", recycle },
+
+    //按注册的协议描述在C中编码整个协议, 写入复用的缓冲区, 最后只生成一个lua字符串, 结果和Proto4z.encode相同.
+    //example: local block = encode(obj, "EchoPack")
+    { "encode", encode },
+
+    //和encode相同, 但直接写入宿主的内存(light userdata加长度, 或proto4z.bytes), 不生成lua字符串, 返回下一个写入位置.
+    //decode和decodeInto同样接受userdata加长度作为输入.
+    //example: local nextPos = encodeTo(obj, "EchoPack", buffer, pos, len)
+    { "encodeTo", encodeTo },
+
+    //创建size字节的宿主内存(proto4z.bytes), data复制到开头. encodeTo/decode只接受这种full userdata, 其他full userdata会被拒绝.
+    //example: local buffer = newBytes(1024, data)
+    { "newBytes", newBytes },
+
+    //打开或关闭编解码统计, 打开时替换Proto4z和Proto4zUtil的encode/decode, 关闭时还原, 没有额外开销.
+    //example: profile(true)
+    { "profile", profile },
+
+    //按协议名返回encode/decode的次数, 字节数, 总耗时和最大耗时(毫秒), reset为true时清空计数.
+    //example: local stats = stats(reset)
+    { "stats", stats },
+
+    //基础类型和string的类型码, 非基础类型返回nil. proto4z.lua在第一次编解码协议时解析一次.
+    //example: local code = typeCode("ui32")
+    { "typeCode", typeCode },
+
+    //和unpack相同, 但类型是typeCode返回的类型码, 不再逐个比较类型字符串.
+    //example: local v, pos = unpackCode(block, pos, code)
+    { "unpackCode", unpackCode },
+
+    //一次解出map的key和value.
+    //example: local k, v, pos = unpackPair(block, pos, keyCode, valueCode)
+    { "unpackPair", unpackPair },
+
+    //和pack相同, 但类型是类型码, nil按0编码并和pack一样打印警告, string带长度前缀.
+    //example: local block = packCode(v, code, desc)
+    { "packCode", packCode },
+
     //获取一个稳定的tick计数 毫秒级. 
     //example: local nowTick = steadyTime()
     { "now", steadyTime }, 
@@ -466,6 +2387,8 @@ static luaL_Reg tagReg[] = {
 
 int luaopen_proto4z_util(lua_State *L)
 {
+    luaL_newmetatable(L, P4_BYTES_META);
+    lua_pop(L, 1);
     lua_newtable(L);
     luaL_Reg *l;
     for (l = tagReg; l->name != NULL; l++) 
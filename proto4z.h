@@ -58,6 +58,9 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <array>
 #include <set>
 #include <list>
 #include <queue>
@@ -66,6 +69,17 @@
 #include <sstream>
 #include <algorithm>
 #include <type_traits>
+#include <memory>
+#include <utility>
+#include <tuple>
+#include <initializer_list>
+#include <new>
+#include <cmath>
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#define PROTO4Z_HAS_CXX17 1
+#include <optional>
+#include <string_view>
+#endif
 #ifndef WIN32
 #include <stdexcept>
 #include <unistd.h>
@@ -107,6 +121,14 @@ do{\
     throw std::runtime_error(ss.str()); \
 } while (0)
 
+#ifdef WIN32
+#define PROTO4Z_NOINLINE __declspec(noinline)
+#elif defined(__GNUC__)
+#define PROTO4Z_NOINLINE __attribute__((noinline))
+#else
+#define PROTO4Z_NOINLINE
+#endif
+
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -123,6 +145,9 @@ typedef unsigned short ReserveInteger;
 typedef unsigned short ProtoInteger;
 //header end.
 
+//! no packet use it. 0 is a valid protoID, the generated name lookup return this when the name is not found.
+const static ProtoInteger InvalidProtoID = (ProtoInteger)-1;
+
 
 const static Integer MaxPackLen = (Integer)(-1) > 1024 * 1024 ? 1024 * 1024 : (Integer)-1;
 
@@ -320,6 +345,15 @@ private:
 //! stl container
 //////////////////////////////////////////////////////////////////////////
 
+//true when T is a generated packet with only fixed width members, see FixedWireSize.
+template<class T>
+struct IsFixedWire
+{
+    template<class U> static char check(decltype(U::FixedWireSize) *);
+    template<class U> static int check(...);
+    static const bool value = sizeof(check<T>(0)) == sizeof(char);
+};
+
 //write c-style string
 template<class T>
 inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const char *const data)
@@ -330,223 +364,2116 @@ inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const char *co
     return ws;
 }
 
-//write std::string
-template<class T, class _Traits, class _Alloc>
-inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::basic_string<char, _Traits, _Alloc> & data)
+//write std::string
+template<class T, class _Traits, class _Alloc>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::basic_string<char, _Traits, _Alloc> & data)
+{
+    Integer len = (Integer)data.length();
+    ws << len;
+    ws.appendOriginalData(data.c_str(), len);
+    return ws;
+}
+//read std::string
+template<class _Traits, class _Alloc>
+inline ReadStream & operator >> (ReadStream & rs, std::basic_string<char, _Traits, _Alloc> & data)
+{
+    Integer len = 0;
+    rs >> len;
+    data.assign(rs.peekOriginalData(len), len);
+    rs.skipOriginalData(len);
+    return rs;
+}
+
+
+//true when T has the same layout in memory and on the wire, a container of T is copied as one block.
+//bool is excluded, not every byte is a valid bool.
+template<class T>
+struct IsBulkWire
+{
+    static const bool value = std::is_arithmetic<T>::value && !std::is_same<T, bool>::value;
+};
+struct BulkWireTag {};
+
+//std::vector
+template<class T, class U, class _Alloc>
+inline void writeVector(WriteStreamImpl<T> & ws, const std::vector<U, _Alloc> & vct, std::false_type)
+{
+    for (typename std::vector<U, _Alloc>::const_iterator iter = vct.begin(); iter != vct.end(); ++iter)
+    {
+        ws << *iter;
+    }
+}
+
+template<class T, class U, class _Alloc>
+inline void writeVector(WriteStreamImpl<T> & ws, const std::vector<U, _Alloc> & vct, std::true_type)
+{
+    if (!vct.empty())
+    {
+        ws.appendOriginalData(vct.data(), (Integer)(vct.size() * sizeof(U)));
+    }
+}
+
+template<class T, class U, class _Alloc>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::vector<U, _Alloc> & vct)
+{
+    ws << (Integer)vct.size();
+    writeVector(ws, vct, std::integral_constant<bool, IsBulkWire<U>::value>());
+    return ws;
+}
+
+template<typename T, class _Alloc>
+inline void readVector(ReadStream & rs, std::vector<T, _Alloc> & vct, Integer totalCount, std::false_type)
+{
+    T t;
+    vct.clear();
+    vct.reserve(totalCount > 100 ? 100 : totalCount);
+    for (Integer i = 0; i < totalCount; ++i)
+    {
+        rs >> t;
+        vct.push_back(t);
+    }
+}
+
+//fixed wire packets: check the whole block once then decode in place.
+template<typename T, class _Alloc>
+inline void readVector(ReadStream & rs, std::vector<T, _Alloc> & vct, Integer totalCount, std::true_type)
+{
+    if (totalCount > MaxPackLen / T::FixedWireSize)
+    {
+        PROTO4Z_THROW("bound over. fixed array count too large. totalCount=" << totalCount << ", FixedWireSize=" << T::FixedWireSize);
+    }
+    const char * stream = rs.peekOriginalData(totalCount * T::FixedWireSize);
+    vct.resize(totalCount);
+    for (Integer i = 0; i < totalCount; ++i)
+    {
+        vct[i].fixedDecode(stream + i * T::FixedWireSize);
+    }
+    rs.skipOriginalData(totalCount * T::FixedWireSize);
+}
+
+//arithmetic elements: check the whole block once then copy.
+template<typename T, class _Alloc>
+inline void readVector(ReadStream & rs, std::vector<T, _Alloc> & vct, Integer totalCount, BulkWireTag)
+{
+    if (totalCount > rs.getStreamUnreadLen() / sizeof(T))
+    {
+        PROTO4Z_THROW("bound over. bulk array count too large. totalCount=" << totalCount << ", unread=" << rs.getStreamUnreadLen());
+    }
+    vct.resize(totalCount);
+    memcpy(vct.data(), rs.peekOriginalData((Integer)(totalCount * sizeof(T))), totalCount * sizeof(T));
+    rs.skipOriginalData((Integer)(totalCount * sizeof(T)));
+}
+
+template<typename T, class _Alloc>
+inline ReadStream & operator >> (ReadStream & rs, std::vector<T, _Alloc> & vct)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    if (totalCount > 0)
+    {
+        readVector(rs, vct, totalCount, typename std::conditional<IsBulkWire<T>::value, BulkWireTag,
+            std::integral_constant<bool, IsFixedWire<T>::value>>::type());
+    }
+    return rs;
+}
+
+//std::set
+template<class T, class Key, class _Pr, class _Alloc>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::set<Key, _Pr, _Alloc> & k)
+{
+    ws << (Integer)k.size();
+    for (typename std::set<Key, _Pr, _Alloc>::const_iterator iter = k.begin(); iter != k.end(); ++iter)
+    {
+        ws << *iter;
+    }
+    return ws;
+}
+
+template<class Key, class _Pr, class _Alloc>
+inline ReadStream & operator >> (ReadStream & rs, std::set<Key, _Pr, _Alloc> & k)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    Key t;
+    k.clear();
+    for (Integer i = 0; i < totalCount; ++i)
+    {
+        rs >> t;
+        k.insert(t);
+    }
+    return rs;
+}
+
+//std::multiset
+template<class T, class Key, class _Pr, class _Alloc>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::multiset<Key, _Pr, _Alloc> & k)
+{
+    ws << (Integer)k.size();
+    for (typename std::multiset<Key, _Pr, _Alloc>::const_iterator iter = k.begin(); iter != k.end(); ++iter)
+    {
+        ws << *iter;
+    }
+    return ws;
+}
+
+template<class Key, class _Pr, class _Alloc>
+inline ReadStream & operator >> (ReadStream & rs, std::multiset<Key, _Pr, _Alloc> & k)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    Key t;
+    k.clear();
+    for (Integer i = 0; i < totalCount; ++i)
+    {
+        rs >> t;
+        k.insert(t);
+    }
+    return rs;
+}
+
+//std::map
+template<class T, class Key, class Value, class _Pr, class _Alloc>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::map<Key, Value, _Pr, _Alloc> & kv)
+{
+    ws << (Integer)kv.size();
+    for (typename std::map<Key, Value, _Pr, _Alloc>::const_iterator iter = kv.begin(); iter != kv.end(); ++iter)
+    {
+        ws << iter->first;
+        ws << iter->second;
+    }
+    return ws;
+}
+
+template<class Key, class Value, class _Pr, class _Alloc>
+inline ReadStream & operator >> (ReadStream & rs, std::map<Key, Value, _Pr, _Alloc> & kv)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    std::pair<Key, Value> pr;
+    kv.clear();
+    for (Integer i = 0; i < totalCount; ++i)
+    {
+        rs >> pr.first;
+        rs >> pr.second;
+        kv.insert(pr);
+    }
+    return rs;
+}
+
+//std::unordered_map
+template<class T, class Key, class Value, class _Hash, class _Eq, class _Alloc>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::unordered_map<Key, Value, _Hash, _Eq, _Alloc> & kv)
+{
+    ws << (Integer)kv.size();
+    for (typename std::unordered_map<Key, Value, _Hash, _Eq, _Alloc>::const_iterator iter = kv.begin(); iter != kv.end(); ++iter)
+    {
+        ws << iter->first;
+        ws << iter->second;
+    }
+    return ws;
+}
+
+template<class Key, class Value, class _Hash, class _Eq, class _Alloc>
+inline ReadStream & operator >> (ReadStream & rs, std::unordered_map<Key, Value, _Hash, _Eq, _Alloc> & kv)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    std::pair<Key, Value> pr;
+    kv.clear();
+    //every entry has at least one byte, bound the bucket allocation by the stream.
+    kv.reserve(std::min(totalCount, rs.getStreamUnreadLen()));
+    for (Integer i = 0; i < totalCount; ++i)
+    {
+        rs >> pr.first;
+        rs >> pr.second;
+        kv.insert(pr);
+    }
+    return rs;
+}
+
+//std::unordered_multimap
+template<class T, class Key, class Value, class _Hash, class _Eq, class _Alloc>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::unordered_multimap<Key, Value, _Hash, _Eq, _Alloc> & kv)
+{
+    ws << (Integer)kv.size();
+    for (typename std::unordered_multimap<Key, Value, _Hash, _Eq, _Alloc>::const_iterator iter = kv.begin(); iter != kv.end(); ++iter)
+    {
+        ws << iter->first;
+        ws << iter->second;
+    }
+    return ws;
+}
+
+template<class Key, class Value, class _Hash, class _Eq, class _Alloc>
+inline ReadStream & operator >> (ReadStream & rs, std::unordered_multimap<Key, Value, _Hash, _Eq, _Alloc> & kv)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    std::pair<Key, Value> pr;
+    kv.clear();
+    kv.reserve(std::min(totalCount, rs.getStreamUnreadLen()));
+    for (Integer i = 0; i < totalCount; ++i)
+    {
+        rs >> pr.first;
+        rs >> pr.second;
+        kv.insert(pr);
+    }
+    return rs;
+}
+
+//std::unordered_set
+template<class T, class Key, class _Hash, class _Eq, class _Alloc>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::unordered_set<Key, _Hash, _Eq, _Alloc> & k)
+{
+    ws << (Integer)k.size();
+    for (typename std::unordered_set<Key, _Hash, _Eq, _Alloc>::const_iterator iter = k.begin(); iter != k.end(); ++iter)
+    {
+        ws << *iter;
+    }
+    return ws;
+}
+
+template<class Key, class _Hash, class _Eq, class _Alloc>
+inline ReadStream & operator >> (ReadStream & rs, std::unordered_set<Key, _Hash, _Eq, _Alloc> & k)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    Key t;
+    k.clear();
+    k.reserve(std::min(totalCount, rs.getStreamUnreadLen()));
+    for (Integer i = 0; i < totalCount; ++i)
+    {
+        rs >> t;
+        k.insert(t);
+    }
+    return rs;
+}
+
+//std::unordered_multiset
+template<class T, class Key, class _Hash, class _Eq, class _Alloc>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::unordered_multiset<Key, _Hash, _Eq, _Alloc> & k)
+{
+    ws << (Integer)k.size();
+    for (typename std::unordered_multiset<Key, _Hash, _Eq, _Alloc>::const_iterator iter = k.begin(); iter != k.end(); ++iter)
+    {
+        ws << *iter;
+    }
+    return ws;
+}
+
+template<class Key, class _Hash, class _Eq, class _Alloc>
+inline ReadStream & operator >> (ReadStream & rs, std::unordered_multiset<Key, _Hash, _Eq, _Alloc> & k)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    Key t;
+    k.clear();
+    k.reserve(std::min(totalCount, rs.getStreamUnreadLen()));
+    for (Integer i = 0; i < totalCount; ++i)
+    {
+        rs >> t;
+        k.insert(t);
+    }
+    return rs;
+}
+
+//std::multimap
+template<class T, class Key, class Value, class _Pr, class _Alloc>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::multimap<Key, Value, _Pr, _Alloc> & kv)
+{
+    ws << (Integer)kv.size();
+    for (typename std::multimap<Key, Value, _Pr, _Alloc>::const_iterator iter = kv.begin(); iter != kv.end(); ++iter)
+    {
+        ws << iter->first;
+        ws << iter->second;
+    }
+    return ws;
+}
+
+template<class Key, class Value, class _Pr, class _Alloc>
+inline ReadStream & operator >> (ReadStream & rs, std::multimap<Key, Value, _Pr, _Alloc> & kv)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    std::pair<Key, Value> pr;
+    kv.clear();
+    for (Integer i = 0; i < totalCount; ++i)
+    {
+        rs >> pr.first;
+        rs >> pr.second;
+        kv.insert(pr);
+    }
+    return rs;
+}
+
+
+//std::list
+template<class T, class Value, class _Alloc>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::list<Value, _Alloc> & l)
+{
+    ws << (Integer)l.size();
+    for (typename std::list<Value,_Alloc>::const_iterator iter = l.begin(); iter != l.end(); ++iter)
+    {
+        ws << *iter;
+    }
+    return ws;
+}
+
+template<class Value, class _Alloc>
+inline ReadStream & operator >> (ReadStream & rs, std::list<Value, _Alloc> & l)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    Value t;
+    l.clear();
+    for (Integer i = 0; i < totalCount; ++i)
+    {
+        rs >> t;
+        l.push_back(t);
+    }
+    return rs;
+}
+//std::deque
+template<class T, class Value, class _Alloc>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::deque<Value, _Alloc> & l)
+{
+    ws << (Integer)l.size();
+    for (typename std::deque<Value,_Alloc>::const_iterator iter = l.begin(); iter != l.end(); ++iter)
+    {
+        ws << *iter;
+    }
+    return ws;
+}
+
+template<class Value, class _Alloc>
+inline ReadStream & operator >> (ReadStream & rs, std::deque<Value, _Alloc> & l)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    Value t;
+    l.clear();
+    for (Integer i = 0; i < totalCount; ++i)
+    {
+        rs >> t;
+        l.push_back(t);
+    }
+    return rs;
+}
+
+//std::array, same wire format as std::vector, the count must be N.
+template<class T, class Value, size_t N>
+inline void writeArray(WriteStreamImpl<T> & ws, const std::array<Value, N> & arr, std::false_type)
+{
+    for (const auto & v : arr)
+    {
+        ws << v;
+    }
+}
+
+template<class T, class Value, size_t N>
+inline void writeArray(WriteStreamImpl<T> & ws, const std::array<Value, N> & arr, std::true_type)
+{
+    ws.appendOriginalData(arr.data(), (Integer)(N * sizeof(Value)));
+}
+
+template<class T, class Value, size_t N>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::array<Value, N> & arr)
+{
+    ws << (Integer)N;
+    writeArray(ws, arr, std::integral_constant<bool, IsBulkWire<Value>::value && (N > 0)>());
+    return ws;
+}
+
+template<class Value, size_t N>
+inline void readArray(ReadStream & rs, std::array<Value, N> & arr, std::false_type)
+{
+    for (auto & v : arr)
+    {
+        rs >> v;
+    }
+}
+
+template<class Value, size_t N>
+inline void readArray(ReadStream & rs, std::array<Value, N> & arr, std::true_type)
+{
+    memcpy(arr.data(), rs.peekOriginalData((Integer)(N * sizeof(Value))), N * sizeof(Value));
+    rs.skipOriginalData((Integer)(N * sizeof(Value)));
+}
+
+template<class Value, size_t N>
+inline ReadStream & operator >> (ReadStream & rs, std::array<Value, N> & arr)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    if (totalCount != N)
+    {
+        PROTO4Z_THROW("std::array count not match. totalCount=" << totalCount << ", N=" << N);
+    }
+    readArray(rs, arr, std::integral_constant<bool, IsBulkWire<Value>::value && (N > 0)>());
+    return rs;
+}
+
+//std::pair, first then second.
+template<class T, class First, class Second>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::pair<First, Second> & pr)
+{
+    ws << pr.first;
+    ws << pr.second;
+    return ws;
+}
+
+template<class First, class Second>
+inline ReadStream & operator >> (ReadStream & rs, std::pair<First, Second> & pr)
+{
+    rs >> pr.first;
+    rs >> pr.second;
+    return rs;
+}
+
+//std::tuple, element by element.
+template<size_t Index, size_t Count>
+struct TupleStream
+{
+    template<class Stream, class Tuple>
+    static inline void write(Stream & ws, const Tuple & tp)
+    {
+        ws << std::get<Index>(tp);
+        TupleStream<Index + 1, Count>::write(ws, tp);
+    }
+    template<class Tuple>
+    static inline void read(ReadStream & rs, Tuple & tp)
+    {
+        rs >> std::get<Index>(tp);
+        TupleStream<Index + 1, Count>::read(rs, tp);
+    }
+};
+
+template<size_t Count>
+struct TupleStream<Count, Count>
+{
+    template<class Stream, class Tuple>
+    static inline void write(Stream &, const Tuple &) {}
+    template<class Tuple>
+    static inline void read(ReadStream &, Tuple &) {}
+};
+
+template<class T, class ... Values>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::tuple<Values...> & tp)
+{
+    TupleStream<0, sizeof...(Values)>::write(ws, tp);
+    return ws;
+}
+
+template<class ... Values>
+inline ReadStream & operator >> (ReadStream & rs, std::tuple<Values...> & tp)
+{
+    TupleStream<0, sizeof...(Values)>::read(rs, tp);
+    return rs;
+}
+
+#ifdef PROTO4Z_HAS_CXX17
+//std::optional, ui8 presence then the value.
+template<class T, class Value>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::optional<Value> & opt)
+{
+    ws << (unsigned char)(opt.has_value() ? 1 : 0);
+    if (opt.has_value())
+    {
+        ws << *opt;
+    }
+    return ws;
+}
+
+template<class Value>
+inline ReadStream & operator >> (ReadStream & rs, std::optional<Value> & opt)
+{
+    unsigned char has = 0;
+    rs >> has;
+    if (has == 0)
+    {
+        opt.reset();
+        return rs;
+    }
+    rs >> opt.emplace();
+    return rs;
+}
+
+//std::string_view, same wire format as std::string.
+template<class T>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, std::string_view data)
+{
+    ws << (Integer)data.length();
+    ws.appendOriginalData(data.data(), (Integer)data.length());
+    return ws;
+}
+
+//! zero copy, the view points into the stream buffer and is valid while the buffer lives.
+inline ReadStream & operator >> (ReadStream & rs, std::string_view & data)
+{
+    Integer len = 0;
+    rs >> len;
+    data = std::string_view(rs.peekOriginalData(len), len);
+    rs.skipOriginalData(len);
+    return rs;
+}
+#endif
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//! fixed capacity container
+//////////////////////////////////////////////////////////////////////////
+
+//! inline string storage. same wire format as std::string, genProto use it for string member with maxlen.
+template<unsigned int Capacity>
+class FixedString
+{
+public:
+    FixedString() { _data[0] = '\0'; }
+    FixedString(const char * str) { assign(str, (Integer)strlen(str)); }
+    FixedString(const std::string & str) { assign(str.c_str(), (Integer)str.length()); }
+    FixedString & operator = (const char * str) { return assign(str, (Integer)strlen(str)); }
+    FixedString & operator = (const std::string & str) { return assign(str.c_str(), (Integer)str.length()); }
+    inline FixedString & assign(const char * str, Integer len)
+    {
+        if (len > Capacity)
+        {
+            PROTO4Z_THROW("FixedString over capacity. len=" << len << ", Capacity=" << Capacity);
+        }
+        memcpy(_data, str, len);
+        _data[len] = '\0';
+        _len = len;
+        return *this;
+    }
+    inline const char * c_str() const { return _data; }
+    inline const char * data() const { return _data; }
+    inline Integer length() const { return _len; }
+    inline Integer size() const { return _len; }
+    inline bool empty() const { return _len == 0; }
+    inline void clear() { _len = 0; _data[0] = '\0'; }
+    static inline Integer capacity() { return Capacity; }
+    inline operator std::string() const { return std::string(_data, _len); }
+    inline bool operator == (const FixedString & other) const { return _len == other._len && memcmp(_data, other._data, _len) == 0; }
+    inline bool operator != (const FixedString & other) const { return !(*this == other); }
+    inline bool operator < (const FixedString & other) const
+    {
+        int ret = memcmp(_data, other._data, std::min(_len, other._len));
+        return ret < 0 || (ret == 0 && _len < other._len);
+    }
+private:
+    Integer _len = 0;
+    char _data[Capacity + 1];
+};
+
+//! inline vector storage. same wire format as std::vector, genProto use it for array with capacity.
+template<class Value, unsigned int Capacity>
+class FixedVector
+{
+public:
+    typedef Value value_type;
+    typedef Value * iterator;
+    typedef const Value * const_iterator;
+    FixedVector() {}
+    FixedVector(const FixedVector & other) { for (const auto & v : other) push_back(v); }
+    FixedVector(FixedVector && other) noexcept(std::is_nothrow_move_constructible<Value>::value)
+    {
+        for (auto & v : other) new (end()) Value(std::move(v)), _size++;
+    }
+    FixedVector(std::initializer_list<Value> values) { for (const auto & v : values) push_back(v); }
+    ~FixedVector() { clear(); }
+    FixedVector & operator = (const FixedVector & other)
+    {
+        if (this != &other)
+        {
+            clear();
+            for (const auto & v : other) push_back(v);
+        }
+        return *this;
+    }
+    FixedVector & operator = (FixedVector && other) noexcept(std::is_nothrow_move_constructible<Value>::value)
+    {
+        if (this != &other)
+        {
+            clear();
+            for (auto & v : other) new (end()) Value(std::move(v)), _size++;
+        }
+        return *this;
+    }
+
+    template<class ... Args>
+    inline Value & emplace_back(Args && ... args)
+    {
+        if (_size >= Capacity)
+        {
+            PROTO4Z_THROW("FixedVector over capacity. Capacity=" << Capacity);
+        }
+        Value * v = new (end()) Value(std::forward<Args>(args)...);
+        _size++;
+        return *v;
+    }
+    inline void push_back(const Value & v) { emplace_back(v); }
+    inline void push_back(Value && v) { emplace_back(std::move(v)); }
+    inline void pop_back() { back().~Value(); _size--; }
+    inline void clear() { while (_size > 0) pop_back(); }
+    inline void resize(Integer n)
+    {
+        while (_size > n) pop_back();
+        while (_size < n) emplace_back();
+    }
+    inline Value * data() { return reinterpret_cast<Value*>(_storage); }
+    inline const Value * data() const { return reinterpret_cast<const Value*>(_storage); }
+    inline iterator begin() { return data(); }
+    inline iterator end() { return data() + _size; }
+    inline const_iterator begin() const { return data(); }
+    inline const_iterator end() const { return data() + _size; }
+    inline Value & operator[](Integer i) { return data()[i]; }
+    inline const Value & operator[](Integer i) const { return data()[i]; }
+    inline Value & front() { return data()[0]; }
+    inline const Value & front() const { return data()[0]; }
+    inline Value & back() { return data()[_size - 1]; }
+    inline const Value & back() const { return data()[_size - 1]; }
+    inline Integer size() const { return _size; }
+    inline bool empty() const { return _size == 0; }
+    static inline Integer capacity() { return Capacity; }
+private:
+    Integer _size = 0;
+    typename std::aligned_storage<sizeof(Value), alignof(Value)>::type _storage[Capacity];
+};
+
+template<class T, unsigned int Capacity>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const FixedString<Capacity> & data)
+{
+    ws << data.length();
+    ws.appendOriginalData(data.c_str(), data.length());
+    return ws;
+}
+
+//! over capacity length is rejected before any copy.
+template<unsigned int Capacity>
+inline ReadStream & operator >> (ReadStream & rs, FixedString<Capacity> & data)
+{
+    Integer len = 0;
+    rs >> len;
+    if (len > Capacity)
+    {
+        PROTO4Z_THROW("FixedString over capacity. len=" << len << ", Capacity=" << Capacity);
+    }
+    data.assign(rs.peekOriginalData(len), len);
+    rs.skipOriginalData(len);
+    return rs;
+}
+
+template<class T, class Value, unsigned int Capacity>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const FixedVector<Value, Capacity> & vct)
+{
+    ws << vct.size();
+    for (const auto & v : vct)
+    {
+        ws << v;
+    }
+    return ws;
+}
+
+template<class Value, unsigned int Capacity>
+inline ReadStream & operator >> (ReadStream & rs, FixedVector<Value, Capacity> & vct)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    if (totalCount > Capacity)
+    {
+        PROTO4Z_THROW("FixedVector over capacity. totalCount=" << totalCount << ", Capacity=" << Capacity);
+    }
+    vct.clear();
+    for (Integer i = 0; i < totalCount; ++i)
+    {
+        rs >> vct.emplace_back();
+    }
+    return rs;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//! flat map
+//////////////////////////////////////////////////////////////////////////
+
+//! sorted vector of pairs, same wire format as std::map. genProto use it for map with impl="flat".
+//! lookup is a binary search over contiguous memory, insert and erase move the tail.
+template<class Key, class Value, class Compare = std::less<Key>>
+class FlatMap
+{
+public:
+    typedef Key key_type;
+    typedef Value mapped_type;
+    typedef std::pair<Key, Value> value_type;
+    typedef typename std::vector<value_type>::iterator iterator;
+    typedef typename std::vector<value_type>::const_iterator const_iterator;
+    FlatMap() {}
+    FlatMap(std::initializer_list<value_type> values) { for (const auto & v : values) insert(v); }
+
+    inline iterator begin() { return _data.begin(); }
+    inline iterator end() { return _data.end(); }
+    inline const_iterator begin() const { return _data.begin(); }
+    inline const_iterator end() const { return _data.end(); }
+    inline Integer size() const { return (Integer)_data.size(); }
+    inline bool empty() const { return _data.empty(); }
+    inline void clear() { _data.clear(); }
+    inline void reserve(Integer n) { _data.reserve(n); }
+    inline Integer capacity() const { return (Integer)_data.capacity(); }
+
+    inline iterator lower_bound(const Key & key)
+    {
+        return std::lower_bound(_data.begin(), _data.end(), key, [](const value_type & v, const Key & k) { return Compare()(v.first, k); });
+    }
+    inline const_iterator lower_bound(const Key & key) const
+    {
+        return std::lower_bound(_data.begin(), _data.end(), key, [](const value_type & v, const Key & k) { return Compare()(v.first, k); });
+    }
+    inline iterator find(const Key & key)
+    {
+        iterator iter = lower_bound(key);
+        return iter != end() && !Compare()(key, iter->first) ? iter : end();
+    }
+    inline const_iterator find(const Key & key) const
+    {
+        const_iterator iter = lower_bound(key);
+        return iter != end() && !Compare()(key, iter->first) ? iter : end();
+    }
+    inline Integer count(const Key & key) const { return find(key) != end() ? 1 : 0; }
+    inline Value & at(const Key & key)
+    {
+        iterator iter = find(key);
+        if (iter == end())
+        {
+            PROTO4Z_THROW("FlatMap key not found.");
+        }
+        return iter->second;
+    }
+    inline const Value & at(const Key & key) const
+    {
+        const_iterator iter = find(key);
+        if (iter == end())
+        {
+            PROTO4Z_THROW("FlatMap key not found.");
+        }
+        return iter->second;
+    }
+    inline Value & operator[](const Key & key) { return emplace(key, Value()).first->second; }
+
+    inline std::pair<iterator, bool> insert(value_type v)
+    {
+        iterator iter = lower_bound(v.first);
+        if (iter != end() && !Compare()(v.first, iter->first))
+        {
+            return std::make_pair(iter, false);
+        }
+        return std::make_pair(_data.insert(iter, std::move(v)), true);
+    }
+    template<class ... Args>
+    inline std::pair<iterator, bool> emplace(Args && ... args) { return insert(value_type(std::forward<Args>(args)...)); }
+    inline iterator erase(const_iterator iter) { return _data.erase(iter); }
+    inline Integer erase(const Key & key)
+    {
+        iterator iter = find(key);
+        if (iter == end())
+        {
+            return 0;
+        }
+        _data.erase(iter);
+        return 1;
+    }
+    inline bool operator == (const FlatMap & other) const { return _data == other._data; }
+    inline bool operator != (const FlatMap & other) const { return _data != other._data; }
+
+    //! append without order check, call sortUnique after the last append.
+    inline value_type & appendUnsorted() { _data.emplace_back(); return _data.back(); }
+    //! sort by key and keep the first one of the same key, same as std::map insert.
+    inline void sortUnique()
+    {
+        std::stable_sort(_data.begin(), _data.end(), [](const value_type & a, const value_type & b) { return Compare()(a.first, b.first); });
+        _data.erase(std::unique(_data.begin(), _data.end(), [](const value_type & a, const value_type & b) { return !Compare()(a.first, b.first); }), _data.end());
+    }
+    inline bool isSorted() const
+    {
+        for (size_t i = 1; i < _data.size(); i++)
+        {
+            if (!Compare()(_data[i - 1].first, _data[i].first))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+private:
+    std::vector<value_type> _data;
+};
+
+template<class T, class Key, class Value, class Compare>
+inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const FlatMap<Key, Value, Compare> & kv)
+{
+    ws << kv.size();
+    for (const auto & v : kv)
+    {
+        ws << v.first;
+        ws << v.second;
+    }
+    return ws;
+}
+
+//! the writer of std::map and FlatMap encode in key order, so decode is one allocation and append only.
+//! unsorted input from other writer is sorted once at the end.
+template<class Key, class Value, class Compare>
+inline ReadStream & operator >> (ReadStream & rs, FlatMap<Key, Value, Compare> & kv)
+{
+    Integer totalCount = 0;
+    rs >> totalCount;
+    if (totalCount > rs.getStreamUnreadLen())
+    {
+        PROTO4Z_THROW("FlatMap count over stream. totalCount=" << totalCount << ", unread=" << rs.getStreamUnreadLen());
+    }
+    kv.clear();
+    kv.reserve(totalCount);
+    try
+    {
+        for (Integer i = 0; i < totalCount; ++i)
+        {
+            auto & v = kv.appendUnsorted();
+            rs >> v.first;
+            rs >> v.second;
+        }
+    }
+    catch (...)
+    {
+        kv.clear(); //never leave a half unsorted map
+        throw;
+    }
+    if (!kv.isSorted())
+    {
+        kv.sortUnique();
+    }
+    return rs;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//! memory usage
+//////////////////////////////////////////////////////////////////////////
+
+//! heap bytes owned by a value, sizeof the value itself is not included.
+//! node based containers are estimated with the usual node layout of the std library.
+const static size_t TreeNodeOverhead = 4 * sizeof(void*);
+const static size_t ListNodeOverhead = 2 * sizeof(void*);
+const static size_t HashNodeOverhead = sizeof(void*) + sizeof(size_t);
+
+//declare all first, the nested container calls are resolved at the definition.
+template<class T>
+inline typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value, size_t>::type heapUsage(const T &);
+template<class T>
+inline auto heapUsage(const T & t) -> decltype(t.memoryUsage(), size_t());
+template<class _Traits, class _Alloc>
+inline size_t heapUsage(const std::basic_string<char, _Traits, _Alloc> & str);
+template<unsigned int Capacity>
+inline size_t heapUsage(const FixedString<Capacity> &);
+template<class T, class _Alloc>
+inline size_t heapUsage(const std::vector<T, _Alloc> & vct);
+template<class T, unsigned int Capacity>
+inline size_t heapUsage(const FixedVector<T, Capacity> & vct);
+template<class T, class _Alloc>
+inline size_t heapUsage(const std::list<T, _Alloc> & l);
+template<class T, class _Alloc>
+inline size_t heapUsage(const std::deque<T, _Alloc> & l);
+template<class Key, class _Pr, class _Alloc>
+inline size_t heapUsage(const std::set<Key, _Pr, _Alloc> & k);
+template<class Key, class Value, class _Pr, class _Alloc>
+inline size_t heapUsage(const std::map<Key, Value, _Pr, _Alloc> & kv);
+template<class Key, class Value, class _Hash, class _Eq, class _Alloc>
+inline size_t heapUsage(const std::unordered_map<Key, Value, _Hash, _Eq, _Alloc> & kv);
+template<class Key, class Value, class Compare>
+inline size_t heapUsage(const FlatMap<Key, Value, Compare> & kv);
+template<class First, class Second>
+inline size_t heapUsage(const std::pair<First, Second> & pr);
+template<class T, size_t N>
+inline size_t heapUsage(const std::array<T, N> & arr);
+
+template<class Iter>
+inline size_t heapUsageRange(Iter begin, Iter end)
+{
+    size_t bytes = 0;
+    for (; begin != end; ++begin)
+    {
+        bytes += heapUsage(*begin);
+    }
+    return bytes;
+}
+
+template<class T>
+inline typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value, size_t>::type heapUsage(const T &)
+{
+    return 0;
+}
+
+//generated packet
+template<class T>
+inline auto heapUsage(const T & t) -> decltype(t.memoryUsage(), size_t())
+{
+    return t.memoryUsage() - sizeof(T);
+}
+
+//short string is stored inside the object.
+template<class _Traits, class _Alloc>
+inline size_t heapUsage(const std::basic_string<char, _Traits, _Alloc> & str)
+{
+    const char * begin = (const char *)&str;
+    if (str.data() >= begin && str.data() < begin + sizeof(str))
+    {
+        return 0;
+    }
+    return str.capacity() + 1;
+}
+
+template<unsigned int Capacity>
+inline size_t heapUsage(const FixedString<Capacity> &)
+{
+    return 0;
+}
+
+template<class T, class _Alloc>
+inline size_t heapUsage(const std::vector<T, _Alloc> & vct)
+{
+    return vct.capacity() * sizeof(T) + heapUsageRange(vct.begin(), vct.end());
+}
+
+template<class T, unsigned int Capacity>
+inline size_t heapUsage(const FixedVector<T, Capacity> & vct)
+{
+    return heapUsageRange(vct.begin(), vct.end());
+}
+
+template<class T, class _Alloc>
+inline size_t heapUsage(const std::list<T, _Alloc> & l)
+{
+    return l.size() * (sizeof(T) + ListNodeOverhead) + heapUsageRange(l.begin(), l.end());
+}
+
+template<class T, class _Alloc>
+inline size_t heapUsage(const std::deque<T, _Alloc> & l)
+{
+    return l.size() * sizeof(T) + heapUsageRange(l.begin(), l.end());
+}
+
+template<class Key, class _Pr, class _Alloc>
+inline size_t heapUsage(const std::set<Key, _Pr, _Alloc> & k)
+{
+    return k.size() * (sizeof(Key) + TreeNodeOverhead) + heapUsageRange(k.begin(), k.end());
+}
+
+template<class Key, class Value, class _Pr, class _Alloc>
+inline size_t heapUsage(const std::map<Key, Value, _Pr, _Alloc> & kv)
+{
+    return kv.size() * (sizeof(std::pair<const Key, Value>) + TreeNodeOverhead) + heapUsageRange(kv.begin(), kv.end());
+}
+
+template<class Key, class Value, class _Hash, class _Eq, class _Alloc>
+inline size_t heapUsage(const std::unordered_map<Key, Value, _Hash, _Eq, _Alloc> & kv)
+{
+    return kv.bucket_count() * sizeof(void*) + kv.size() * (sizeof(std::pair<const Key, Value>) + HashNodeOverhead)
+        + heapUsageRange(kv.begin(), kv.end());
+}
+
+template<class Key, class Value, class Compare>
+inline size_t heapUsage(const FlatMap<Key, Value, Compare> & kv)
+{
+    return kv.capacity() * sizeof(std::pair<Key, Value>) + heapUsageRange(kv.begin(), kv.end());
+}
+
+template<class First, class Second>
+inline size_t heapUsage(const std::pair<First, Second> & pr)
+{
+    return heapUsage(pr.first) + heapUsage(pr.second);
+}
+
+template<class T, size_t N>
+inline size_t heapUsage(const std::array<T, N> & arr)
+{
+    return heapUsageRange(arr.begin(), arr.end());
+}
+
+//! least recently used cache bounded by bytes. Value is a generated packet, or any type with memoryUsage().
+//! the usage is taken at put, put the value again after it grows. the newest value is kept even if it is over the budget.
+template<class Key, class Value>
+class MemoryBudgetCache
+{
+public:
+    explicit MemoryBudgetCache(size_t budget) : _budget(budget) {}
+    inline void put(const Key & key, Value value)
+    {
+        erase(key);
+        size_t usage = entryUsage(key, value);
+        _lru.emplace_front(key, std::move(value), usage);
+        _index[key] = _lru.begin();
+        _usedBytes += usage;
+        while (_usedBytes > _budget && _lru.size() > 1)
+        {
+            evict();
+        }
+    }
+    //! nullptr if not found, the pointer is valid until the next put or erase.
+    inline const Value * get(const Key & key)
+    {
+        auto founder = _index.find(key);
+        if (founder == _index.end())
+        {
+            return nullptr;
+        }
+        _lru.splice(_lru.begin(), _lru, founder->second);
+        return &std::get<1>(*founder->second);
+    }
+    inline bool erase(const Key & key)
+    {
+        auto founder = _index.find(key);
+        if (founder == _index.end())
+        {
+            return false;
+        }
+        _usedBytes -= std::get<2>(*founder->second);
+        _lru.erase(founder->second);
+        _index.erase(founder);
+        return true;
+    }
+    inline void setBudget(size_t budget)
+    {
+        _budget = budget;
+        while (_usedBytes > _budget && !_lru.empty())
+        {
+            evict();
+        }
+    }
+    inline size_t usedBytes() const { return _usedBytes; }
+    inline size_t budget() const { return _budget; }
+    inline size_t size() const { return _lru.size(); }
+    inline size_t evictCount() const { return _evictCount; }
+    //! the bytes charged for one entry: the value, the list node and the index node which both keep a copy of the key,
+    //! and one bucket pointer of the index at load factor 1.
+    static inline size_t entryUsage(const Key & key, const Value & value)
+    {
+        return value.memoryUsage() - sizeof(Value) + sizeof(typename LRUList::value_type) + ListNodeOverhead
+            + sizeof(typename IndexMap::value_type) + HashNodeOverhead + sizeof(void*) + 2 * heapUsage(key);
+    }
+private:
+    inline void evict()
+    {
+        _usedBytes -= std::get<2>(_lru.back());
+        _index.erase(std::get<0>(_lru.back()));
+        _lru.pop_back();
+        _evictCount++;
+    }
+private:
+    typedef std::list<std::tuple<Key, Value, size_t>> LRUList;
+    typedef std::unordered_map<Key, typename LRUList::iterator> IndexMap;
+    LRUList _lru;
+    IndexMap _index;
+    size_t _budget = 0;
+    size_t _usedBytes = 0;
+    size_t _evictCount = 0;
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//! bit packed member
+//////////////////////////////////////////////////////////////////////////
+
+// consecutive bool and bits:N members share one bitmap, bit pos is counted from the lowest bit of the first byte.
+// a field is moved with one shift and mask per touched byte.
+inline void packBits(char * bits, Integer pos, unsigned long long value, Integer count)
+{
+    while (count > 0)
+    {
+        Integer shift = pos & 7;
+        Integer take = 8 - shift < count ? 8 - shift : count;
+        unsigned char mask = (unsigned char)((1U << take) - 1);
+        bits[pos >> 3] |= (char)((unsigned char)(value & mask) << shift);
+        value >>= take;
+        pos += take;
+        count -= take;
+    }
+}
+
+inline unsigned long long unpackBits(const char * bits, Integer pos, Integer count)
+{
+    unsigned long long value = 0;
+    Integer got = 0;
+    while (got < count)
+    {
+        Integer shift = pos & 7;
+        Integer take = 8 - shift < count - got ? 8 - shift : count - got;
+        unsigned char mask = (unsigned char)((1U << take) - 1);
+        value |= (unsigned long long)(((unsigned char)bits[pos >> 3] >> shift) & mask) << got;
+        pos += take;
+        got += take;
+    }
+    return value;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//! reflection
+//////////////////////////////////////////////////////////////////////////
+
+//member tag bits, same order as the xml member tag attribute.
+enum ProtoMemberTag
+{
+    PMT_DB_KEY = 1 << 0,
+    PMT_DB_UNI = 1 << 1,
+    PMT_DB_IDX = 1 << 2,
+    PMT_DB_AUTO = 1 << 3,
+    PMT_DB_IGNORE = 1 << 4,
+    PMT_DB_BLOB = 1 << 5,
+};
+
+//! compile time description of one generated member.
+//! generated packet call visitor(ProtoMember) for each member in forEachMember.
+template<class Class, class Member>
+struct ProtoMember
+{
+    typedef Class ClassType;
+    typedef Member MemberType;
+    const char * name; //member name
+    const char * type; //xml type
+    short tag; //ProtoMemberTag bits
+    Member Class::* ptr;
+
+    inline const Member & get(const Class & data) const { return data.*ptr; }
+    inline Member & get(Class & data) const { return data.*ptr; }
+    inline bool hasTag(short t) const { return (tag & t) != 0; }
+};
+
+template<class Class, class Member>
+constexpr ProtoMember<Class, Member> makeProtoMember(const char * name, const char * type, short tag, Member Class::* ptr)
+{
+    return ProtoMember<Class, Member>{ name, type, tag, ptr };
+}
+
+//generic codec written once for all generated packets.
+template<class Stream, class Packet>
+struct ReflectWriter
+{
+    Stream & ws;
+    const Packet & data;
+    template<class M>
+    inline void operator()(const M & m) const { ws << m.get(data); }
+};
+
+template<class Packet>
+struct ReflectReader
+{
+    ReadStream & rs;
+    Packet & data;
+    template<class M>
+    inline void operator()(const M & m) const { rs >> m.get(data); }
+};
+
+//tagged and bit packed packets define MemberWise = false, their wire is not member by member.
+template<class T>
+struct IsMemberWise
+{
+    template<class U> static std::integral_constant<bool, U::MemberWise> check(decltype(U::MemberWise) *);
+    template<class U> static std::true_type check(...);
+    static const bool value = decltype(check<T>(0))::value;
+};
+
+template<class Stream, class Packet>
+inline Stream & reflectWrite(Stream & ws, const Packet & data)
+{
+    static_assert(IsMemberWise<Packet>::value, "reflectWrite not support tagged or bit packed packet.");
+    Packet::forEachMember(ReflectWriter<Stream, Packet>{ ws, data });
+    return ws;
+}
+
+template<class Packet>
+inline ReadStream & reflectRead(ReadStream & rs, Packet & data)
+{
+    static_assert(IsMemberWise<Packet>::value, "reflectRead not support tagged or bit packed packet.");
+    Packet::forEachMember(ReflectReader<Packet>{ rs, data });
+    return rs;
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//! object pool
+//////////////////////////////////////////////////////////////////////////
+
+//! generated reset() call it for each member. base type to zero, container clear and keep the capacity.
+template<class T>
+inline typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value>::type resetMember(T & t)
+{
+    t = T();
+}
+
+template<class T>
+inline auto resetMember(T & t) -> decltype(t.reset(), void())
+{
+    t.reset();
+}
+
+template<class T>
+inline auto resetMember(T & t) -> decltype(t.clear(), void())
+{
+    t.clear();
+}
+
+//! per type and per thread free list of generated packets. the object is reset when it come back,
+//! so acquire always return a clean packet which keep the container capacity of the last use.
+template<class Packet>
+class ProtoPool
+{
+public:
+    //! a handle may outlive the pool of the releasing thread, e.g. a static or thread_local handle destroyed after the pool,
+    //! then the packet is deleted directly.
+    struct Recycler
+    {
+        inline void operator()(Packet * packet) const
+        {
+            if (ProtoPool::destroyed())
+            {
+                delete packet;
+                return;
+            }
+            ProtoPool::instance().release(packet);
+        }
+    };
+    typedef std::unique_ptr<Packet, Recycler> Handle;
+
+    //! must not be called by this thread after the pool destroyed.
+    static inline ProtoPool & instance()
+    {
+        thread_local ProtoPool pool;
+        return pool;
+    }
+    //! trivial thread_local, no destructor, still readable while the thread exit.
+    static inline bool & destroyed()
+    {
+        thread_local bool flag = false;
+        return flag;
+    }
+    inline Handle acquire()
+    {
+        if (_free.empty())
+        {
+            _createCount++;
+            return Handle(new Packet());
+        }
+        Packet * packet = _free.back();
+        _free.pop_back();
+        return Handle(packet);
+    }
+    //! the object released by other thread is kept by that thread's pool.
+    inline void release(Packet * packet)
+    {
+        if (_free.size() >= _maxFree)
+        {
+            delete packet;
+            return;
+        }
+        packet->reset();
+        _free.push_back(packet);
+    }
+    inline void setMaxFree(size_t maxFree) { _maxFree = maxFree; shrink(); }
+    inline size_t freeCount() const { return _free.size(); }
+    inline size_t createCount() const { return _createCount; }
+    ~ProtoPool() { destroyed() = true; _maxFree = 0; shrink(); }
+private:
+    ProtoPool() {}
+    ProtoPool(const ProtoPool &) = delete;
+    ProtoPool & operator = (const ProtoPool &) = delete;
+    inline void shrink()
+    {
+        while (_free.size() > _maxFree)
+        {
+            delete _free.back();
+            _free.pop_back();
+        }
+    }
+private:
+    std::vector<Packet*> _free;
+    size_t _maxFree = 64;
+    size_t _createCount = 0;
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//! dispatch
+//////////////////////////////////////////////////////////////////////////
+
+//! the name hash used by generated perfect hash tables. genProto choose the seed.
+//! fnv-1a over the name, then the seed is mixed by a final avalanche so every seed bit reach the low bits used as slot index.
+inline unsigned int protoNameHash(const char * name, size_t len, unsigned int seed)
+{
+    unsigned int h = 2166136261U;
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= (unsigned char)name[i];
+        h *= 16777619U;
+    }
+    h ^= seed;
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+//! dense dispatch table indexed by protoID - MinProtoID. genProto typedef it for each xml file.
+//! dispatch is one bound check and one indirect call to the invoker which decode the registered packet type.
+template<ProtoInteger MinProtoID, ProtoInteger TableSize>
+class ProtoDispatcher
+{
+public:
+    typedef bool(*Invoker)(ReadStream & rs, void * handler);
+    ProtoDispatcher()
+    {
+        for (ProtoInteger i = 0; i < TableSize; i++)
+        {
+            _entries[i].invoker = &unhandled;
+            _entries[i].handler = nullptr;
+        }
+    }
+
+    //! handler: callable as handler(Packet &)
+    template<class Packet, class Handler>
+    inline void registerHandler(Handler handler)
+    {
+        ProtoInteger pos = (ProtoInteger)(Packet::getProtoID() - MinProtoID);
+        if (pos >= TableSize)
+        {
+            PROTO4Z_THROW("registerHandler protoID out of dispatch table. protoID=" << Packet::getProtoID() << ", MinProtoID=" << MinProtoID << ", TableSize=" << TableSize);
+        }
+        std::shared_ptr<Handler> holder = std::make_shared<Handler>(std::move(handler));
+        _holders[pos] = holder;
+        _entries[pos].handler = holder.get();
+        _entries[pos].invoker = &invoke<Packet, Handler>;
+    }
+
+    //! same as registerHandler, the packet is taken from ProtoPool and recycled after the handler return.
+    template<class Packet, class Handler>
+    inline void registerPooledHandler(Handler handler)
+    {
+        registerHandler<Packet>(std::move(handler));
+        _entries[(ProtoInteger)(Packet::getProtoID() - MinProtoID)].invoker = &invokePooled<Packet, Handler>;
+    }
+
+    inline void unregisterHandler(ProtoInteger protoID)
+    {
+        ProtoInteger pos = (ProtoInteger)(protoID - MinProtoID);
+        if (pos < TableSize)
+        {
+            _entries[pos].invoker = &unhandled;
+            _entries[pos].handler = nullptr;
+            _holders[pos].reset();
+        }
+    }
+
+    //! return false when the protoID has no handler.
+    inline bool dispatch(ReadStream & rs)
+    {
+        ProtoInteger pos = (ProtoInteger)(rs.getProtoID() - MinProtoID);
+        if (pos >= TableSize)
+        {
+            return false;
+        }
+        return _entries[pos].invoker(rs, _entries[pos].handler);
+    }
+private:
+    static bool unhandled(ReadStream &, void *)
+    {
+        return false;
+    }
+    template<class Packet, class Handler>
+    static bool invoke(ReadStream & rs, void * handler)
+    {
+        Packet packet;
+        rs >> packet;
+        (*static_cast<Handler*>(handler))(packet);
+        return true;
+    }
+    template<class Packet, class Handler>
+    static bool invokePooled(ReadStream & rs, void * handler)
+    {
+        typename ProtoPool<Packet>::Handle packet = ProtoPool<Packet>::instance().acquire();
+        rs >> *packet;
+        (*static_cast<Handler*>(handler))(*packet);
+        return true;
+    }
+private:
+    struct Entry
+    {
+        Invoker invoker;
+        void * handler;
+    };
+    Entry _entries[TableSize];
+    std::shared_ptr<void> _holders[TableSize];
+};
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//! tagged packet
+//////////////////////////////////////////////////////////////////////////
+
+// Memory layout, same as proto4z.lua with tag.
+//|--offset--|--tag--|--members which tag bit is set--|
+// offset: the length after offset field. decoder skip to it, so the members appended by newer schema are ignored.
+// tag: bit n-1 is set when member n present.
+typedef unsigned long long ProtoTag;
+
+template<class Stream>
+inline Integer beginTaggedWrite(Stream & ws, ProtoTag tag)
+{
+    Integer pos = ws.getStreamLen();
+    ws << (Integer)0;
+    ws << tag;
+    return pos;
+}
+
+template<class Stream>
+inline void endTaggedWrite(Stream & ws, Integer pos)
+{
+    ws.fixOriginalData(pos, (Integer)(ws.getStreamLen() - pos - sizeof(Integer)));
+}
+
+//! return the unread length at the end of this packet.
+inline Integer beginTaggedRead(ReadStream & rs, ProtoTag & tag)
+{
+    Integer offset = 0;
+    rs >> offset;
+    if (offset < sizeof(ProtoTag) || offset > rs.getStreamUnreadLen())
+    {
+        PROTO4Z_THROW("beginTaggedRead offset invalid. offset=" << offset << ", unread=" << rs.getStreamUnreadLen());
+    }
+    Integer tail = rs.getStreamUnreadLen() - offset;
+    rs >> tag;
+    return tail;
+}
+
+inline void endTaggedRead(ReadStream & rs, Integer tail)
+{
+    if (rs.getStreamUnreadLen() < tail)
+    {
+        PROTO4Z_THROW("endTaggedRead members over offset. unread=" << rs.getStreamUnreadLen() << ", tail=" << tail);
+    }
+    rs.skipOriginalData(rs.getStreamUnreadLen() - tail);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////
+//! columnar array
+//////////////////////////////////////////////////////////////////////////
+
+// Memory layout
+//|--count--|--column of member 1--|--column of member 2--| ...
+// base type column: count values packed contiguous.
+// string column: count ui32 lengths then all the bytes.
+// columnar is a wire size feature: similar values sit together and compress better.
+// in memory the array is still rows, decode check and skip every column first then fill the rows in one pass,
+// so each row is written once and the decode cost is close to the row layout.
+const static Integer ColumnChunkSize = 1024;
+
+template<class Stream, class Packet, class Member>
+inline typename std::enable_if<std::is_arithmetic<Member>::value>::type
+writeColumn(Stream & ws, const std::vector<Packet> & data, Member Packet::* ptr)
+{
+    //gather by chunk, no heap memory.
+    char chunk[ColumnChunkSize * sizeof(Member)];
+    size_t count = data.size();
+    for (size_t begin = 0; begin < count; begin += ColumnChunkSize)
+    {
+        size_t end = std::min(count, begin + ColumnChunkSize);
+        for (size_t i = begin; i < end; i++)
+        {
+            memcpy(chunk + (i - begin) * sizeof(Member), &(data[i].*ptr), sizeof(Member));
+        }
+        ws.appendOriginalData(chunk, (Integer)((end - begin) * sizeof(Member)));
+    }
+}
+
+template<class Stream, class Packet>
+inline void writeColumn(Stream & ws, const std::vector<Packet> & data, std::string Packet::* ptr)
+{
+    char chunk[ColumnChunkSize * sizeof(Integer)];
+    size_t count = data.size();
+    for (size_t begin = 0; begin < count; begin += ColumnChunkSize)
+    {
+        size_t end = std::min(count, begin + ColumnChunkSize);
+        for (size_t i = begin; i < end; i++)
+        {
+            Integer len = (Integer)(data[i].*ptr).length();
+            memcpy(chunk + (i - begin) * sizeof(Integer), &len, sizeof(Integer));
+        }
+        ws.appendOriginalData(chunk, (Integer)((end - begin) * sizeof(Integer)));
+    }
+    for (size_t i = 0; i < count; i++)
+    {
+        const std::string & str = data[i].*ptr;
+        if (!str.empty())
+        {
+            ws.appendOriginalData(str.c_str(), (Integer)str.length());
+        }
+    }
+}
+
+//! cursor of one column inside the stream, scatterColumns copy it to the rows.
+template<class Packet, class Member>
+struct ColumnCursor
+{
+    Member Packet::* _ptr;
+    const char * _column;
+    inline void read(Packet & row, size_t i) { memcpy(&(row.*_ptr), _column + i * sizeof(Member), sizeof(Member)); }
+};
+
+template<class Packet>
+struct ColumnCursor<Packet, std::string>
+{
+    std::string Packet::* _ptr;
+    const char * _lens;
+    const char * _bytes;
+    inline void read(Packet & row, size_t i)
+    {
+        Integer len = 0;
+        memcpy(&len, _lens + i * sizeof(Integer), sizeof(Integer));
+        (row.*_ptr).assign(_bytes, len);
+        _bytes += len;
+    }
+};
+
+//! check and skip one column, data must be resized to the column count.
+template<class Packet, class Member>
+inline typename std::enable_if<std::is_arithmetic<Member>::value, ColumnCursor<Packet, Member>>::type
+peekColumn(ReadStream & rs, const std::vector<Packet> & data, Member Packet::* ptr)
+{
+    ColumnCursor<Packet, Member> cursor = { ptr, "" };
+    if (!data.empty())
+    {
+        Integer len = (Integer)(data.size() * sizeof(Member));
+        cursor._column = rs.peekOriginalData(len);
+        rs.skipOriginalData(len);
+    }
+    return cursor;
+}
+
+template<class Packet>
+inline ColumnCursor<Packet, std::string> peekColumn(ReadStream & rs, const std::vector<Packet> & data, std::string Packet::* ptr)
+{
+    ColumnCursor<Packet, std::string> cursor = { ptr, "", "" };
+    if (data.empty())
+    {
+        return cursor;
+    }
+    Integer lensLen = (Integer)(data.size() * sizeof(Integer));
+    cursor._lens = rs.peekOriginalData(lensLen);
+    rs.skipOriginalData(lensLen);
+    unsigned long long total = 0;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        Integer len = 0;
+        memcpy(&len, cursor._lens + i * sizeof(Integer), sizeof(Integer));
+        total += len;
+    }
+    if (total > rs.getStreamUnreadLen())
+    {
+        PROTO4Z_THROW("readColumn string column over stream. total=" << total << ", unread=" << rs.getStreamUnreadLen());
+    }
+    if (total > 0)
+    {
+        cursor._bytes = rs.peekOriginalData((Integer)total);
+        rs.skipOriginalData((Integer)total);
+    }
+    return cursor;
+}
+
+template<class Packet>
+inline void scatterRow(Packet &, size_t)
+{
+}
+
+template<class Packet, class Cursor, class ... Cursors>
+inline void scatterRow(Packet & row, size_t i, Cursor & cursor, Cursors & ... cursors)
+{
+    cursor.read(row, i);
+    scatterRow(row, i, cursors...);
+}
+
+//! one pass over the rows fill every column, each row is written once like the row layout decode.
+template<class Packet, class ... Cursors>
+inline void scatterColumns(std::vector<Packet> & data, Cursors & ... cursors)
+{
+    size_t count = data.size();
+    Packet * rows = count == 0 ? nullptr : &data[0];
+    for (size_t i = 0; i < count; i++)
+    {
+        scatterRow(rows[i], i, cursors...);
+    }
+}
+
+//! decode a single column, data must be resized to the column count.
+template<class Packet, class Member>
+inline void readColumn(ReadStream & rs, std::vector<Packet> & data, Member Packet::* ptr)
 {
-    Integer len = (Integer)data.length();
-    ws << len;
-    ws.appendOriginalData(data.c_str(), len);
-    return ws;
+    auto cursor = peekColumn(rs, data, ptr);
+    scatterColumns(data, cursor);
 }
-//read std::string
-template<class _Traits, class _Alloc>
-inline ReadStream & operator >> (ReadStream & rs, std::basic_string<char, _Traits, _Alloc> & data)
+
+
+//////////////////////////////////////////////////////////////////////////
+//! quantized float
+//////////////////////////////////////////////////////////////////////////
+
+//! fixedN(range,precision): the member is float, the wire is round(value / precision) in a signed N bits integer, clamp to +-limit.
+template<class Integral>
+struct FixedQuantizer
 {
-    Integer len = 0;
-    rs >> len;
-    data.assign(rs.peekOriginalData(len), len);
-    rs.skipOriginalData(len);
-    return rs;
-}
+    typedef Integral IntegralType;
+    double _precision;
+    double _scale;
+    double _limit;
+    FixedQuantizer(double precision, long long limit) : _precision(precision), _scale(1.0 / precision), _limit((double)limit){}
+    //double arithmetic like the lua, c# and lua c codec, the same reciprocal give the same wire in every language.
+    //float would double the simd lanes of fixed8/fixed16 but round differently near the half step, so it is not used.
+    //nan is 0, clamp and round half away from zero are selects only, so the blocks in quantizeArray compile to simd at -O2.
+    inline Integral quantize(float value) const
+    {
+        double q = value * _scale;
+        q = q == q ? q : 0.0;
+        q = q < -_limit ? -_limit : q;
+        q = q > _limit ? _limit : q;
+        q += q < 0 ? -0.5 : 0.5;
+        return (Integral)q;
+    }
+    inline float dequantize(Integral q) const { return (float)(q * _precision); }
+};
 
+//! angleN: the member is float degree, the wire is a unsigned N bits integer, one turn is 2^N steps.
+template<class Integral>
+struct AngleQuantizer
+{
+    typedef Integral IntegralType;
+    inline Integral quantize(float degree) const
+    {
+        const float steps = (float)(1ULL << (sizeof(Integral) * 8));
+        float turn = degree * (1.0f / 360.0f);
+        turn -= std::floor(turn);
+        turn = turn == turn ? turn : 0.0f;
+        return (Integral)(unsigned int)(turn * steps + 0.5f);
+    }
+    inline float dequantize(Integral q) const
+    {
+        const float steps = (float)(1ULL << (sizeof(Integral) * 8));
+        return (float)q * (360.0f / steps);
+    }
+};
 
-//std::vector
-template<class T, class U, class _Alloc>
-inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::vector<U, _Alloc> & vct)
+//! gcc -O2 only vectorize loops with a constant trip count, so the arrays are walked in fixed blocks and the quantizer is copied to locals.
+//! checked with -fopt-info-vec: fixed16/fixed32 quantize and dequantize are vectorized, fixed8 and angleN stay scalar.
+//! kept out of line, once inlined into a large caller gcc may version the block loop and fall back to scalar.
+template<class Quantizer>
+PROTO4Z_NOINLINE void quantizeArray(const float * src, typename Quantizer::IntegralType * dst, size_t count, const Quantizer & quantizer)
 {
-    ws << (Integer)vct.size();
-    for (typename std::vector<U, _Alloc>::const_iterator iter = vct.begin(); iter != vct.end(); ++iter)
+    const Quantizer q = quantizer;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
     {
-        ws << *iter;
+        for (size_t j = 0; j < 8; j++)
+        {
+            dst[i + j] = q.quantize(src[i + j]);
+        }
+    }
+    for (; i < count; i++)
+    {
+        dst[i] = q.quantize(src[i]);
     }
-    return ws;
 }
 
-template<typename T, class _Alloc>
-inline ReadStream & operator >> (ReadStream & rs, std::vector<T, _Alloc> & vct)
+template<class Quantizer>
+PROTO4Z_NOINLINE void dequantizeArray(const typename Quantizer::IntegralType * src, float * dst, size_t count, const Quantizer & quantizer)
 {
-    Integer totalCount = 0;
-    rs >> totalCount;
-    if (totalCount > 0)
+    const Quantizer q = quantizer;
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
     {
-        T t;
-        vct.clear();
-        vct.reserve(totalCount > 100 ? 100 : totalCount);
-        for (Integer i = 0; i < totalCount; ++i)
+        for (size_t j = 0; j < 8; j++)
         {
-            rs >> t;
-            vct.push_back(t);
+            dst[i + j] = q.dequantize(src[i + j]);
         }
     }
-    return rs;
+    for (; i < count; i++)
+    {
+        dst[i] = q.dequantize(src[i]);
+    }
 }
 
-//std::set
-template<class T, class Key, class _Pr, class _Alloc>
-inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::set<Key, _Pr, _Alloc> & k)
+template<class Quantizer>
+inline void encodeQuantized(char * stream, float value, const Quantizer & quantizer)
 {
-    ws << (Integer)k.size();
-    for (typename std::set<Key, _Pr, _Alloc>::const_iterator iter = k.begin(); iter != k.end(); ++iter)
+    typename Quantizer::IntegralType q = quantizer.quantize(value);
+    memcpy(stream, &q, sizeof(q));
+}
+
+template<class Quantizer>
+inline float decodeQuantized(const char * stream, const Quantizer & quantizer)
+{
+    typename Quantizer::IntegralType q = 0;
+    memcpy(&q, stream, sizeof(q));
+    return quantizer.dequantize(q);
+}
+
+template<class Stream, class Quantizer>
+inline void writeQuantized(Stream & ws, float value, const Quantizer & quantizer)
+{
+    ws << quantizer.quantize(value);
+}
+
+template<class Quantizer>
+inline float readQuantized(ReadStream & rs, const Quantizer & quantizer)
+{
+    typename Quantizer::IntegralType q = 0;
+    rs >> q;
+    return quantizer.dequantize(q);
+}
+
+//! same layout as std::vector<IntegralType>, quantize by chunk, no heap memory.
+template<class Stream, class Quantizer>
+inline void writeQuantizedArray(Stream & ws, const std::vector<float> & data, const Quantizer & quantizer)
+{
+    typename Quantizer::IntegralType chunk[ColumnChunkSize];
+    ws << (Integer)data.size();
+    for (size_t begin = 0; begin < data.size(); begin += ColumnChunkSize)
     {
-        ws << *iter;
+        size_t count = std::min(data.size() - begin, (size_t)ColumnChunkSize);
+        quantizeArray(data.data() + begin, chunk, count, quantizer);
+        ws.appendOriginalData((const char *)chunk, (Integer)(count * sizeof(chunk[0])));
     }
-    return ws;
 }
 
-template<class Key, class _Pr, class _Alloc>
-inline ReadStream & operator >> (ReadStream & rs, std::set<Key, _Pr, _Alloc> & k)
+template<class Quantizer>
+inline void readQuantizedArray(ReadStream & rs, std::vector<float> & data, const Quantizer & quantizer)
 {
+    typename Quantizer::IntegralType chunk[ColumnChunkSize];
     Integer totalCount = 0;
     rs >> totalCount;
-    Key t;
-    k.clear();
-    for (Integer i = 0; i < totalCount; ++i)
+    if (totalCount > rs.getStreamUnreadLen() / sizeof(chunk[0]))
     {
-        rs >> t;
-        k.insert(t);
+        PROTO4Z_THROW("readQuantizedArray count over stream. totalCount=" << totalCount << ", unread=" << rs.getStreamUnreadLen());
+    }
+    data.resize(totalCount);
+    for (size_t begin = 0; begin < data.size(); begin += ColumnChunkSize)
+    {
+        size_t count = std::min(data.size() - begin, (size_t)ColumnChunkSize);
+        Integer len = (Integer)(count * sizeof(chunk[0]));
+        memcpy(chunk, rs.peekOriginalData(len), len);
+        rs.skipOriginalData(len);
+        dequantizeArray(chunk, data.data() + begin, count, quantizer);
     }
-    return rs;
 }
 
-//std::multiset
-template<class T, class Key, class _Pr, class _Alloc>
-inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::multiset<Key, _Pr, _Alloc> & k)
+
+
+//////////////////////////////////////////////////////////////////////////
+//! lua bridge
+//////////////////////////////////////////////////////////////////////////
+#if defined(LUA_VERSION_NUM) && LUA_VERSION_NUM >= 503
+#define PROTO4Z_WITH_LUA 1
+
+//! include lua.hpp before proto4z.h to enable. generated pushLua/readLua move a packet between c++ and lua without stream.
+//! the table is the same as Proto4z.decode in proto4z.lua: packet by member name, array from 1, map by key.
+//! readLua keep the value of a nil member, PROTO4Z_THROW on type mismatch, the lua stack is not restored then.
+inline void checkLuaStack(lua_State * L, int extra)
 {
-    ws << (Integer)k.size();
-    for (typename std::multiset<Key, _Pr, _Alloc>::const_iterator iter = k.begin(); iter != k.end(); ++iter)
+    if (!lua_checkstack(L, extra))
     {
-        ws << *iter;
+        PROTO4Z_THROW("lua stack overflow. top=" << lua_gettop(L));
     }
-    return ws;
+}
+inline void throwLuaType(lua_State * L, int index, const char * expect)
+{
+    PROTO4Z_THROW("readLua expect " << expect << " but got " << luaL_typename(L, index));
 }
 
-template<class Key, class _Pr, class _Alloc>
-inline ReadStream & operator >> (ReadStream & rs, std::multiset<Key, _Pr, _Alloc> & k)
+//declare all first, the nested container calls are resolved at the definition.
+template<class T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type pushLua(lua_State * L, const T & v);
+inline void pushLua(lua_State * L, bool v);
+inline void pushLua(lua_State * L, float v);
+inline void pushLua(lua_State * L, double v);
+template<class _Traits, class _Alloc>
+inline void pushLua(lua_State * L, const std::basic_string<char, _Traits, _Alloc> & str);
+template<unsigned int Capacity>
+inline void pushLua(lua_State * L, const FixedString<Capacity> & str);
+template<class T, class _Alloc>
+inline void pushLua(lua_State * L, const std::vector<T, _Alloc> & vct);
+template<class T, unsigned int Capacity>
+inline void pushLua(lua_State * L, const FixedVector<T, Capacity> & vct);
+template<class Key, class Value, class _Pr, class _Alloc>
+inline void pushLua(lua_State * L, const std::map<Key, Value, _Pr, _Alloc> & kv);
+template<class Key, class Value, class _Hash, class _Eq, class _Alloc>
+inline void pushLua(lua_State * L, const std::unordered_map<Key, Value, _Hash, _Eq, _Alloc> & kv);
+template<class Key, class Value, class Compare>
+inline void pushLua(lua_State * L, const FlatMap<Key, Value, Compare> & kv);
+
+template<class T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type readLua(lua_State * L, int index, T & v);
+inline void readLua(lua_State * L, int index, bool & v);
+inline void readLua(lua_State * L, int index, float & v);
+inline void readLua(lua_State * L, int index, double & v);
+template<class _Traits, class _Alloc>
+inline void readLua(lua_State * L, int index, std::basic_string<char, _Traits, _Alloc> & str);
+template<unsigned int Capacity>
+inline void readLua(lua_State * L, int index, FixedString<Capacity> & str);
+template<class T, class _Alloc>
+inline void readLua(lua_State * L, int index, std::vector<T, _Alloc> & vct);
+template<class T, unsigned int Capacity>
+inline void readLua(lua_State * L, int index, FixedVector<T, Capacity> & vct);
+template<class Key, class Value, class _Pr, class _Alloc>
+inline void readLua(lua_State * L, int index, std::map<Key, Value, _Pr, _Alloc> & kv);
+template<class Key, class Value, class _Hash, class _Eq, class _Alloc>
+inline void readLua(lua_State * L, int index, std::unordered_map<Key, Value, _Hash, _Eq, _Alloc> & kv);
+template<class Key, class Value, class Compare>
+inline void readLua(lua_State * L, int index, FlatMap<Key, Value, Compare> & kv);
+
+//ui64 over the max of lua_Integer wrap to negative, same as Proto4zUtil.unpack.
+template<class T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type pushLua(lua_State * L, const T & v)
 {
-    Integer totalCount = 0;
-    rs >> totalCount;
-    Key t;
-    k.clear();
-    for (Integer i = 0; i < totalCount; ++i)
+    lua_pushinteger(L, (lua_Integer)v);
+}
+inline void pushLua(lua_State * L, bool v) { lua_pushboolean(L, v ? 1 : 0); }
+inline void pushLua(lua_State * L, float v) { lua_pushnumber(L, v); }
+inline void pushLua(lua_State * L, double v) { lua_pushnumber(L, v); }
+template<class _Traits, class _Alloc>
+inline void pushLua(lua_State * L, const std::basic_string<char, _Traits, _Alloc> & str)
+{
+    lua_pushlstring(L, str.data(), str.length());
+}
+template<unsigned int Capacity>
+inline void pushLua(lua_State * L, const FixedString<Capacity> & str)
+{
+    lua_pushlstring(L, str.data(), str.length());
+}
+
+template<class Iter>
+inline void pushLuaSequence(lua_State * L, Iter begin, Iter end, size_t count)
+{
+    checkLuaStack(L, 3);
+    lua_createtable(L, (int)count, 0);
+    lua_Integer i = 1;
+    for (; begin != end; ++begin)
     {
-        rs >> t;
-        k.insert(t);
+        pushLua(L, *begin);
+        lua_rawseti(L, -2, i++);
     }
-    return rs;
 }
-
-//std::map
-template<class T, class Key, class Value, class _Pr, class _Alloc>
-inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::map<Key, Value, _Pr, _Alloc> & kv)
+template<class Iter>
+inline void pushLuaKeyValue(lua_State * L, Iter begin, Iter end, size_t count)
 {
-    ws << (Integer)kv.size();
-    for (typename std::map<Key, Value, _Pr, _Alloc>::const_iterator iter = kv.begin(); iter != kv.end(); ++iter)
+    checkLuaStack(L, 4);
+    lua_createtable(L, 0, (int)count);
+    for (; begin != end; ++begin)
     {
-        ws << iter->first;
-        ws << iter->second;
+        pushLua(L, begin->first);
+        pushLua(L, begin->second);
+        lua_rawset(L, -3);
     }
-    return ws;
 }
-
+template<class T, class _Alloc>
+inline void pushLua(lua_State * L, const std::vector<T, _Alloc> & vct)
+{
+    pushLuaSequence(L, vct.begin(), vct.end(), vct.size());
+}
+template<class T, unsigned int Capacity>
+inline void pushLua(lua_State * L, const FixedVector<T, Capacity> & vct)
+{
+    pushLuaSequence(L, vct.begin(), vct.end(), vct.size());
+}
 template<class Key, class Value, class _Pr, class _Alloc>
-inline ReadStream & operator >> (ReadStream & rs, std::map<Key, Value, _Pr, _Alloc> & kv)
+inline void pushLua(lua_State * L, const std::map<Key, Value, _Pr, _Alloc> & kv)
 {
-    Integer totalCount = 0;
-    rs >> totalCount;
-    std::pair<Key, Value> pr;
-    kv.clear();
-    for (Integer i = 0; i < totalCount; ++i)
+    pushLuaKeyValue(L, kv.begin(), kv.end(), kv.size());
+}
+template<class Key, class Value, class _Hash, class _Eq, class _Alloc>
+inline void pushLua(lua_State * L, const std::unordered_map<Key, Value, _Hash, _Eq, _Alloc> & kv)
+{
+    pushLuaKeyValue(L, kv.begin(), kv.end(), kv.size());
+}
+template<class Key, class Value, class Compare>
+inline void pushLua(lua_State * L, const FlatMap<Key, Value, Compare> & kv)
+{
+    pushLuaKeyValue(L, kv.begin(), kv.end(), kv.size());
+}
+
+template<class T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type readLua(lua_State * L, int index, T & v)
+{
+    int isnum = 0;
+    lua_Integer i = lua_tointegerx(L, index, &isnum);
+    if (isnum)
     {
-        rs >> pr.first;
-        rs >> pr.second;
-        kv.insert(pr);
+        v = (T)i;
+    }
+    else if (lua_type(L, index) == LUA_TNUMBER)
+    {
+        v = (T)(long long)lua_tonumber(L, index); //float value, truncate like Proto4zUtil.pack
+    }
+    else
+    {
+        throwLuaType(L, index, "integer");
     }
-    return rs;
 }
-
-//std::multimap
-template<class T, class Key, class Value, class _Pr, class _Alloc>
-inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::multimap<Key, Value, _Pr, _Alloc> & kv)
+//boolean, or number as bits packed by proto4z.lua.
+inline void readLua(lua_State * L, int index, bool & v)
 {
-    ws << (Integer)kv.size();
-    for (typename std::multimap<Key, Value, _Pr, _Alloc>::const_iterator iter = kv.begin(); iter != kv.end(); ++iter)
+    if (lua_type(L, index) == LUA_TBOOLEAN)
     {
-        ws << iter->first;
-        ws << iter->second;
+        v = lua_toboolean(L, index) != 0;
+    }
+    else if (lua_type(L, index) == LUA_TNUMBER)
+    {
+        v = lua_tonumber(L, index) != 0;
+    }
+    else
+    {
+        throwLuaType(L, index, "boolean");
     }
-    return ws;
 }
-
-template<class Key, class Value, class _Pr, class _Alloc>
-inline ReadStream & operator >> (ReadStream & rs, std::multimap<Key, Value, _Pr, _Alloc> & kv)
+inline void readLua(lua_State * L, int index, double & v)
 {
-    Integer totalCount = 0;
-    rs >> totalCount;
-    std::pair<Key, Value> pr;
-    kv.clear();
-    for (Integer i = 0; i < totalCount; ++i)
+    int isnum = 0;
+    v = (double)lua_tonumberx(L, index, &isnum);
+    if (!isnum)
     {
-        rs >> pr.first;
-        rs >> pr.second;
-        kv.insert(pr);
+        throwLuaType(L, index, "number");
     }
-    return rs;
 }
-
-
-//std::list
-template<class T, class Value, class _Alloc>
-inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::list<Value, _Alloc> & l)
+inline void readLua(lua_State * L, int index, float & v)
 {
-    ws << (Integer)l.size();
-    for (typename std::list<Value,_Alloc>::const_iterator iter = l.begin(); iter != l.end(); ++iter)
+    double d = 0;
+    readLua(L, index, d);
+    v = (float)d;
+}
+//only a string value, lua_tolstring change a number key in place and break lua_next.
+inline const char * toLuaString(lua_State * L, int index, size_t & len)
+{
+    if (lua_type(L, index) != LUA_TSTRING)
     {
-        ws << *iter;
+        throwLuaType(L, index, "string");
     }
-    return ws;
+    return lua_tolstring(L, index, &len);
+}
+template<class _Traits, class _Alloc>
+inline void readLua(lua_State * L, int index, std::basic_string<char, _Traits, _Alloc> & str)
+{
+    size_t len = 0;
+    const char * s = toLuaString(L, index, len);
+    str.assign(s, len);
+}
+template<unsigned int Capacity>
+inline void readLua(lua_State * L, int index, FixedString<Capacity> & str)
+{
+    size_t len = 0;
+    const char * s = toLuaString(L, index, len);
+    str.assign(s, (Integer)len);
 }
 
-template<class Value, class _Alloc>
-inline ReadStream & operator >> (ReadStream & rs, std::list<Value, _Alloc> & l)
+template<class Container>
+inline void readLuaSequence(lua_State * L, int index, Container & vct)
 {
-    Integer totalCount = 0;
-    rs >> totalCount;
-    Value t;
-    l.clear();
-    for (Integer i = 0; i < totalCount; ++i)
+    if (!lua_istable(L, index))
     {
-        rs >> t;
-        l.push_back(t);
+        throwLuaType(L, index, "table");
+    }
+    index = lua_absindex(L, index);
+    checkLuaStack(L, 3);
+    vct.clear();
+    vct.resize((Integer)lua_rawlen(L, index));
+    for (size_t i = 0; i < vct.size(); i++)
+    {
+        lua_rawgeti(L, index, (lua_Integer)i + 1);
+        readLua(L, -1, vct[i]);
+        lua_pop(L, 1);
     }
-    return rs;
 }
-//std::deque
-template<class T, class Value, class _Alloc>
-inline WriteStreamImpl<T> & operator << (WriteStreamImpl<T> & ws, const std::deque<Value, _Alloc> & l)
+template<class Container>
+inline void readLuaKeyValue(lua_State * L, int index, Container & kv)
 {
-    ws << (Integer)l.size();
-    for (typename std::deque<Value,_Alloc>::const_iterator iter = l.begin(); iter != l.end(); ++iter)
+    if (!lua_istable(L, index))
     {
-        ws << *iter;
+        throwLuaType(L, index, "table");
+    }
+    index = lua_absindex(L, index);
+    checkLuaStack(L, 4);
+    kv.clear();
+    lua_pushnil(L);
+    while (lua_next(L, index) != 0)
+    {
+        typename Container::key_type k;
+        readLua(L, -2, k);
+        readLua(L, -1, kv[k]);
+        lua_pop(L, 1);
     }
-    return ws;
 }
-
-template<class Value, class _Alloc>
-inline ReadStream & operator >> (ReadStream & rs, std::deque<Value, _Alloc> & l)
+template<class T, class _Alloc>
+inline void readLua(lua_State * L, int index, std::vector<T, _Alloc> & vct)
 {
-    Integer totalCount = 0;
-    rs >> totalCount;
-    Value t;
-    l.clear();
-    for (Integer i = 0; i < totalCount; ++i)
+    readLuaSequence(L, index, vct);
+}
+template<class T, unsigned int Capacity>
+inline void readLua(lua_State * L, int index, FixedVector<T, Capacity> & vct)
+{
+    readLuaSequence(L, index, vct);
+}
+template<class Key, class Value, class _Pr, class _Alloc>
+inline void readLua(lua_State * L, int index, std::map<Key, Value, _Pr, _Alloc> & kv)
+{
+    readLuaKeyValue(L, index, kv);
+}
+template<class Key, class Value, class _Hash, class _Eq, class _Alloc>
+inline void readLua(lua_State * L, int index, std::unordered_map<Key, Value, _Hash, _Eq, _Alloc> & kv)
+{
+    readLuaKeyValue(L, index, kv);
+}
+//lua_next has no order, append all and sort once.
+template<class Key, class Value, class Compare>
+inline void readLua(lua_State * L, int index, FlatMap<Key, Value, Compare> & kv)
+{
+    if (!lua_istable(L, index))
     {
-        rs >> t;
-        l.push_back(t);
+        throwLuaType(L, index, "table");
     }
-    return rs;
+    index = lua_absindex(L, index);
+    checkLuaStack(L, 4);
+    kv.clear();
+    try
+    {
+        lua_pushnil(L);
+        while (lua_next(L, index) != 0)
+        {
+            auto & v = kv.appendUnsorted();
+            readLua(L, -2, v.first);
+            readLua(L, -1, v.second);
+            lua_pop(L, 1);
+        }
+    }
+    catch (...)
+    {
+        kv.clear(); //never leave a half unsorted map
+        throw;
+    }
+    kv.sortUnique();
 }
+#endif
 
 
 
@@ -1350,4 +3277,20 @@ using WriteStream = WriteStreamImpl<std::string>;
 _ZSUMMER_PROTO4Z_END
 _ZSUMMER_END
 
+
+//UseLog4z生成的operator<<会直接输出成员, 内联容器需要在log4z命名空间内提供重载以便ADL找到.
+namespace zsummer { namespace log4z { class Log4zStream; } }
+namespace zsummer
+{
+    namespace log4z
+    {
+        template<class Stream, unsigned int Capacity>
+        inline Stream & operator <<(Stream & stm, const zsummer::proto4z::FixedString<Capacity> & t){ return stm << t.c_str(); }
+        template<class Stream, class Value, unsigned int Capacity>
+        inline Stream & operator <<(Stream & stm, const zsummer::proto4z::FixedVector<Value, Capacity> & t){ stm << "FixedVector[size="; stm << t.size(); return stm << "]"; }
+        template<class Stream, class Key, class Value, class Compare>
+        inline Stream & operator <<(Stream & stm, const zsummer::proto4z::FlatMap<Key, Value, Compare> & t){ stm << "FlatMap[size="; stm << t.size(); return stm << "]"; }
+    }
+}
+
 #endif
@@ -96,6 +96,62 @@ function Proto4z.decode(binData, name)
     return result
 end
 
+--[[--
+decode binary stream into the target table, the nested tables of target are reused and the arrays are truncated in place.
+the replaced tables go to the table pool of Proto4zUtil.newTable and Proto4zUtil.recycle, don't keep them.
+@param decodeInto binData.  binary stream
+@param decodeInto name.  dest protocol name
+@param decodeInto target.  output protocol table
+@return target
+]]
+function Proto4z.decodeInto(binData, name, target)
+    return (Proto4zUtil.decodeInto(binData, name, target))
+end
+
+--[[--
+decode binary stream to a lazy protocol table, the member is decoded and cached at the first access.
+nested struct is lazy too, array and map are decoded at the first access. pairs decode all.
+the table keeps binData until every member is decoded.
+@param lazyDecode binData.  binary stream
+@param lazyDecode name.  dest protocol name
+@return protocol table
+]]
+function Proto4z.lazyDecode(binData, name)
+    local proto = Proto4z[name]
+    if proto.__protoDesc == "array" or proto.__protoDesc == "map" then
+        return Proto4z.decode(binData, name)
+    end
+    return Proto4z.__lazy(binData, 1, name)
+end
+
+
+--[[--
+decode binary stream in a coroutine, yield every time about budget bytes are decoded.
+the struct without container member is one step, a big packet is spread over many resumes.
+@param decodeYield binData.  binary stream
+@param decodeYield name.  dest protocol name
+@param decodeYield budget.  bytes decoded between two yields, default 64K
+@return protocol table
+]]
+function Proto4z.decodeYield(binData, name, budget)
+    local result = {}
+    Proto4z.__decodeStep({budget = budget or 65536, used = 0}, binData, 1, name, result)
+    return result
+end
+
+--[[--
+make a step function of decodeYield, call it until it returns true.
+example: local step = Proto4z.decodeSteps(bin, "EchoPack", 4096) local done, result repeat done, result = step() until done
+@param decodeSteps binData.  binary stream
+@param decodeSteps name.  dest protocol name
+@param decodeSteps budget.  bytes decoded in one step, default 64K
+@return step function, it returns true and the protocol table when the decode is finished.
+]]
+function Proto4z.decodeSteps(binData, name, budget)
+    return coroutine.wrap(function()
+        return true, Proto4z.decodeYield(binData, name, budget)
+    end)
+end
 
 --[[--
 make map [protocol id = protocol name]
@@ -140,6 +196,77 @@ local function isInnerType(t, withstring)
         or t == "i8" or t == "ui8" or t == "i16" or t == "i32" or t == "i64" or t == "double"
 end
 
+--fixedN(range,precision) and angleN, same rounding as the C++ quantizer.
+local function quantize(v, quant)
+    v = v or 0
+    if quant.angle then
+        local turn = v % 360
+        if turn ~= turn then turn = 0 end
+        return math.floor(turn / 360 * quant.angle + 0.5) % quant.angle
+    end
+    local q = v * (1 / quant.precision)
+    if q ~= q then q = 0 end
+    if q > quant.limit then q = quant.limit elseif q < -quant.limit then q = -quant.limit end
+    if q < 0 then
+        return math.ceil(q - 0.5)
+    end
+    return math.floor(q + 0.5)
+end
+
+local function dequantize(q, quant)
+    if quant.angle then
+        return q * 360 / quant.angle
+    end
+    return q * quant.precision
+end
+
+--used by the generated string.pack codec
+Proto4z.__quantize = quantize
+Proto4z.__dequantize = dequantize
+
+--i64 and ui64 value, the same conversion as Proto4zUtil.pack
+function Proto4z.__toInteger(v)
+    if math.type(v) == "integer" then
+        return v
+    end
+    v = tonumber(v) or 0
+    if v >= 0x1p63 then
+        v = v - 0x1p64
+    end
+    return math.tointeger(v >= 0 and math.floor(v) or math.ceil(v)) or 0
+end
+
+local fixedSizes = {i8=1, ui8=1, i16=2, ui16=2, i32=4, ui32=4, i64=8, ui64=8, float=4, double=8}
+
+--type code of base type and string, resolved once for every protocol. the codec switch on the code without type string.
+--columnar array also get __rowSize, the least bytes of one row, a string column has at least the length.
+local codeUI32
+local function compileCodes(proto)
+    local typeCode = Proto4zUtil.typeCode
+    codeUI32 = codeUI32 or typeCode("ui32")
+    if proto.__protoDesc then
+        proto.__codeK = proto.__protoTypeK and typeCode(proto.__protoTypeK)
+        proto.__codeV = typeCode(proto.__quant and proto.__quant.wire or proto.__protoTypeV)
+        if proto.__columnar then
+            local elem = Proto4z[proto.__protoTypeV]
+            if not elem.__compiled then
+                compileCodes(elem)
+            end
+            proto.__rowSize = 0
+            for i = 1, #elem do
+                proto.__rowSize = proto.__rowSize + (fixedSizes[elem[i].type] or 4)
+            end
+        end
+    else
+        for i = 1, #proto do
+            if not proto[i].bits then
+                proto[i].code = typeCode(proto[i].quant and proto[i].quant.wire or proto[i].type)
+            end
+        end
+    end
+    proto.__compiled = true
+end
+
 --[[--
 decode binary stream to protocol table
 @param __decode binData.  binary stream
@@ -151,15 +278,59 @@ decode binary stream to protocol table
 function Proto4z.__decode(binData, pos, name, result)
     --print(name .. ":" .. pos)
     local proto = Proto4z[name]
+    if proto.__decoder and not Proto4z.__with_tag then
+        return proto.__decoder(binData, pos, result)
+    end
+    if not proto.__compiled then
+        compileCodes(proto)
+    end
+    local unpackCode = Proto4zUtil.unpackCode
     local v, p
     p = pos
-    if proto.__protoDesc == "array" then
+    if proto.__protoDesc == "array" and proto.__columnar then
         local len
-        len, p = Proto4zUtil.unpack(binData, p, "ui32")
+        local elem = Proto4z[proto.__protoTypeV]
+        len, p = unpackCode(binData, p, codeUI32)
+        --the count is checked before the rows are created, a forged count can not allocate without the bytes.
+        if len * proto.__rowSize > #binData - p + 1 then
+            error("decode error. columnar count over stream. name=" .. name .. ", count=" .. len .. ", pos=" .. p)
+        end
         for i=1, len do
-            v, p = Proto4zUtil.unpack(binData, p, proto.__protoTypeV)
-            if v ~= nil then
-                result[i] = v
+            result[i] = {}
+        end
+        for c = 1, #elem do
+            local desc = elem[c]
+            if desc.type == "string" then
+                local lens = {}
+                for i=1, len do
+                    lens[i], p = unpackCode(binData, p, codeUI32)
+                end
+                for i=1, len do
+                    if p + lens[i] - 1 > #binData then
+                        error("decode error. columnar string over stream. name=" .. name .. ", len=" .. lens[i] .. ", pos=" .. p)
+                    end
+                    result[i][desc.name] = string.sub(binData, p, p + lens[i] - 1)
+                    p = p + lens[i]
+                end
+            else
+                for i=1, len do
+                    result[i][desc.name], p = unpackCode(binData, p, desc.code)
+                end
+            end
+        end
+    elseif proto.__protoDesc == "array" and proto.__quant then
+        local len
+        len, p = unpackCode(binData, p, codeUI32)
+        for i=1, len do
+            v, p = unpackCode(binData, p, proto.__codeV)
+            result[i] = dequantize(v, proto.__quant)
+        end
+    elseif proto.__protoDesc == "array" then
+        local len
+        len, p = unpackCode(binData, p, codeUI32)
+        for i=1, len do
+            if proto.__codeV then
+                result[i], p = unpackCode(binData, p, proto.__codeV)
             else
                 result[i] = {}
                 p = Proto4z.__decode(binData, p, proto.__protoTypeV, result[i])
@@ -168,38 +339,63 @@ function Proto4z.__decode(binData, pos, name, result)
     elseif proto.__protoDesc == "map" then
         local len
         local k
-        len, p = Proto4zUtil.unpack(binData, p, "ui32")
+        len, p = unpackCode(binData, p, codeUI32)
         for j=1, len do
-            k, p = Proto4zUtil.unpack(binData, p, proto.__protoTypeK)
-            v, p = Proto4zUtil.unpack(binData, p, proto.__protoTypeV)
-            if v ~= nil then
+            if proto.__codeV then
+                k, v, p = Proto4zUtil.unpackPair(binData, p, proto.__codeK, proto.__codeV)
                 result[k] = v
             else
+                k, p = unpackCode(binData, p, proto.__codeK)
                 result[k] = {}
                 p = Proto4z.__decode(binData, p, proto.__protoTypeV, result[k])
             end
         end
     else
         local offset, tag
-        if Proto4z.__with_tag then 
-            offset, p = Proto4zUtil.unpack(binData, p, "ui32")
+        local withTag = Proto4z.__with_tag or proto.__withTag
+        if withTag then 
+            offset, p = unpackCode(binData, p, codeUI32)
             offset = p + offset
-            tag, p = Proto4zUtil.unpack(binData, p, "ui64")
+            --keep the raw 8 bytes, it's the tag format of Proto4zUtil.testTag
+            tag = string.sub(binData, p, p + 7)
+            p = p + 8
         end
-        for i = 1, #proto do
+        local i = 1
+        while i <= #proto do
             local desc = proto[i]
-            if (not Proto4z.__with_tag and  not desc.del ) 
-                or  (Proto4z.__with_tag and Proto4zUtil.testTag(tag, i)) then
-                v, p = Proto4zUtil.unpack(binData, p, desc.type)
-                if v ~= nil then
-                    result[desc.name] = v
-                else
-                    result[desc.name] = {}
-                    p = Proto4z.__decode(binData, p, desc.type, result[desc.name])
+            if desc.bits then
+                --consecutive bool and bits:N members share one bitmap
+                local group, widths = {}, {}
+                while proto[i] and proto[i].bits do
+                    table.insert(group, proto[i])
+                    table.insert(widths, proto[i].bits)
+                    i = i + 1
+                end
+                v, p = Proto4zUtil.unpackBits(binData, p, widths)
+                for j = 1, #group do
+                    if group[j].type == "bool" then
+                        result[group[j].name] = v[j] ~= 0
+                    else
+                        result[group[j].name] = v[j]
+                    end
+                end
+            else
+                if (not withTag and  not desc.del ) 
+                    or  (withTag and Proto4zUtil.testTag(tag, i)) then
+                    if desc.quant then
+                        v, p = unpackCode(binData, p, desc.code)
+                        result[desc.name] = dequantize(v, desc.quant)
+                    elseif desc.code then
+                        result[desc.name], p = unpackCode(binData, p, desc.code)
+                    else
+                        result[desc.name] = {}
+                        p = Proto4z.__decode(binData, p, desc.type, result[desc.name])
+                    end
                 end
+                i = i + 1
             end
         end
-        if Proto4z.__with_tag then
+        if withTag then
             p = offset
         end
     end
@@ -216,19 +412,52 @@ encode protocol table to binary stream
 ]]
 function Proto4z.__encode(obj, name, data)
     local proto = Proto4z[name]
+    if proto.__encoder and not Proto4z.__with_tag then
+        table.insert(data, proto.__encoder(obj))
+        return
+    end
+    if not proto.__compiled then
+        compileCodes(proto)
+    end
+    local packCode = Proto4zUtil.packCode
+    --columnar array, member by member
+    --------------------------------------
+    if proto.__protoDesc == "array" and proto.__columnar then
+        local obj = obj or {}
+        local elem = Proto4z[proto.__protoTypeV]
+        table.insert(data, packCode(#obj, codeUI32))
+        for c = 1, #elem do
+            local desc = elem[c]
+            if desc.type == "string" then
+                for i = 1, #obj do
+                    table.insert(data, packCode(#(obj[i][desc.name] or ""), codeUI32))
+                end
+                for i = 1, #obj do
+                    table.insert(data, obj[i][desc.name] or "")
+                end
+            else
+                for i = 1, #obj do
+                    table.insert(data, packCode(obj[i][desc.name], desc.code, name))
+                end
+            end
+        end
+    --quantized array
+    --------------------------------------
+    elseif proto.__protoDesc == "array" and proto.__quant then
+        local obj = obj or {}
+        table.insert(data, packCode(#obj, codeUI32))
+        for i = 1, #obj do
+            table.insert(data, packCode(quantize(obj[i], proto.__quant), proto.__codeV))
+        end
     --array
     --------------------------------------
-    if proto.__protoDesc == "array" then
+    elseif proto.__protoDesc == "array" then
         local obj = obj or {}
-        table.insert(data, Proto4zUtil.pack(#obj, "ui32", name))
+        table.insert(data, packCode(#obj, codeUI32))
         for i =1, #obj do
             local v = obj[i]
-            if proto.__protoTypeV == "string" then
-                local v = ""
-                table.insert(data, Proto4zUtil.pack(#v, "ui32", name))
-                table.insert(data, v)
-            elseif isInnerType(proto.__protoTypeV) then
-                table.insert(data, Proto4zUtil.pack(v, proto.__protoTypeV, name))
+            if proto.__codeV then
+                table.insert(data, packCode(v, proto.__codeV, name))
             else
                 Proto4z.__encode(v, proto.__protoTypeV, data)
             end
@@ -237,54 +466,450 @@ function Proto4z.__encode(obj, name, data)
     --------------------------------------
     elseif proto.__protoDesc == "map" then
         local obj = obj or {}
-        table.insert(data, Proto4zUtil.pack(0, "ui32", name))
+        table.insert(data, packCode(0, codeUI32))
         local fixPos = #data
         local mapCount = 0
         for k, v in pairs(obj) do
             mapCount = mapCount + 1
-            if proto.__protoTypeK == "string" then
-                table.insert(data, Proto4zUtil.pack(#k, "ui32", name))
-                table.insert(data, k)
-            else
-                table.insert(data, Proto4zUtil.pack(k, proto.__protoTypeK, name))
-            end
-            if proto.__protoTypeV == "string" then
-                local v = v or ""
-                table.insert(data, Proto4zUtil.pack(#v, "ui32", name))
-                table.insert(data, v)
-            elseif  isInnerType(proto.__protoTypeV) then
-                table.insert(data, Proto4zUtil.pack(v, proto.__protoTypeV, name))
+            table.insert(data, packCode(k, proto.__codeK))
+            if proto.__codeV then
+                table.insert(data, packCode(v, proto.__codeV, name))
             else
                 Proto4z.__encode(v, proto.__protoTypeV, data)
             end
         end
-        data[fixPos] = Proto4zUtil.pack(mapCount, "ui32", name)
+        data[fixPos] = packCode(mapCount, codeUI32)
     --base typ or struct or proto
     --------------------------------------
     else
-        local curdata, offset
+        local curdata, tag
+        local withTag = Proto4z.__with_tag or proto.__withTag
         curdata = {}
-        for i=1, #proto do
+        if withTag then
+            tag = Proto4zUtil.newTag()
+        end
+        if type(obj) ~= "table" then obj = {} end
+        local i = 1
+        while i <= #proto do
             local desc = proto[i]
-            if not desc.del then
-                if type(obj) ~= "table" then obj = {} end
+            if desc.bits then
+                --consecutive bool and bits:N members share one bitmap
+                local values, widths = {}, {}
+                while proto[i] and proto[i].bits do
+                    local val = obj[proto[i].name]
+                    if val == true then val = 1 elseif not val then val = 0 end
+                    table.insert(values, val)
+                    table.insert(widths, proto[i].bits)
+                    i = i + 1
+                end
+                table.insert(curdata, Proto4zUtil.packBits(values, widths))
+            --with tag only the present member be encoded
+            elseif (not withTag and not desc.del) or (withTag and not desc.del and obj[desc.name] ~= nil) then
                 local val = obj[desc.name]
-                if desc.type == "string" then
-                    local val = val or ""
-                    table.insert(curdata, Proto4zUtil.pack(#val, "ui32", name))
-                    table.insert(curdata, val)
-                elseif isInnerType(desc.type)  then
-                    table.insert(curdata, Proto4zUtil.pack(val, desc.type, name))
+                if withTag then
+                    tag = Proto4zUtil.setTag(tag, i)
+                end
+                if desc.quant then
+                    table.insert(curdata, packCode(quantize(val, desc.quant), desc.code))
+                elseif desc.code then
+                    table.insert(curdata, packCode(val, desc.code, name))
                 else
                     Proto4z.__encode(val, desc.type, curdata)
                 end
             end
+            if not desc.bits then
+                i = i + 1
+            end
         end
         curdata = table.concat(curdata)
+        if withTag then
+            table.insert(data, packCode(#curdata + 8, codeUI32))
+            table.insert(data, tag)
+        end
         table.insert(data, curdata)
     end
 end
 
+--struct without nested struct, array or map, it's decoded in one step.
+local function isLeaf(name)
+    local proto = Proto4z[name]
+    if proto.__leaf == nil then
+        proto.__leaf = not proto.__protoDesc and not proto.__withTag
+        for i = 1, #proto do
+            if not proto[i].bits and not proto[i].quant and not isInnerType(proto[i].type, true) then
+                proto.__leaf = false
+            end
+        end
+    end
+    return proto.__leaf
+end
+
+--account the decoded bytes, yield when the bytes since the last yield reach the budget.
+local function stepBytes(cursor, bytes)
+    cursor.used = cursor.used + bytes
+    if cursor.used >= cursor.budget then
+        cursor.used = 0
+        coroutine.yield()
+    end
+end
+
+--decode one value, a string or a struct without container member is decoded in one call.
+local function stepValue(cursor, binData, pos, t, quant)
+    local v, p
+    if quant then
+        v, p = Proto4zUtil.unpack(binData, pos, quant.wire)
+        v = dequantize(v, quant)
+    elseif isInnerType(t, true) then
+        v, p = Proto4zUtil.unpack(binData, pos, t)
+    elseif not Proto4z.__with_tag and isLeaf(t) then
+        v, p = Proto4zUtil.decode(binData, t, pos)
+    else
+        v = {}
+        return v, Proto4z.__decodeStep(cursor, binData, pos, t, v)
+    end
+    if p == nil then
+        error("decode error. type=" .. t .. ", pos=" .. pos)
+    end
+    stepBytes(cursor, p - pos)
+    return v, p
+end
+
+--[[--
+decode binary stream step by step, same result as Proto4z.__decode.
+columnar array is decoded column by column and may yield between any two rows.
+a single string or a struct without container member is not split, one step can go over the budget by one such value.
+@param __decodeStep cursor.  {budget=bytes per step, used=bytes since the last yield}
+@param __decodeStep binData.  binary stream
+@param __decodeStep pos.  current binary begin index
+@param __decodeStep name.  dest protocol name
+@param __decodeStep result. output protocol table.
+@return next begin index
+]]
+function Proto4z.__decodeStep(cursor, binData, pos, name, result)
+    local proto = Proto4z[name]
+    local v, p, len
+    p = pos
+    if proto.__protoDesc == "array" and proto.__columnar then
+        if not proto.__compiled then
+            compileCodes(proto)
+        end
+        local unpackCode = Proto4zUtil.unpackCode
+        local elem = Proto4z[proto.__protoTypeV]
+        len, p = unpackCode(binData, p, codeUI32)
+        if len * proto.__rowSize > #binData - p + 1 then
+            error("decode error. columnar count over stream. name=" .. name .. ", count=" .. len .. ", pos=" .. p)
+        end
+        --the rows are created by the first column, same as Proto4z.__decode.
+        for c = 1, #elem do
+            local desc = elem[c]
+            if desc.type == "string" then
+                local lens = {}
+                for i = 1, len do
+                    lens[i], p = unpackCode(binData, p, codeUI32)
+                    stepBytes(cursor, 4)
+                end
+                for i = 1, len do
+                    if p + lens[i] - 1 > #binData then
+                        error("decode error. columnar string over stream. name=" .. name .. ", len=" .. lens[i] .. ", pos=" .. p)
+                    end
+                    local row = c == 1 and {} or result[i]
+                    row[desc.name] = string.sub(binData, p, p + lens[i] - 1)
+                    result[i] = row
+                    p = p + lens[i]
+                    stepBytes(cursor, lens[i])
+                end
+            else
+                for i = 1, len do
+                    local row = c == 1 and {} or result[i]
+                    v = p
+                    row[desc.name], p = unpackCode(binData, p, desc.code)
+                    result[i] = row
+                    stepBytes(cursor, p - v)
+                end
+            end
+        end
+    elseif proto.__protoDesc == "array" then
+        len, p = Proto4zUtil.unpack(binData, p, "ui32")
+        for i = 1, len do
+            result[i], p = stepValue(cursor, binData, p, proto.__protoTypeV, proto.__quant)
+        end
+    elseif proto.__protoDesc == "map" then
+        local k
+        len, p = Proto4zUtil.unpack(binData, p, "ui32")
+        for j = 1, len do
+            k, p = stepValue(cursor, binData, p, proto.__protoTypeK)
+            result[k], p = stepValue(cursor, binData, p, proto.__protoTypeV)
+        end
+    else
+        local offset, tag
+        local withTag = Proto4z.__with_tag or proto.__withTag
+        if withTag then
+            offset, p = Proto4zUtil.unpack(binData, p, "ui32")
+            offset = p + offset
+            tag = string.sub(binData, p, p + 7)
+            p = p + 8
+        end
+        local i = 1
+        while i <= #proto do
+            local desc = proto[i]
+            if desc.bits then
+                local group, widths = {}, {}
+                while proto[i] and proto[i].bits do
+                    table.insert(group, proto[i])
+                    table.insert(widths, proto[i].bits)
+                    i = i + 1
+                end
+                v, p = Proto4zUtil.unpackBits(binData, p, widths)
+                for j = 1, #group do
+                    if group[j].type == "bool" then
+                        result[group[j].name] = v[j] ~= 0
+                    else
+                        result[group[j].name] = v[j]
+                    end
+                end
+            else
+                if (not withTag and not desc.del) or (withTag and Proto4zUtil.testTag(tag, i)) then
+                    result[desc.name], p = stepValue(cursor, binData, p, desc.type, desc.quant)
+                end
+                i = i + 1
+            end
+        end
+        if withTag then
+            p = offset
+        end
+    end
+    return p
+end
+
+
+--wire size of the type, nil if the size depends on the value. the size of struct is cached in __fixedSize.
+local function fixedSize(t)
+    if fixedSizes[t] then
+        return fixedSizes[t]
+    end
+    local proto = Proto4z[t]
+    if not proto or proto.__protoDesc or Proto4z.__with_tag or proto.__withTag then
+        return nil
+    end
+    if proto.__fixedSize == nil then
+        local size, bits = 0, 0
+        for i = 1, #proto do
+            local desc = proto[i]
+            if desc.bits then
+                bits = bits + desc.bits
+            elseif not desc.del then
+                local member = fixedSize(desc.quant and desc.quant.wire or desc.type)
+                if not member then
+                    size = false
+                    break
+                end
+                size = size + (bits + 7) // 8 + member
+                bits = 0
+            end
+        end
+        proto.__fixedSize = size and size + (bits + 7) // 8
+    end
+    return proto.__fixedSize or nil
+end
+
+local function skipValue(binData, pos, t, quant)
+    local size = fixedSize(quant and quant.wire or t)
+    if size then
+        return pos + size
+    end
+    if t == "string" then
+        return pos + 4 + Proto4zUtil.unpack(binData, pos, "ui32")
+    end
+    return Proto4z.__skip(binData, pos, t)
+end
+
+--[[--
+skip one protocol in binary stream without decode
+@param __skip binData.  binary stream
+@param __skip pos.  current binary begin index
+@param __skip name.  protocol name
+@return next begin index
+]]
+function Proto4z.__skip(binData, pos, name)
+    local proto = Proto4z[name]
+    local len, p = Proto4zUtil.unpack(binData, pos, "ui32")
+    if proto.__protoDesc == "array" and proto.__columnar then
+        local elem = Proto4z[proto.__protoTypeV]
+        for c = 1, #elem do
+            if elem[c].type == "string" then
+                local lens = p
+                p = p + 4 * len
+                for i = 1, len do
+                    p = p + Proto4zUtil.unpack(binData, lens + 4 * (i - 1), "ui32")
+                end
+            else
+                p = p + fixedSizes[elem[c].type] * len
+            end
+        end
+    elseif proto.__protoDesc == "array" then
+        local size = fixedSize(proto.__quant and proto.__quant.wire or proto.__protoTypeV)
+        if size then
+            return p + size * len
+        end
+        for i = 1, len do
+            p = skipValue(binData, p, proto.__protoTypeV)
+        end
+    elseif proto.__protoDesc == "map" then
+        for i = 1, len do
+            p = skipValue(binData, p, proto.__protoTypeK)
+            p = skipValue(binData, p, proto.__protoTypeV)
+        end
+    elseif Proto4z.__with_tag or proto.__withTag then
+        --len is the offset to the end of the protocol
+        return p + len
+    else
+        p = pos
+        local i = 1
+        while i <= #proto do
+            local desc = proto[i]
+            if desc.bits then
+                local bits = 0
+                while proto[i] and proto[i].bits do
+                    bits = bits + proto[i].bits
+                    i = i + 1
+                end
+                p = p + (bits + 7) // 8
+            else
+                if not desc.del then
+                    p = skipValue(binData, p, desc.type, desc.quant)
+                end
+                i = i + 1
+            end
+        end
+    end
+    return p
+end
+
+--decode member index of the lazy protocol table, cache the value in the table.
+local function lazyLoad(result, state, index)
+    local proto, binData = state.proto, state.binData
+    --the offset of every member before index
+    while state.next <= index do
+        local i, p = state.next, state.pos
+        local desc = proto[i]
+        if desc.bits then
+            local bits = 0
+            while proto[i] and proto[i].bits do
+                state.offsets[i] = p
+                bits = bits + proto[i].bits
+                i = i + 1
+            end
+            p = p + (bits + 7) // 8
+        else
+            if (not state.tag and not desc.del) or (state.tag and Proto4zUtil.testTag(state.tag, i)) then
+                state.offsets[i] = p
+                if i < #proto then
+                    p = skipValue(binData, p, desc.type, desc.quant)
+                end
+            else
+                state.offsets[i] = false
+            end
+            i = i + 1
+        end
+        state.next, state.pos = i, p
+    end
+
+    local desc, p = proto[index], state.offsets[index]
+    local v
+    if desc.bits then
+        local first = index
+        while first > 1 and proto[first - 1].bits do
+            first = first - 1
+        end
+        local widths = {}
+        local last = first
+        while proto[last] and proto[last].bits do
+            table.insert(widths, proto[last].bits)
+            last = last + 1
+        end
+        local values = Proto4zUtil.unpackBits(binData, p, widths)
+        for j = first, last - 1 do
+            v = values[j - first + 1]
+            if proto[j].type == "bool" then
+                v = v ~= 0
+            end
+            if not state.loaded[j] then
+                state.loaded[j] = true
+                state.left = state.left - 1
+                rawset(result, proto[j].name, v)
+            end
+        end
+        v = rawget(result, desc.name)
+    else
+        if p then
+            if desc.quant then
+                v = dequantize(Proto4zUtil.unpack(binData, p, desc.quant.wire), desc.quant)
+            else
+                v = Proto4zUtil.unpack(binData, p, desc.type)
+            end
+            if v == nil then
+                local nested = Proto4z[desc.type]
+                if nested.__protoDesc == "array" or nested.__protoDesc == "map" then
+                    v = {}
+                    Proto4z.__decode(binData, p, desc.type, v)
+                else
+                    v = Proto4z.__lazy(binData, p, desc.type)
+                end
+            end
+            rawset(result, desc.name, v)
+        end
+        state.loaded[index] = true
+        state.left = state.left - 1
+    end
+    --every member is decoded, release binData
+    if state.left == 0 then
+        setmetatable(result, nil)
+    end
+    return v
+end
+
+--[[--
+make the lazy protocol table
+@param __lazy binData.  binary stream
+@param __lazy pos.  current binary begin index
+@param __lazy name.  dest protocol name
+@return protocol table
+]]
+function Proto4z.__lazy(binData, pos, name)
+    local proto = Proto4z[name]
+    if not proto.__lazyIndex then
+        proto.__lazyIndex = {}
+        for i = 1, #proto do
+            proto.__lazyIndex[proto[i].name] = i
+        end
+    end
+    local state = {proto = proto, binData = binData, pos = pos, next = 1, offsets = {}, loaded = {}, left = #proto}
+    if Proto4z.__with_tag or proto.__withTag then
+        state.tag = string.sub(binData, pos + 4, pos + 11)
+        state.pos = pos + 12
+    end
+    local result = {}
+    if #proto == 0 then
+        return result
+    end
+    return setmetatable(result, {
+        __index = function(t, k)
+            local index = proto.__lazyIndex[k]
+            if index and not state.loaded[index] then
+                return lazyLoad(t, state, index)
+            end
+        end,
+        __pairs = function(t)
+            for i = 1, #proto do
+                if not state.loaded[i] then
+                    lazyLoad(t, state, i)
+                end
+            end
+            return next, t, nil
+        end,
+    })
+end
+
 
 
 --------------------------------------------------------------------------
@@ -48,6 +48,21 @@ require("TestProto")
 dump = Proto4z.dump
 local proto = Proto4z
 
+--the string.pack codec is checked against the interpreter at the end, stash it first
+local codecs = {}
+for name, desc in pairs(Proto4z) do
+	if type(desc) == "table" and desc.__encoder then
+		codecs[name] = {desc.__encoder, desc.__decoder}
+		desc.__encoder, desc.__decoder = nil, nil
+	end
+end
+local function useCodec(on)
+	for name, codec in pairs(codecs) do
+		Proto4z[name].__encoder = on and codec[1] or nil
+		Proto4z[name].__decoder = on and codec[2] or nil
+	end
+end
+
 
 local pack = {id=10, name="name", createTime=100, moneyTree={lastTime=1,freeCount=5,payCount=5,statSum=0,statCount=0}}
 local binMemory = Proto4z.encode(pack, "SimplePack")
@@ -83,15 +98,393 @@ for i=1, 1 do
 end
 print("used time=" .. (Proto4zUtil.now() - now))
 
+--tagged packet, only the present members be encoded
+local sparseData = Proto4z.encode({id=100, value=3.5}, "SparsePack")
+assert(#sparseData == 4 + 8 + 4 + 8)
+local sparse = Proto4z.decode(sparseData, "SparsePack")
+assert(sparse.id == 100 and sparse.value == 3.5 and sparse.name == nil)
+local nextData = Proto4z.encode({id=200, name="next", extra=300}, "SparsePackNext") .. Proto4z.encode({name="full"}, "SparsePack")
+local result = {}
+local pos = Proto4z.__decode(nextData, 1, "SparsePack", result)
+assert(result.id == 200 and result.name == "next" and result.extra == nil)
+result = {}
+pos = Proto4z.__decode(nextData, pos, "SparsePack", result)
+assert(result.name == "full" and pos == #nextData + 1)
+print("check tagged proto success")
+
+--columnar array
+local columns = {{_char=1, _uchar=2, _short=3, _ushort=4, _int=5, _uint=6, _i64=7, _ui64=8}, {_char=-1, _uchar=255, _short=-3, _ushort=40000, _int=-5, _uint=6, _i64=-7, _ui64=8}}
+local columnData = Proto4z.encode(columns, "IntegerDataColumns")
+assert(#columnData == 4 + 2 * 30)
+local columnResult = Proto4z.decode(columnData, "IntegerDataColumns")
+assert(#columnResult == 2 and columnResult[2]._char == -1 and columnResult[2]._ushort == 40000 and columnResult[1]._ui64 == 8)
+local scolumnResult = Proto4z.decode(Proto4z.encode({{_string="abc"}, {_string=""}, {_string="de"}}, "StringDataColumns"), "StringDataColumns")
+assert(#scolumnResult == 3 and scolumnResult[1]._string == "abc" and scolumnResult[2]._string == "" and scolumnResult[3]._string == "de")
+--forged count and truncated string column are rejected before the rows are created
+assert(not pcall(Proto4z.decode, Proto4zUtil.pack(2000000, "ui32"), "IntegerDataColumns"))
+assert(not pcall(Proto4z.decode, Proto4zUtil.pack(200000000, "ui32"), "StringDataColumns"))
+assert(not pcall(Proto4z.decode, string.sub(Proto4z.encode({{_string="abc"}, {_string="de"}}, "StringDataColumns"), 1, -2), "StringDataColumns"))
+print("check columnar proto success")
+
+--bool and bits:N
+local flagsData = Proto4z.encode({online=true, level=100, camp=5, muted=false, id=12345, hidden=true, exp=0xfedcba9876}, "FlagsPack")
+assert(#flagsData == 2 + 4 + 6)
+local flagsResult = Proto4z.decode(flagsData, "FlagsPack")
+assert(flagsResult.online == true and flagsResult.level == 100 and flagsResult.camp == 5 and flagsResult.muted == false)
+assert(flagsResult.id == 12345 and flagsResult.hidden == true and flagsResult.exp == 0xfedcba9876)
+local bitValues = Proto4zUtil.unpackBits(Proto4zUtil.packBits({5, 0x1ff, 3}, {3, 11, 64}), 1, {3, 11, 64})
+assert(bitValues[1] == 5 and bitValues[2] == 0x1ff and bitValues[3] == 3)
+assert(not pcall(Proto4zUtil.unpackBits, "\1", 1, {3, 11}))
+print("check bit packed proto success")
+
+--fixedN(range,precision) and angleN
+local moveData = Proto4z.encode({eid=7, x=1234.567, y=-99999.99, z=200000, speed=-3.14, yaw=-90, pitch=45}, "MovePack")
+assert(#moveData == 18)
+local moveResult = Proto4z.decode(moveData, "MovePack")
+assert(moveResult.eid == 7 and math.abs(moveResult.x - 1234.57) < 0.001 and math.abs(moveResult.y + 99999.99) < 0.001)
+assert(math.abs(moveResult.z - 300) < 0.001 and math.abs(moveResult.speed + 3.1) < 0.001 and moveResult.yaw == 270 and moveResult.pitch == 45)
+local pathResult = Proto4z.decode(Proto4z.encode({eid=1, path={-1.234, 0, 2.5}, heading=360}, "PathPack"), "PathPack")
+assert(#pathResult.path == 3 and math.abs(pathResult.path[1] + 1.23) < 0.001 and pathResult.path[3] == 2.5 and pathResult.heading == 0)
+print("check quantized proto success")
+
+--flat and hash map have the same wire format as map
+local bagResult = Proto4z.decode(Proto4z.encode({items={[3]={_uint=3}, [1]={_uint=1}}, attrs={hp=100, mp=50}}, "BagPack"), "BagPack")
+assert(bagResult.items[3]._uint == 3 and bagResult.items[1]._uint == 1 and bagResult.attrs.hp == 100 and bagResult.attrs.mp == 50)
+print("check flat and hash map success")
+
+
+
+
+
+
+
+
+
+
+
+
+
+
+--decode in c with the compiled schema, same result as Proto4z.decode
+local function same(a, b)
+	if type(a) ~= "table" or type(b) ~= "table" then
+		return a == b and math.type(a) == math.type(b)
+	end
+	for k, v in pairs(a) do
+		if not same(v, b[k]) then return false end
+	end
+	for k, v in pairs(b) do
+		if a[k] == nil then return false end
+	end
+	return true
+end
+local samples = {
+	{"SimplePack", binMemory},
+	{"EchoPack", Proto4z.encode(echo, "EchoPack")},
+	{"SparsePack", sparseData},
+	{"SparsePackNext", Proto4z.encode({id=200, name="next", iarray={{_i64=-1}}, extra=300}, "SparsePackNext")},
+	{"IntegerDataColumns", columnData},
+	{"StringDataColumns", Proto4z.encode({{_string="abc"}, {_string=""}, {_string="de"}}, "StringDataColumns")},
+	{"FlagsPack", flagsData},
+	{"MovePack", moveData},
+	{"PathPack", Proto4z.encode({eid=1, path={-1.234, 0, 2.5}, heading=360}, "PathPack")},
+	{"BagPack", Proto4z.encode({items={[3]={_uint=3}, [1]={_uint=1}}, attrs={hp=100, mp=50}}, "BagPack")},
+}
+for _, sample in ipairs(samples) do
+	local cresult, cpos = Proto4zUtil.decode(sample[2], sample[1])
+	assert(same(cresult, Proto4z.decode(sample[2], sample[1])) and cpos == #sample[2] + 1, sample[1])
+end
+result, pos = Proto4zUtil.decode(nextData, "SparsePack")
+result, pos = Proto4zUtil.decode(nextData, "SparsePack", pos)
+assert(result.name == "full" and pos == #nextData + 1)
+assert(not pcall(Proto4zUtil.decode, string.sub(samples[2][2], 1, -2), "EchoPack"))
+local hostBytes = Proto4zUtil.newBytes(#samples[2][2] + 4)
+assert(Proto4zUtil.encodeTo(echo, "EchoPack", hostBytes, 5) == #samples[2][2] + 5)
+assert(same(Proto4zUtil.decode(hostBytes, "EchoPack", 5), Proto4z.decode(samples[2][2], "EchoPack")))
+assert(same(Proto4zUtil.decode(Proto4zUtil.newBytes(#samples[2][2], samples[2][2]), "EchoPack"), Proto4z.decode(samples[2][2], "EchoPack")))
+local tmpFile = io.tmpfile()
+assert(not pcall(Proto4zUtil.encodeTo, echo, "EchoPack", tmpFile) and not pcall(Proto4zUtil.decode, tmpFile, "EchoPack"))
+tmpFile:close()
+assert(not pcall(Proto4zUtil.decode, Proto4zUtil.pack(2000000, "ui32") .. string.rep("\0", 64), "IntegerDataColumns"))
+assert(not pcall(Proto4zUtil.decode, Proto4zUtil.pack(200000000, "ui32"), "StringDataColumns"))
+assert(not pcall(Proto4zUtil.decode, binMemory, "NotAProto"))
+print("check c decode success")
+
+local echoData = samples[2][2]
+now = Proto4zUtil.now()
+for i = 1, 20000 do
+	Proto4z.decode(echoData, "EchoPack")
+end
+print("lua decode used time=" .. (Proto4zUtil.now() - now))
+now = Proto4zUtil.now()
+for i = 1, 20000 do
+	Proto4zUtil.decode(echoData, "EchoPack")
+end
+print("c decode used time=" .. (Proto4zUtil.now() - now))
+
+--encode in c into a reused buffer, same bytes as Proto4z.encode
+for _, sample in ipairs(samples) do
+	local decoded = Proto4z.decode(sample[2], sample[1])
+	assert(Proto4zUtil.encode(decoded, sample[1]) == Proto4z.encode(decoded, sample[1]), sample[1])
+end
+assert(Proto4zUtil.encode(echo, "EchoPack") == Proto4z.encode(echo, "EchoPack"))
+assert(Proto4zUtil.encode({}, "EchoPack") == Proto4z.encode({}, "EchoPack"))
+assert(Proto4zUtil.encode(nil, "SimplePack") == Proto4z.encode(nil, "SimplePack"))
+--nan quantize to 0, inf has no angle
+local nanMove = {eid=7, x=0/0, y=0, z=0, speed=0/0, yaw=math.huge, pitch=0/0}
+local zeroMove = Proto4z.encode({eid=7, x=0, y=0, z=0, speed=0, yaw=0, pitch=0}, "MovePack")
+assert(Proto4zUtil.encode(nanMove, "MovePack") == zeroMove and Proto4z.encode(nanMove, "MovePack") == zeroMove)
+assert(Proto4zUtil.encode({{_string="a"}, {_string="bc"}}, "StringDataArray") == Proto4z.encode({{_string="a"}, {_string="bc"}}, "StringDataArray"))
+assert(not pcall(Proto4zUtil.encode, {_iarray={{_char="x"}}}, "EchoPack"))
+Proto4z.NameArray = {__protoName="NameArray", __protoDesc="array", __protoTypeV="string"}
+assert(Proto4zUtil.encode({"a", "bc"}, "NameArray") == Proto4z.encode({"a", "bc"}, "NameArray"))
+assert(Proto4zUtil.decode(Proto4z.encode({"a", "bc"}, "NameArray"), "NameArray")[2] == "bc")
+assert(Proto4zUtil.encode({id=1}, "SparsePack") == Proto4z.encode({id=1}, "SparsePack"))
+print("check c encode success")
 
+local echoDecoded = Proto4z.decode(echoData, "EchoPack")
+for _, coder in ipairs({{"lua", Proto4z.encode}, {"c", Proto4zUtil.encode}}) do
+	collectgarbage("collect")
+	collectgarbage("stop")
+	local memory = collectgarbage("count")
+	now = Proto4zUtil.now()
+	for i = 1, 20000 do
+		coder[2](echoDecoded, "EchoPack")
+	end
+	print(coder[1] .. " encode used time=" .. (Proto4zUtil.now() - now) .. ", garbage=" .. math.floor(collectgarbage("count") - memory) .. "KB")
+	collectgarbage("restart")
+end
 
+--generated string.pack codec, same bytes and result as the interpreter
+assert(codecs.EchoPack and codecs.FlagsPack and codecs.MovePack and codecs.PathPack and not codecs.SparsePack and not codecs.IntegerDataColumns)
+local inputs = {{"EchoPack", echo}, {"SimplePack", nil}, {"EchoPack", {}}, {"FlagsPack", {online=true, level=200, exp=-1}}, {"NameArray", {"a", "bc"}}}
+for _, sample in ipairs(samples) do
+	table.insert(inputs, {sample[1], Proto4z.decode(sample[2], sample[1])})
+end
+for _, input in ipairs(inputs) do
+	useCodec(false)
+	local bin = Proto4z.encode(input[2], input[1])
+	local result = Proto4z.decode(bin, input[1])
+	useCodec(true)
+	assert(Proto4z.encode(input[2], input[1]) == bin, input[1])
+	assert(same(Proto4z.decode(bin, input[1]), result), input[1])
+end
+assert(not pcall(Proto4z.decode, string.sub(echoData, 1, -2), "EchoPack"))
+print("check lua codec success")
 
+for _, on in ipairs({false, true}) do
+	useCodec(on)
+	now = Proto4zUtil.now()
+	for i = 1, 20000 do
+		Proto4z.decode(Proto4z.encode(echoDecoded, "EchoPack"), "EchoPack")
+	end
+	print((on and "codec" or "interpreter") .. " encode and decode used time=" .. (Proto4zUtil.now() - now))
+end
 
+--lazy decode, the member is decoded at the first access
+for _, sample in ipairs(samples) do
+	assert(Proto4z.__skip(sample[2], 1, sample[1]) == #sample[2] + 1, sample[1])
+	assert(same(Proto4z.lazyDecode(sample[2], sample[1]), Proto4z.decode(sample[2], sample[1])), sample[1])
+end
+local lazy = Proto4z.lazyDecode(echoData, "EchoPack")
+assert(lazy._sarray[3]._string == "abcdefg" and rawget(lazy, "_iarray") == nil and getmetatable(lazy))
+lazy = Proto4z.lazyDecode(binMemory, "SimplePack")
+assert(lazy.moneyTree.payCount == 5 and rawget(lazy, "name") == nil and rawget(lazy.moneyTree, "lastTime") == nil)
+assert(lazy.id == 10 and lazy.name == "name" and lazy.createTime == 100 and not getmetatable(lazy))
+lazy = Proto4z.lazyDecode(flagsData, "FlagsPack")
+assert(lazy.exp == 0xfedcba9876 and lazy.hidden == true and rawget(lazy, "online") == nil and lazy.camp == 5 and rawget(lazy, "muted") == false)
+lazy = Proto4z.lazyDecode(sparseData, "SparsePack")
+assert(lazy.value == 3.5 and lazy.name == nil and lazy.id == 100)
+assert(Proto4z.lazyDecode(Proto4z.encode({eid=1, path={0.5}}, "PathPack"), "PathPack").path[1] == 0.5)
+print("check lazy decode success")
 
+for _, decoder in ipairs({{"eager", Proto4z.decode}, {"lazy", Proto4z.lazyDecode}}) do
+	collectgarbage("collect")
+	collectgarbage("stop")
+	local memory = collectgarbage("count")
+	now = Proto4zUtil.now()
+	for i = 1, 20000 do
+		assert(decoder[2](echoData, "EchoPack")._sarray[3]._string == "abcdefg")
+	end
+	print(decoder[1] .. " decode and read one member used time=" .. (Proto4zUtil.now() - now) .. ", garbage=" .. math.floor(collectgarbage("count") - memory) .. "KB")
+	collectgarbage("restart")
+end
+
+--decode into the existing tables, same result as a new decode
+for _, sample in ipairs(samples) do
+	local target = {}
+	assert(same(Proto4z.decodeInto(sample[2], sample[1], target), Proto4z.decode(sample[2], sample[1])) and target ~= nil, sample[1])
+	for _, other in ipairs(samples) do
+		if other[1] == sample[1] then
+			local target, pos = Proto4zUtil.decodeInto(other[2], other[1], target)
+			assert(same(target, Proto4z.decode(other[2], other[1])) and pos == #other[2] + 1, other[1])
+		end
+	end
+end
+local target = Proto4z.decode(echoData, "EchoPack")
+local iarray, first = target._iarray, target._iarray[1]
+Proto4z.decodeInto(Proto4z.encode({_iarray={{_int=7}}, _imap={[5]={_int=5}}}, "EchoPack"), "EchoPack", target)
+assert(target._iarray == iarray and target._iarray[1] == first and #iarray == 1 and first._int == 7 and first._i64 == 0)
+assert(target._imap[5]._int == 5 and target._imap[123] == nil and next(target._sarray) == nil)
+target = Proto4z.decode(Proto4z.encode({id=1, name="full", moneyTree={lastTime=1}}, "SparsePack"), "SparsePack")
+Proto4z.decodeInto(sparseData, "SparsePack", target)
+assert(same(target, Proto4z.decode(sparseData, "SparsePack")) and target.name == nil and target.moneyTree == nil)
+local pooled = {1, 2, {3}}
+Proto4zUtil.recycle(pooled)
+assert(next(pooled) == nil and Proto4zUtil.newTable() == pooled and next(Proto4zUtil.newTable()) == nil)
+assert(not pcall(Proto4zUtil.decodeInto, echoData, "EchoPack") and not pcall(Proto4zUtil.decodeInto, string.sub(echoData, 1, -2), "EchoPack", {}))
+print("check decode into success")
 
+target = {}
+for _, decoder in ipairs({{"c", function() Proto4zUtil.decode(echoData, "EchoPack") end}, {"c into", function() Proto4zUtil.decodeInto(echoData, "EchoPack", target) end}}) do
+	collectgarbage("collect")
+	collectgarbage("stop")
+	local memory = collectgarbage("count")
+	now = Proto4zUtil.now()
+	for i = 1, 20000 do
+		decoder[2]()
+	end
+	print(decoder[1] .. " decode used time=" .. (Proto4zUtil.now() - now) .. ", garbage=" .. math.floor(collectgarbage("count") - memory) .. "KB")
+	collectgarbage("restart")
+end
 
+--incremental decode, yield between the steps
+for _, sample in ipairs(samples) do
+	local step, steps, done, result = Proto4z.decodeSteps(sample[2], sample[1], 1), 0
+	repeat
+		done, result = step()
+		steps = steps + 1
+	until done
+	assert(same(result, Proto4z.decode(sample[2], sample[1])) and steps > 1, sample[1])
+end
+do
+	--columnar array yield between the rows
+	local columns = {}
+	for i = 1, 10000 do
+		columns[i] = {_char=i % 100, _short=i, _i64=i * 7}
+	end
+	local columnData = Proto4z.encode(columns, "IntegerDataColumns")
+	local step, steps, done, result = Proto4z.decodeSteps(columnData, "IntegerDataColumns", 4096), 0
+	repeat
+		done, result = step()
+		steps = steps + 1
+	until done
+	assert(steps >= #columnData // 4096 and same(result, Proto4z.decode(columnData, "IntegerDataColumns")))
+end
+local snapshot = {_iarray = {}, _sarray = {}, _imap = {}}
+for i = 1, 50000 do
+	snapshot._iarray[i] = {_char=i % 100, _uchar=i % 200, _short=i, _ushort=i, _int=i * 3, _uint=i * 5, _i64=i * 7, _ui64=i * 11}
+	snapshot._sarray[i] = {_string="snapshot" .. i}
+	if i % 10 == 0 then snapshot._imap[i] = snapshot._iarray[i] end
+end
+local snapshotData = Proto4z.encode(snapshot, "EchoPack")
+local co = coroutine.create(Proto4z.decodeYield)
+local ok, result = coroutine.resume(co, snapshotData, "EchoPack", 4096)
+local steps = 1
+while coroutine.status(co) == "suspended" do
+	ok, result = coroutine.resume(co)
+	steps = steps + 1
+end
+assert(ok and steps >= #snapshotData // 4096 and same(result, Proto4zUtil.decode(snapshotData, "EchoPack")))
+print("check incremental decode success")
 
+now = Proto4zUtil.now()
+Proto4z.decode(snapshotData, "EchoPack")
+print("snapshot size=" .. #snapshotData .. ", lua decode used time=" .. (Proto4zUtil.now() - now))
+now = Proto4zUtil.now()
+Proto4zUtil.decode(snapshotData, "EchoPack")
+print("snapshot c decode used time=" .. (Proto4zUtil.now() - now))
+local step, longest, done = Proto4z.decodeSteps(snapshotData, "EchoPack", 65536), 0
+steps = 0
+now = Proto4zUtil.now()
+repeat
+	local begin = Proto4zUtil.now()
+	done = step()
+	longest = math.max(longest, Proto4zUtil.now() - begin)
+	steps = steps + 1
+until done
+print("snapshot incremental decode used time=" .. (Proto4zUtil.now() - now) .. ", steps=" .. steps .. ", longest step=" .. longest)
 
+--profile counters by protocol name
+local encode, decode = Proto4z.encode, Proto4z.decode
+Proto4zUtil.stats(true)
+Proto4zUtil.profile(true)
+assert(Proto4z.encode ~= encode and Proto4z.decode ~= decode)
+for i = 1, 3 do
+	assert(same(Proto4z.decode(Proto4z.encode(echoDecoded, "EchoPack"), "EchoPack"), echoDecoded))
+end
+local cresult, cpos = Proto4zUtil.decode(echoData, "EchoPack")
+assert(cpos == #echoData + 1 and same(cresult, echoDecoded))
+assert(not pcall(Proto4z.decode, echoData, "NotAProto"))
+Proto4z.encode({}, "MovePack")
+local stats = Proto4zUtil.stats(true)
+assert(stats.EchoPack.encode.count == 3 and stats.EchoPack.encode.bytes == 3 * #echoData and stats.EchoPack.decode.count == 4)
+assert(stats.EchoPack.decode.bytes == 4 * #echoData and stats.EchoPack.decode.time >= stats.EchoPack.decode.maxTime and stats.EchoPack.decode.maxTime > 0)
+assert(stats.MovePack.encode.count == 1 and stats.MovePack.decode == nil and stats.NotAProto == nil and next(Proto4zUtil.stats()) == nil)
+Proto4zUtil.profile(true)
+Proto4zUtil.profile(false)
+assert(Proto4z.encode == encode and Proto4z.decode == decode)
+Proto4z.encode({}, "MovePack")
+assert(next(Proto4zUtil.stats()) == nil)
+print("check profile success")
 
+for _, on in ipairs({false, true}) do
+	Proto4zUtil.profile(on)
+	collectgarbage("collect")
+	now = Proto4zUtil.now()
+	for i = 1, 20000 do
+		Proto4zUtil.decode(echoData, "EchoPack")
+	end
+	print("c decode with profile " .. (on and "on" or "off") .. " used time=" .. (Proto4zUtil.now() - now))
+end
+Proto4zUtil.profile(false)
+for name, stat in pairs(Proto4zUtil.stats(true)) do
+	print(name .. " decode count=" .. stat.decode.count .. ", bytes=" .. stat.decode.bytes .. ", time=" .. string.format("%.3f", stat.decode.time) .. "ms, max=" .. string.format("%.3f", stat.decode.maxTime) .. "ms")
+end
 
+--type code fast path, same bytes and values as the type name path
+local codeI64, codeUI64, codeString = Proto4zUtil.typeCode("i64"), Proto4zUtil.typeCode("ui64"), Proto4zUtil.typeCode("string")
+assert(codeI64 and codeUI64 and codeString and Proto4zUtil.typeCode("EchoPack") == nil and Proto4zUtil.typeCode("nothing") == nil)
+for _, tp in ipairs({"i8", "ui8", "i16", "ui16", "i32", "ui32", "i64", "ui64", "float", "double", "string"}) do
+	local code = Proto4zUtil.typeCode(tp)
+	for _, v in ipairs({0, 1, -1, 127, 255, 0x7fffffff, math.maxinteger, math.mininteger, 0.5, "abc", ""}) do
+		if (tp == "string") == (type(v) == "string") and (math.type(v) ~= "float" or tp == "float" or tp == "double") then
+			local bin = tp == "string" and Proto4zUtil.pack(#v, "ui32") .. v or Proto4zUtil.pack(v, tp)
+			assert(Proto4zUtil.packCode(v, code) == bin, tp)
+			local a, pa = Proto4zUtil.unpack(bin, 1, tp)
+			local b, pb = Proto4zUtil.unpackCode(bin, 1, code)
+			assert(a == b and math.type(a) == math.type(b) and pa == pb and pb == #bin + 1, tp)
+		end
+	end
+end
+assert(Proto4zUtil.unpackCode(Proto4zUtil.pack(math.mininteger, "i64"), 1, codeI64) == math.mininteger)
+assert(Proto4zUtil.unpackCode(Proto4zUtil.pack(-1, "ui64"), 1, codeUI64) == -1)
+assert(Proto4zUtil.packCode(nil, codeString) == Proto4zUtil.pack(0, "ui32"))
+local packOk, packErr = pcall(Proto4zUtil.packCode, 0.5, Proto4zUtil.typeCode("i32"))
+assert(not packOk and string.find(packErr, "integer expected", 1, true))
+local oldPrint, packWarning = print, nil
+print = function(s) packWarning = s end
+assert(Proto4zUtil.packCode(nil, codeI64, "EchoPack") == Proto4zUtil.pack(0, "i64"))
+print = oldPrint
+assert(packWarning and string.find(packWarning, "[EchoPack].[i64]", 1, true))
+local pairBin = Proto4zUtil.pack(3, "ui32") .. "key" .. Proto4zUtil.pack(math.maxinteger, "i64")
+local pk, pv, pp = Proto4zUtil.unpackPair(pairBin, 1, codeString, codeI64)
+assert(pk == "key" and pv == math.maxinteger and pp == #pairBin + 1)
+pk, pv, pp = Proto4zUtil.unpackPair(Proto4zUtil.pack(-2, "i64") .. pairBin, 1, codeI64, codeString)
+assert(pk == -2 and pv == "key" and pp == 16)
+assert(not pcall(Proto4zUtil.unpackCode, pairBin, 1, 99) and not pcall(Proto4zUtil.packCode, 1, -1))
+assert(not pcall(Proto4zUtil.unpackCode, pairBin, #pairBin - 2, codeI64) and not pcall(Proto4zUtil.unpackCode, pairBin, 0, codeI64))
+print("check type code success")
 
+local ui64Bin = string.rep(Proto4zUtil.pack(math.maxinteger, "ui64"), 2)
+now = Proto4zUtil.now()
+for i = 1, 1000000 do
+	local k, p = Proto4zUtil.unpack(ui64Bin, 1, "ui64")
+	local v = Proto4zUtil.unpack(ui64Bin, p, "ui64")
+end
+print("type name unpack key and value used time=" .. (Proto4zUtil.now() - now))
+now = Proto4zUtil.now()
+for i = 1, 1000000 do
+	local k, v = Proto4zUtil.unpackPair(ui64Bin, 1, codeUI64, codeUI64)
+end
+print("type code unpack pair used time=" .. (Proto4zUtil.now() - now))
@@ -1,10 +1,15 @@
 ﻿//! yawei_zhang@foxmail.com
 
+#include "lua.hpp"
 #include <proto4z.h>
 
 #include <iostream>
 #include <time.h>
 #include <stdio.h>
+#include <functional>
+#include <random>
+#include <chrono>
+#include <thread>
 
 #ifdef WIN32
 #include <windows.h>
@@ -21,6 +26,47 @@ using namespace zsummer::proto4z;
 
 #include "C++/TestProto.h"
 #include "TestHTTP.h"
+#include "log4z.h"
+#include "C++/TestLog4z.h"
+
+//count the heap allocation of the object pool benchmark.
+//every form is replaced, delete is kept out of line, gcc warns on free() of a new pointer once it is inlined into a delete expression.
+#ifdef __GNUC__
+#define ALLOC_NOINLINE __attribute__((noinline))
+#else
+#define ALLOC_NOINLINE
+#endif
+static unsigned long long g_allocCount = 0;
+ALLOC_NOINLINE void * operator new(size_t size)
+{
+    g_allocCount++;
+    void * p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+ALLOC_NOINLINE void * operator new[](size_t size)
+{
+    return operator new(size);
+}
+ALLOC_NOINLINE void operator delete(void * p) noexcept
+{
+    free(p);
+}
+ALLOC_NOINLINE void operator delete[](void * p) noexcept
+{
+    operator delete(p);
+}
+ALLOC_NOINLINE void operator delete(void * p, size_t) noexcept
+{
+    operator delete(p);
+}
+ALLOC_NOINLINE void operator delete[](void * p, size_t) noexcept
+{
+    operator delete(p);
+}
 
 void  fillOnePack(EchoPack &pack)
 {
@@ -60,6 +106,541 @@ void  fillOnePack(EchoPack &pack)
 
 unsigned int getSteadyTime();
 
+extern "C" int luaopen_proto4z_util(lua_State *L);
+
+//c++ -> lua table -> Proto4z.encode -> Proto4z.decode -> lua table -> c++
+template<class T>
+void luaRoundTrip(lua_State * L, const T & in, T & out)
+{
+    lua_getglobal(L, "Proto4z");
+    lua_getfield(L, -1, "decode");
+    lua_getfield(L, -2, "encode");
+    pushLua(L, in);
+    lua_pushstring(L, T::getProtoName().c_str());
+    if (lua_pcall(L, 2, 1, 0) != LUA_OK)
+    {
+        PROTO4Z_THROW("Proto4z.encode error: " << lua_tostring(L, -1));
+    }
+    lua_pushstring(L, T::getProtoName().c_str());
+    if (lua_pcall(L, 2, 1, 0) != LUA_OK)
+    {
+        PROTO4Z_THROW("Proto4z.decode error: " << lua_tostring(L, -1));
+    }
+    readLua(L, -1, out);
+    lua_pop(L, 2);
+}
+
+//dispatch benchmark, the same packets registered in the table dispatcher and in a std::map of std::function.
+struct DispatchBench
+{
+    TestProtoDispatcher dispatcher;
+    std::map<unsigned short, std::function<void(ReadStream &)>> handlers;
+    std::vector<std::string> traffic;
+    unsigned long long count = 0;
+};
+
+//traffic: false only register it, the container packets decode slow and hide the lookup time.
+template<class Packet>
+void addDispatchBench(DispatchBench & bench, bool traffic)
+{
+    unsigned long long & count = bench.count;
+    bench.dispatcher.registerHandler<Packet>([&count](Packet &){ count++; });
+    bench.handlers[Packet::getProtoID()] = [&count](ReadStream & rs){ Packet packet; rs >> packet; count++; };
+    if (traffic)
+    {
+        WriteStream ws(Packet::getProtoID());
+        ws << Packet();
+        bench.traffic.push_back(std::string(ws.getStream(), ws.getStreamLen()));
+    }
+}
+
+//microseconds, the millisecond getSteadyTime is too coarse for the short benchmark.
+inline long long benchNow()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template<class T>
+std::string encodeBody(const T & data)
+{
+    WriteStream ws(0);
+    ws << data;
+    return std::string(ws.getStreamBody(), ws.getStreamBodyLen());
+}
+
+template<class T>
+void decodeBody(const std::string & body, T & data)
+{
+    ReadStream rs(body.c_str(), (Integer)body.length(), false);
+    rs >> data;
+}
+
+//random corpus for the cross language conformance check, walk the generated forEachMember.
+//the member xml type bound the value, bits:N is masked and the quantized float is around the range.
+typedef std::mt19937_64 CorpusRandom;
+inline void randomValue(CorpusRandom & rnd, bool & t, const char * type);
+template<class T>
+inline typename std::enable_if<std::is_integral<T>::value>::type randomValue(CorpusRandom & rnd, T & t, const char * type);
+template<class T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type randomValue(CorpusRandom & rnd, T & t, const char * type);
+inline void randomValue(CorpusRandom & rnd, std::string & t, const char * type);
+template<unsigned int Capacity>
+inline void randomValue(CorpusRandom & rnd, FixedString<Capacity> & t, const char * type);
+template<class Value, class Alloc>
+inline void randomValue(CorpusRandom & rnd, std::vector<Value, Alloc> & t, const char * type);
+template<class Value, unsigned int Capacity>
+inline void randomValue(CorpusRandom & rnd, FixedVector<Value, Capacity> & t, const char * type);
+template<class Map>
+inline auto randomValue(CorpusRandom & rnd, Map & t, const char * type) -> decltype(typename Map::mapped_type(), void());
+template<class Packet>
+inline auto randomValue(CorpusRandom & rnd, Packet & t, const char * type) -> decltype(Packet::getMemberCount(), void());
+
+inline void randomValue(CorpusRandom & rnd, bool & t, const char * type)
+{
+    t = (rnd() & 1) != 0;
+}
+
+template<class T>
+inline typename std::enable_if<std::is_integral<T>::value>::type randomValue(CorpusRandom & rnd, T & t, const char * type)
+{
+    unsigned long long v = rnd();
+    if (strncmp(type, "bits:", 5) == 0)
+    {
+        v &= (1ULL << atoi(type + 5)) - 1;
+    }
+    t = (T)v;
+}
+
+template<class T>
+inline typename std::enable_if<std::is_floating_point<T>::value>::type randomValue(CorpusRandom & rnd, T & t, const char * type)
+{
+    double scale = pow(10.0, (double)(rnd() % 8));
+    if (strncmp(type, "fixed", 5) == 0)
+    {
+        scale = strtod(strchr(type, '(') + 1, nullptr) * 1.2;
+    }
+    else if (strncmp(type, "angle", 5) == 0)
+    {
+        scale = 720.0;
+    }
+    t = (T)(std::uniform_real_distribution<double>(-1.0, 1.0)(rnd) * scale);
+}
+
+inline void randomValue(CorpusRandom & rnd, std::string & t, const char * type)
+{
+    t.resize(rnd() % 24);
+    for (auto & ch : t)
+    {
+        ch = (char)rnd();
+    }
+}
+
+template<unsigned int Capacity>
+inline void randomValue(CorpusRandom & rnd, FixedString<Capacity> & t, const char * type)
+{
+    std::string str;
+    randomValue(rnd, str, type);
+    str.resize(std::min<size_t>(str.length(), Capacity));
+    t = str;
+}
+
+template<class Value, class Alloc>
+inline void randomValue(CorpusRandom & rnd, std::vector<Value, Alloc> & t, const char * type)
+{
+    t.resize(rnd() % 5);
+    for (auto & v : t)
+    {
+        randomValue(rnd, v, "");
+    }
+}
+
+template<class Value, unsigned int Capacity>
+inline void randomValue(CorpusRandom & rnd, FixedVector<Value, Capacity> & t, const char * type)
+{
+    t.resize(rnd() % (Capacity + 1));
+    for (auto & v : t)
+    {
+        randomValue(rnd, v, "");
+    }
+}
+
+template<class Map>
+inline auto randomValue(CorpusRandom & rnd, Map & t, const char * type) -> decltype(typename Map::mapped_type(), void())
+{
+    size_t count = rnd() % 5;
+    for (size_t i = 0; i < count; i++)
+    {
+        typename Map::key_type k;
+        typename Map::mapped_type v;
+        randomValue(rnd, k, "");
+        randomValue(rnd, v, "");
+        t.emplace(k, v);
+    }
+}
+
+template<class Packet>
+struct RandomMember
+{
+    CorpusRandom & rnd;
+    Packet & data;
+    template<class M>
+    inline void operator()(const M & m) const { randomValue(rnd, m.get(data), m.type); }
+};
+
+template<class Packet>
+inline auto randomTag(CorpusRandom & rnd, Packet & t, int) -> decltype(t.__tag, void())
+{
+    t.__tag = rnd() & ((1ULL << Packet::getMemberCount()) - 1);
+}
+
+template<class Packet>
+inline void randomTag(CorpusRandom & rnd, Packet & t, long)
+{
+}
+
+template<class Packet>
+inline auto randomValue(CorpusRandom & rnd, Packet & t, const char * type) -> decltype(Packet::getMemberCount(), void())
+{
+    Packet::forEachMember(RandomMember<Packet>{ rnd, t });
+    randomTag(rnd, t, 0);
+}
+
+//compare by value, only used when the wire order of a map is not defined.
+//a map with more than one entry clear lua, the lua encoders walk every map in the hash order of the lua table.
+//a hash map with more than one entry also clear cpp, the c++ encode keep the order of std::map and FlatMap only.
+struct WireOrder
+{
+    bool cpp = true;
+    bool lua = true;
+};
+template<class T>
+inline typename std::enable_if<std::is_arithmetic<T>::value, bool>::type sameValue(const T & a, const T & b, WireOrder & order);
+inline bool sameValue(const std::string & a, const std::string & b, WireOrder & order);
+template<unsigned int Capacity>
+inline bool sameValue(const FixedString<Capacity> & a, const FixedString<Capacity> & b, WireOrder & order);
+template<class Value, class Alloc>
+inline bool sameValue(const std::vector<Value, Alloc> & a, const std::vector<Value, Alloc> & b, WireOrder & order);
+template<class Value, unsigned int Capacity>
+inline bool sameValue(const FixedVector<Value, Capacity> & a, const FixedVector<Value, Capacity> & b, WireOrder & order);
+template<class Key, class Value, class Hash, class Equal, class Alloc>
+inline bool sameValue(const std::unordered_map<Key, Value, Hash, Equal, Alloc> & a, const std::unordered_map<Key, Value, Hash, Equal, Alloc> & b, WireOrder & order);
+template<class Map>
+inline auto sameValue(const Map & a, const Map & b, WireOrder & order) -> decltype(typename Map::mapped_type(), bool());
+template<class Packet>
+inline auto sameValue(const Packet & a, const Packet & b, WireOrder & order) -> decltype(Packet::getMemberCount(), bool());
+
+template<class T>
+inline typename std::enable_if<std::is_arithmetic<T>::value, bool>::type sameValue(const T & a, const T & b, WireOrder & order)
+{
+    return a == b;
+}
+
+inline bool sameValue(const std::string & a, const std::string & b, WireOrder & order)
+{
+    return a == b;
+}
+
+template<unsigned int Capacity>
+inline bool sameValue(const FixedString<Capacity> & a, const FixedString<Capacity> & b, WireOrder & order)
+{
+    return a == b;
+}
+
+template<class Sequence>
+inline bool sameSequence(const Sequence & a, const Sequence & b, WireOrder & order)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    bool same = true;
+    for (Integer i = 0; i < (Integer)a.size(); i++)
+    {
+        same = sameValue(a[i], b[i], order) && same;
+    }
+    return same;
+}
+
+template<class Value, class Alloc>
+inline bool sameValue(const std::vector<Value, Alloc> & a, const std::vector<Value, Alloc> & b, WireOrder & order)
+{
+    return sameSequence(a, b, order);
+}
+
+template<class Value, unsigned int Capacity>
+inline bool sameValue(const FixedVector<Value, Capacity> & a, const FixedVector<Value, Capacity> & b, WireOrder & order)
+{
+    return sameSequence(a, b, order);
+}
+
+template<class Map>
+inline bool sameMap(const Map & a, const Map & b, WireOrder & order)
+{
+    if (a.size() != b.size())
+    {
+        return false;
+    }
+    order.lua = order.lua && a.size() < 2;
+    bool same = true;
+    for (const auto & kv : a)
+    {
+        auto iter = b.find(kv.first);
+        same = iter != b.end() && sameValue(kv.second, iter->second, order) && same;
+    }
+    return same;
+}
+
+template<class Key, class Value, class Hash, class Equal, class Alloc>
+inline bool sameValue(const std::unordered_map<Key, Value, Hash, Equal, Alloc> & a, const std::unordered_map<Key, Value, Hash, Equal, Alloc> & b, WireOrder & order)
+{
+    order.cpp = order.cpp && a.size() < 2;
+    return sameMap(a, b, order);
+}
+
+template<class Map>
+inline auto sameValue(const Map & a, const Map & b, WireOrder & order) -> decltype(typename Map::mapped_type(), bool())
+{
+    return sameMap(a, b, order);
+}
+
+template<class Packet>
+struct SameMember
+{
+    const Packet & a;
+    const Packet & b;
+    WireOrder & order;
+    bool & same;
+    template<class M>
+    inline void operator()(const M & m) const { same = sameValue(m.get(a), m.get(b), order) && same; }
+};
+
+template<class Packet>
+inline auto sameTag(const Packet & a, const Packet & b, int) -> decltype(a.__tag, bool())
+{
+    return a.__tag == b.__tag;
+}
+
+template<class Packet>
+inline bool sameTag(const Packet & a, const Packet & b, long)
+{
+    return true;
+}
+
+template<class Packet>
+inline auto sameValue(const Packet & a, const Packet & b, WireOrder & order) -> decltype(Packet::getMemberCount(), bool())
+{
+    bool same = sameTag(a, b, 0);
+    Packet::forEachMember(SameMember<Packet>{ a, b, order, same });
+    return same;
+}
+
+//the same wire: byte exact by the c++ encode, or by value when a hash map make the order undefined.
+template<class T>
+bool sameWire(const T & a, const T & b)
+{
+    WireOrder order;
+    bool same = sameValue(a, b, order);
+    return order.cpp ? encodeBody(a) == encodeBody(b) : same;
+}
+
+//the body of a lua encoder: byte exact with the c++ body. with maps in lua order, the same length and value,
+//and byte exact again once the c++ encode put the std::map and FlatMap back in order.
+template<class T>
+bool sameBody(const std::string & body, const std::string & expect, const T & out, const T & in)
+{
+    WireOrder order;
+    bool same = sameValue(out, in, order);
+    if (order.lua)
+    {
+        return body == expect;
+    }
+    return same && body.length() == expect.length() && (!order.cpp || encodeBody(out) == expect);
+}
+
+//call module.decode(body, name), read the result into out.
+template<class T>
+void luaDecode(lua_State * L, const char * module, const std::string & body, T & out)
+{
+    lua_getglobal(L, module);
+    lua_getfield(L, -1, "decode");
+    lua_pushlstring(L, body.c_str(), body.length());
+    lua_pushstring(L, T::getProtoName().c_str());
+    if (lua_pcall(L, 2, 1, 0) != LUA_OK)
+    {
+        PROTO4Z_THROW(module << ".decode error: " << lua_tostring(L, -1));
+    }
+    out = T();
+    readLua(L, -1, out);
+    lua_pop(L, 2);
+}
+
+//call module.encode(in, name), return the body.
+template<class T>
+std::string luaEncode(lua_State * L, const char * module, const T & in)
+{
+    lua_getglobal(L, module);
+    lua_getfield(L, -1, "encode");
+    pushLua(L, in);
+    lua_pushstring(L, T::getProtoName().c_str());
+    if (lua_pcall(L, 2, 1, 0) != LUA_OK)
+    {
+        PROTO4Z_THROW(module << ".encode error: " << lua_tostring(L, -1));
+    }
+    size_t len = 0;
+    const char * body = lua_tolstring(L, -1, &len);
+    std::string result(body, len);
+    lua_pop(L, 2);
+    return result;
+}
+
+//throughput of every codec over the corpus, time in microseconds.
+//lua is the descriptor interpreter of proto4z.lua, lua codec is the string.pack codec generated in TestProto.lua.
+enum ConformanceCodec
+{
+    CC_CPP,
+    CC_LUA,
+    CC_LUA_CODEC,
+    CC_LUA_C,
+    CC_MAX,
+};
+static const char * ConformanceCodecName[CC_MAX] = { "c++", "lua", "lua codec", "lua c" };
+static const char * ConformanceLuaModule[CC_MAX] = { "", "Proto4z", "Proto4z", "Proto4zUtil" };
+
+//proto4z.lua prefer the generated codec, stash it to run the interpreter. same as useCodec of main.lua.
+inline void luaUseCodec(lua_State * L, bool on)
+{
+    lua_getglobal(L, "useProto4zCodec");
+    lua_pushboolean(L, on);
+    lua_call(L, 1, 0);
+}
+struct ConformanceStat
+{
+    unsigned long long bytes = 0;
+    long long encodeTime[CC_MAX] = {};
+    long long decodeTime[CC_MAX] = {};
+};
+
+//bytes per microsecond is MB/s.
+inline double conformanceSpeed(unsigned long long bytes, long long time)
+{
+    return bytes / (double)std::max(time, 1LL);
+}
+
+//a random corpus of one packet. c++ encode -> lua decode and lua encode -> c++ decode keep the same wire, then measure each codec.
+template<class T>
+int checkConformance(lua_State * L, CorpusRandom & rnd, int samples, int rounds, ConformanceStat & total)
+{
+    std::vector<T> corpus(samples);
+    std::vector<std::string> bodies(samples);
+    for (int i = 0; i < samples; i++)
+    {
+        T origin;
+        randomValue(rnd, origin, "");
+        //one c++ round trip snap the value to the wire, bits masked and float quantized.
+        decodeBody(encodeBody(origin), corpus[i]);
+        bodies[i] = encodeBody(corpus[i]);
+    }
+
+    int errors = 0;
+    for (int codec = CC_LUA; codec < CC_MAX; codec++)
+    {
+        luaUseCodec(L, codec != CC_LUA);
+        for (int i = 0; i < samples; i++)
+        {
+            T out;
+            luaDecode(L, ConformanceLuaModule[codec], bodies[i], out);
+            if (!sameWire(out, corpus[i]))
+            {
+                errors++;
+                cout << "error: conformance " << T::getProtoName() << " c++ encode -> " << ConformanceCodecName[codec] << " decode, sample=" << i << endl;
+            }
+            std::string body = luaEncode(L, ConformanceLuaModule[codec], corpus[i]);
+            out = T();
+            decodeBody(body, out);
+            if (!sameBody(body, bodies[i], out, corpus[i]))
+            {
+                errors++;
+                cout << "error: conformance " << T::getProtoName() << " " << ConformanceCodecName[codec] << " encode -> c++ decode, sample=" << i << endl;
+            }
+        }
+    }
+
+    ConformanceStat stat;
+    for (const auto & body : bodies)
+    {
+        stat.bytes += body.length() * rounds;
+    }
+    long long now = benchNow();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (const auto & data : corpus)
+        {
+            WriteStream ws(T::getProtoID());
+            ws << data;
+        }
+    }
+    stat.encodeTime[CC_CPP] = benchNow() - now;
+    now = benchNow();
+    for (int r = 0; r < rounds; r++)
+    {
+        for (const auto & body : bodies)
+        {
+            T out;
+            decodeBody(body, out);
+        }
+    }
+    stat.decodeTime[CC_CPP] = benchNow() - now;
+
+    //the lua objects and bodies stay on the stack, the loop only call the codec.
+    int top = lua_gettop(L);
+    lua_createtable(L, samples, 0);
+    lua_createtable(L, samples, 0);
+    for (int i = 0; i < samples; i++)
+    {
+        pushLua(L, corpus[i]);
+        lua_rawseti(L, top + 1, i + 1);
+        lua_pushlstring(L, bodies[i].c_str(), bodies[i].length());
+        lua_rawseti(L, top + 2, i + 1);
+    }
+    for (int codec = CC_LUA; codec < CC_MAX; codec++)
+    {
+        luaUseCodec(L, codec != CC_LUA);
+        lua_getglobal(L, ConformanceLuaModule[codec]);
+        for (int encode = 0; encode < 2; encode++)
+        {
+            lua_getfield(L, top + 3, encode ? "encode" : "decode");
+            now = benchNow();
+            for (int r = 0; r < rounds; r++)
+            {
+                for (int i = 0; i < samples; i++)
+                {
+                    lua_pushvalue(L, top + 4);
+                    lua_rawgeti(L, encode ? top + 1 : top + 2, i + 1);
+                    lua_pushstring(L, T::getProtoName().c_str());
+                    lua_call(L, 2, 1);
+                    lua_pop(L, 1);
+                }
+            }
+            (encode ? stat.encodeTime : stat.decodeTime)[codec] = benchNow() - now;
+            lua_pop(L, 1);
+        }
+        lua_pop(L, 1);
+    }
+    lua_settop(L, top);
+
+    cout << T::getProtoName() << " samples=" << samples << ", errors=" << errors << ", bytes=" << stat.bytes;
+    total.bytes += stat.bytes;
+    for (int codec = 0; codec < CC_MAX; codec++)
+    {
+        cout << ", " << ConformanceCodecName[codec] << " encode=" << conformanceSpeed(stat.bytes, stat.encodeTime[codec])
+            << "MB/s decode=" << conformanceSpeed(stat.bytes, stat.decodeTime[codec]) << "MB/s";
+        total.encodeTime[codec] += stat.encodeTime[codec];
+        total.decodeTime[codec] += stat.decodeTime[codec];
+    }
+    cout << endl;
+    return errors;
+}
+
 
 
 int main()
@@ -170,6 +751,1154 @@ int main()
     }
     std::cout << "write and read stream used time: " << getSteadyTime() - now << std::endl;
 
+    cout << "check reflection proto" << endl;
+    try
+    {
+        EchoPack echo;
+        fillOnePack(echo);
+        WriteStream ws(EchoPack::getProtoID());
+        ws << echo;
+        WriteStream wsReflect(EchoPack::getProtoID());
+        reflectWrite(wsReflect, echo);
+        if (ws.getStreamLen() != wsReflect.getStreamLen() || memcmp(ws.getStream(), wsReflect.getStream(), ws.getStreamLen()) != 0)
+        {
+            cout << "error: reflectWrite stream not equal generated stream." << endl;
+        }
+        EchoPack echoReflect;
+        ReadStream rs(wsReflect.getStream(), wsReflect.getStreamLen());
+        reflectRead(rs, echoReflect);
+        if (echoReflect._smap.size() != echo._smap.size() || EchoPack::getMemberCount() != 6)
+        {
+            cout << "error: reflectRead result not equal." << endl;
+        }
+        cout << "success" << endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+
+    cout << "check fixed wire proto" << endl;
+    try
+    {
+        EchoPack echo;
+        fillOnePack(echo);
+        static_assert(IsFixedWire<IntegerData>::value && IsFixedWire<MoneyTree>::value && !IsFixedWire<SimplePack>::value, "fixed wire detect error");
+        WriteStream ws(IntegerData::getProtoID());
+        ws << echo._iarray.front();
+        WriteStream wsReflect(IntegerData::getProtoID());
+        reflectWrite(wsReflect, echo._iarray.front());
+        if (ws.getStreamBodyLen() != IntegerData::FixedWireSize || ws.getStreamLen() != wsReflect.getStreamLen()
+            || memcmp(ws.getStream(), wsReflect.getStream(), ws.getStreamLen()) != 0)
+        {
+            cout << "error: fixed wire stream not equal member stream." << endl;
+        }
+        WriteStream wsArray(EchoPack::getProtoID());
+        wsArray << echo._iarray;
+        IntegerDataArray iarray;
+        ReadStream rs(wsArray.getStream(), wsArray.getStreamLen());
+        rs >> iarray;
+        if (iarray.size() != 2 || iarray.back()._ui64 != 700 || iarray.back()._char != 'a')
+        {
+            cout << "error: fixed wire array decode error." << endl;
+        }
+        cout << "success" << endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+
+    now = getSteadyTime();
+    for (int i = 0; i < StressCount; i++)
+    {
+        WriteStream ws(100);
+        reflectWrite(ws, pack);
+        count += ws.getStreamLen();
+    }
+    std::cout << "reflect writeStream used time: " << getSteadyTime() - now << std::endl;
+
+    now = getSteadyTime();
+    for (int i = 0; i < StressCount; i++)
+    {
+        WriteStream ws(100);
+        reflectWrite(ws, pack);
+        ReadStream rs(ws.getStream(), ws.getStreamLen());
+        reflectRead(rs, pack);
+        count += rs.getStreamLen();
+    }
+    std::cout << "reflect write and read stream used time: " << getSteadyTime() - now << std::endl;
+
+    cout << "check dispatch proto" << endl;
+    try
+    {
+        TestProtoDispatcher dispatcher;
+        unsigned int echoCount = 0;
+        unsigned int simpleCount = 0;
+        dispatcher.registerHandler<EchoPack>([&echoCount](EchoPack & echo){ echoCount += (unsigned int)echo._smap.size(); });
+        dispatcher.registerHandler<SimplePack>([&simpleCount](SimplePack & simple){ simpleCount += simple.id; });
+        EchoPack echo;
+        fillOnePack(echo);
+        WriteStream wsEcho(EchoPack::getProtoID());
+        wsEcho << echo;
+        ReadStream rsEcho(wsEcho.getStream(), wsEcho.getStreamLen());
+        WriteStream wsSimple(SimplePack::getProtoID());
+        wsSimple << pack;
+        ReadStream rsSimple(wsSimple.getStream(), wsSimple.getStreamLen());
+        WriteStream wsUnknown(1);
+        ReadStream rsUnknown(wsUnknown.getStream(), wsUnknown.getStreamLen());
+        WriteStream wsFloat(FloatData::getProtoID());
+        wsFloat << FloatData();
+        ReadStream rsFloat(wsFloat.getStream(), wsFloat.getStreamLen());
+        if (!dispatcher.dispatch(rsEcho) || !dispatcher.dispatch(rsSimple) || dispatcher.dispatch(rsUnknown) || dispatcher.dispatch(rsFloat)
+            || echoCount != 2 || simpleCount != 10)
+        {
+            cout << "error: dispatch result error." << endl;
+        }
+        dispatcher.unregisterHandler(SimplePack::getProtoID());
+        ReadStream rsSimpleAgain(wsSimple.getStream(), wsSimple.getStreamLen());
+        if (dispatcher.dispatch(rsSimpleAgain))
+        {
+            cout << "error: unregisterHandler not work." << endl;
+        }
+        for (unsigned short id = TestProtoProtoIndex::MinProtoID; id <= TestProtoProtoIndex::MaxProtoID; id++)
+        {
+            const char * name = TestProtoProtoIndex::getProtoName(id);
+            if (name == nullptr || TestProtoProtoIndex::getProtoID(name, strlen(name)) != id)
+            {
+                cout << "error: proto name index error. protoID=" << id << endl;
+            }
+        }
+        if (TestProtoProtoIndex::getProtoID("EchoPac", 7) != InvalidProtoID || TestProtoProtoIndex::getProtoID("", 0) != InvalidProtoID
+            || TestProtoProtoIndex::getProtoName(1) != nullptr)
+        {
+            cout << "error: proto name index unknown name error." << endl;
+        }
+        cout << "success" << endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+
+    cout << "check tagged proto" << endl;
+    try
+    {
+        SparsePack full;
+        full.id = 100;
+        full.name = "sparse";
+        full.iarray.push_back(IntegerData());
+        full.value = 3.5;
+        SparsePack sparse = full;
+        sparse.clearTag().setTag(1).setTag(5);
+        WriteStream wsFull(SparsePack::getProtoID());
+        wsFull << full;
+        WriteStream wsSparse(SparsePack::getProtoID());
+        wsSparse << sparse;
+        if (wsSparse.getStreamBodyLen() != sizeof(Integer) + sizeof(ProtoTag) + sizeof(sparse.id) + sizeof(sparse.value)
+            || wsSparse.getStreamBodyLen() * 2 > wsFull.getStreamBodyLen())
+        {
+            cout << "error: tagged stream length error." << endl;
+        }
+        SparsePack result;
+        ReadStream rs(wsSparse.getStream(), wsSparse.getStreamLen());
+        rs >> result;
+        if (result.id != 100 || result.value != 3.5 || !result.name.empty() || result.testTag(2) || !result.testTag(5) || rs.getStreamUnreadLen() != 0)
+        {
+            cout << "error: tagged decode error." << endl;
+        }
+
+        //the member appended by new version be skipped by old version.
+        SparsePackNext next;
+        next.id = 200;
+        next.name = "next";
+        next.extra = 300;
+        next.unsetTag(3);
+        WriteStream wsNext(SparsePackNext::getProtoID());
+        wsNext << next << full;
+        ReadStream rsNext(wsNext.getStream(), wsNext.getStreamLen());
+        rsNext >> result >> sparse;
+        if (result.id != 200 || result.name != "next" || result.testTag(3) || sparse.iarray.size() != 1 || rsNext.getStreamUnreadLen() != 0)
+        {
+            cout << "error: tagged skip unknown member error." << endl;
+        }
+        cout << "success" << endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+
+    cout << "check columnar proto" << endl;
+    try
+    {
+        IntegerDataColumns icolumns;
+        StringDataColumns scolumns;
+        for (int i = 0; i < 1000; i++)
+        {
+            IntegerData idata;
+            idata._char = (char)i;
+            idata._short = (short)i;
+            idata._i64 = i * 1000000000LL;
+            idata._ui64 = i;
+            icolumns.push_back(idata);
+            StringData sdata;
+            sdata._string = std::string(i % 7, 'a' + i % 26);
+            scolumns.push_back(sdata);
+        }
+        WriteStream ws(EchoPack::getProtoID());
+        ws << icolumns << scolumns;
+        ReadStream rs(ws.getStream(), ws.getStreamLen());
+        IntegerDataColumns iresult;
+        StringDataColumns sresult;
+        rs >> iresult >> sresult;
+        if (iresult.size() != icolumns.size() || sresult.size() != scolumns.size() || rs.getStreamUnreadLen() != 0)
+        {
+            cout << "error: columnar decode count error." << endl;
+        }
+        for (size_t i = 0; i < iresult.size() && i < sresult.size(); i++)
+        {
+            if (iresult[i]._char != icolumns[i]._char || iresult[i]._short != icolumns[i]._short || iresult[i]._i64 != icolumns[i]._i64
+                || iresult[i]._ui64 != icolumns[i]._ui64 || sresult[i]._string != scolumns[i]._string)
+            {
+                cout << "error: columnar decode value error. index=" << i << endl;
+                break;
+            }
+        }
+        WriteStream wsRow(EchoPack::getProtoID());
+        wsRow << IntegerDataArray(icolumns.begin(), icolumns.end());
+        WriteStream wsColumn(EchoPack::getProtoID());
+        wsColumn << icolumns;
+        if (wsColumn.getStreamBodyLen() != wsRow.getStreamBodyLen() || wsColumn.getStreamBodyLen() != sizeof(Integer) + 1000 * IntegerData::FixedWireSize)
+        {
+            cout << "error: columnar length error." << endl;
+        }
+
+        //columnar decode fill every row in one pass, expected close to the row array.
+        now = getSteadyTime();
+        for (int i = 0; i < StressCount / 1000; i++)
+        {
+            ReadStream rsRow(wsRow.getStream(), wsRow.getStreamLen());
+            IntegerDataArray rows;
+            rsRow >> rows;
+            count += rows.size();
+        }
+        std::cout << "row array decode used time: " << getSteadyTime() - now << std::endl;
+        now = getSteadyTime();
+        for (int i = 0; i < StressCount / 1000; i++)
+        {
+            ReadStream rsColumn(wsColumn.getStream(), wsColumn.getStreamLen());
+            IntegerDataColumns columns;
+            rsColumn >> columns;
+            count += columns.size();
+        }
+        std::cout << "columnar array decode used time: " << getSteadyTime() - now << std::endl;
+        cout << "success" << endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+
+    cout << "check move proto" << endl;
+    try
+    {
+        static_assert(std::is_nothrow_move_constructible<EchoPack>::value && std::is_nothrow_move_assignable<SimplePack>::value, "move not noexcept");
+        EchoPack echo;
+        echo.emplaceIarray('a', 100, 200, 300, 400, 500, 600, 700);
+        echo.emplaceSmap("key", std::string("value"));
+        StringData & sdata = echo.emplaceSarray();
+        sdata._string = "abc";
+        IntegerDataArray iarray(echo._iarray);
+        const char * iarrayData = (const char *)iarray.data();
+        EchoPack moved(std::move(iarray), FloatDataArray(), StringDataArray(echo._sarray), IntegerDataMap(), FloatDataMap(), StringDataMap(echo._smap));
+        if ((const char *)moved._iarray.data() != iarrayData || moved._iarray.back()._ui64 != 700
+            || moved._smap["key"]._string != "value" || moved._sarray.back()._string != "abc")
+        {
+            cout << "error: move construct error." << endl;
+        }
+        cout << "success" << endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+
+    {
+        EchoPack echo;
+        fillOnePack(echo);
+        now = getSteadyTime();
+        for (int i = 0; i < StressCount / 10; i++)
+        {
+            IntegerDataArray iarray(echo._iarray);
+            StringDataMap smap(echo._smap);
+            EchoPack copied(iarray, FloatDataArray(), StringDataArray(), IntegerDataMap(), FloatDataMap(), smap);
+            count += copied._iarray.size();
+        }
+        std::cout << "construct EchoPack by copy used time: " << getSteadyTime() - now << std::endl;
+        now = getSteadyTime();
+        for (int i = 0; i < StressCount / 10; i++)
+        {
+            IntegerDataArray iarray(echo._iarray);
+            StringDataMap smap(echo._smap);
+            EchoPack moved(std::move(iarray), FloatDataArray(), StringDataArray(), IntegerDataMap(), FloatDataMap(), std::move(smap));
+            count += moved._iarray.size();
+        }
+        std::cout << "construct EchoPack by move used time: " << getSteadyTime() - now << std::endl;
+    }
+
+    cout << "check bounded proto" << endl;
+    try
+    {
+        BoundedPack bounded;
+        bounded.name = "bounded";
+        bounded.buffs.push_back(1);
+        bounded.buffs.push_back(2);
+        bounded.emplaceParty('a', 100, 200, 300, 400, 500, 600, 700);
+        WriteStream ws(BoundedPack::getProtoID());
+        ws << bounded;
+        WriteStream wsStd(BoundedPack::getProtoID());
+        wsStd << std::string("bounded") << IntArray{ 1, 2 } << IntegerDataArray(bounded.party.begin(), bounded.party.end());
+        if (ws.getStreamLen() != wsStd.getStreamLen() || memcmp(ws.getStream(), wsStd.getStream(), ws.getStreamLen()) != 0)
+        {
+            cout << "error: bounded stream not equal std container stream." << endl;
+        }
+        BoundedPack result;
+        ReadStream rs(ws.getStream(), ws.getStreamLen());
+        rs >> result;
+        if (result.name != bounded.name || result.buffs.size() != 2 || result.buffs[1] != 2 || result.party.back()._ui64 != 700)
+        {
+            cout << "error: bounded decode error." << endl;
+        }
+
+        WriteStream wsOver(BoundedPack::getProtoID());
+        wsOver << std::string(33, 'a') << IntArray(9, 1);
+        ReadStream rsOverName(wsOver.getStream(), wsOver.getStreamLen());
+        ReadStream rsOverArray(wsOver.getStream(), wsOver.getStreamLen());
+        rsOverArray.skipOriginalData(sizeof(Integer) + 33);
+        int rejected = 0;
+        try { rsOverName >> result.name; } catch (const std::exception &) { rejected++; }
+        try { rsOverArray >> result.buffs; } catch (const std::exception &) { rejected++; }
+        try { result.name = std::string(33, 'a'); } catch (const std::exception &) { rejected++; }
+        if (rejected != 3 || result.name != bounded.name || result.buffs.size() != 2)
+        {
+            cout << "error: bounded over capacity not rejected." << endl;
+        }
+        cout << "success" << endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+
+    cout << "check log4z proto" << endl;
+    try
+    {
+        LogPack pack;
+        pack.id = 7;
+        pack.name = "log4z";
+        pack.buffs.push_back(1);
+        pack.buffs.push_back(2);
+        pack.flat[1] = "one";
+        pack.hash["one"] = 1;
+        char buf[200] = { 0 };
+        zsummer::log4z::Log4zStream stm(buf, sizeof(buf) - 1);
+        stm << pack;
+        if (std::string(buf) != "[id=7,name=log4z,buffs=FixedVector[size=2],flat=FlatMap[size=1],hash=unordered_map[size=1],]")
+        {
+            cout << "error: log4z output error. " << buf << endl;
+        }
+        cout << "success" << endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+
+    cout << "check bit packed proto" << endl;
+    try
+    {
+        FlagsPack flags(true, 100, 5, false, 12345, true, 0xfedcba9876ULL);
+        WriteStream ws(FlagsPack::getProtoID());
+        ws << flags;
+        if (ws.getStreamBodyLen() != 2 + 4 + 6)
+        {
+            cout << "error: bit packed stream length error." << endl;
+        }
+        FlagsPack result;
+        ReadStream rs(ws.getStream(), ws.getStreamLen());
+        rs >> result;
+        if (!result.online || result.level != 100 || result.camp != 5 || result.muted || result.id != 12345
+            || !result.hidden || result.exp != 0xfedcba9876ULL || rs.getStreamUnreadLen() != 0)
+        {
+            cout << "error: bit packed decode error." << endl;
+        }
+        cout << "success" << endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+
+    cout << "check quantized proto" << endl;
+    try
+    {
+        MovePack move(7, 1234.567f, -99999.99f, 200000.0f, -3.14f, -90.0f, 45.0f);
+        WriteStream ws(MovePack::getProtoID());
+        ws << move;
+        MovePack result;
+        ReadStream rs(ws.getStream(), ws.getStreamLen());
+        rs >> result;
+        if (ws.getStreamBodyLen() != 4 + 4 + 4 + 2 + 1 + 2 + 1 || result.eid != 7
+            || fabs(result.x - 1234.57f) > 0.001f || fabs(result.y + 99999.99f) > 0.01f || fabs(result.z - 300.0f) > 0.001f
+            || fabs(result.speed + 3.1f) > 0.001f || fabs(result.yaw - 270.0f) > 0.01f || fabs(result.pitch - 45.0f) > 1.41f)
+        {
+            cout << "error: quantized decode error." << endl;
+        }
+
+        PathPack pathPack;
+        for (int i = 0; i < 3000; i++)
+        {
+            pathPack.path.push_back(i * 0.1f - 150.0f);
+        }
+        WriteStream wsPath(PathPack::getProtoID());
+        wsPath << pathPack;
+        PathPack pathResult;
+        ReadStream rsPath(wsPath.getStream(), wsPath.getStreamLen());
+        rsPath >> pathResult;
+        bool pathEqual = pathResult.path.size() == pathPack.path.size();
+        for (size_t i = 0; pathEqual && i < pathPack.path.size(); i++)
+        {
+            pathEqual = fabs(pathResult.path[i] - pathPack.path[i]) <= 0.0051f;
+        }
+        if (wsPath.getStreamBodyLen() != 4 + 4 + 3000 * 2 + 2 || !pathEqual)
+        {
+            cout << "error: quantized array error." << endl;
+        }
+        if (FixedQuantizer<short>(0.01, 30000).quantize(NAN) != 0 || AngleQuantizer<unsigned char>().quantize(NAN) != 0 || AngleQuantizer<unsigned char>().quantize(INFINITY) != 0)
+        {
+            cout << "error: quantized nan error." << endl;
+        }
+        cout << "success" << endl;
+
+        std::vector<float> floats(1000 * 1000);
+        std::vector<short> shorts(floats.size());
+        for (size_t i = 0; i < floats.size(); i++)
+        {
+            floats[i] = (float)(i % 60000) * 0.01f - 300.0f;
+        }
+        FixedQuantizer<short> quantizer(0.01, 30000);
+        unsigned int now = getSteadyTime();
+        long long sum = 0;
+        for (int loop = 0; loop < 20; loop++)
+        {
+            quantizeArray(floats.data(), shorts.data(), floats.size(), quantizer);
+            sum += shorts[loop];
+        }
+        std::cout << "quantize array used time: " << getSteadyTime() - now << ", sum=" << sum << std::endl;
+        //same work as the array call, only the element loop is written out.
+        now = getSteadyTime();
+        for (int loop = 0; loop < 20; loop++)
+        {
+            for (size_t i = 0; i < floats.size(); i++)
+            {
+                shorts[i] = quantizer.quantize(floats[i]);
+            }
+            sum += shorts[loop];
+        }
+        std::cout << "quantize one by one used time: " << getSteadyTime() - now << ", sum=" << sum << std::endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+
+    cout << "check flat and hash map" << endl;
+    try
+    {
+        BagPack bag;
+        IntegerDataMap treeMap;
+        for (unsigned int i = 0; i < 1000; i++)
+        {
+            unsigned int key = (i * 7919) % 1000;
+            bag.emplaceItems(key, 'a', 1, 2, 3, 4, key, 6, 7);
+            treeMap[key] = bag.items[key];
+            bag.attrs["attr" + std::to_string(i)] = i;
+        }
+        WriteStream wsFlat(0);
+        wsFlat << bag.items;
+        WriteStream wsTree(0);
+        wsTree << treeMap;
+        if (wsFlat.getStreamLen() != wsTree.getStreamLen() || memcmp(wsFlat.getStream(), wsTree.getStream(), wsFlat.getStreamLen()) != 0)
+        {
+            cout << "error: flat map stream not equal std::map stream." << endl;
+        }
+        WriteStream ws(BagPack::getProtoID());
+        ws << bag;
+        BagPack result;
+        ReadStream rs(ws.getStream(), ws.getStreamLen());
+        rs >> result;
+        if (result.items.size() != 1000 || result.attrs != bag.attrs || result.items.begin()->first != 0 || result.items.at(999)._uint != 999 || result.items.find(1000) != result.items.end())
+        {
+            cout << "error: flat and hash map decode error." << endl;
+        }
+
+        //unsorted writer with duplicate key, keep the first one same as std::map.
+        WriteStream wsUnsorted(0);
+        wsUnsorted << (Integer)3 << (unsigned int)9 << IntegerData() << (unsigned int)1 << IntegerData() << (unsigned int)9 << IntegerData('b', 0, 0, 0, 0, 0, 0, 0);
+        ReadStream rsUnsorted(wsUnsorted.getStream(), wsUnsorted.getStreamLen());
+        ItemFlatMap unsorted;
+        rsUnsorted >> unsorted;
+        if (unsorted.size() != 2 || unsorted.begin()->first != 1 || unsorted.at(9)._char != IntegerData()._char)
+        {
+            cout << "error: flat map unsorted decode error." << endl;
+        }
+        cout << "success" << endl;
+
+        unsigned int now = getSteadyTime();
+        size_t count = 0;
+        for (int loop = 0; loop < 1000; loop++)
+        {
+            ReadStream rsTree(wsTree.getStream(), wsTree.getStreamLen());
+            IntegerDataMap decoded;
+            rsTree >> decoded;
+            count += decoded.size();
+        }
+        std::cout << "std::map decode used time: " << getSteadyTime() - now << ", count=" << count << std::endl;
+        now = getSteadyTime();
+        for (int loop = 0; loop < 1000; loop++)
+        {
+            ReadStream rsFlat(wsTree.getStream(), wsTree.getStreamLen());
+            ItemFlatMap decoded;
+            rsFlat >> decoded;
+            count += decoded.size();
+        }
+        std::cout << "flat map decode used time: " << getSteadyTime() - now << ", count=" << count << std::endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+
+    cout << "check std containers" << endl;
+    try
+    {
+        std::vector<int> ints = { 1, -2, 3 };
+        std::unordered_set<unsigned int> uset = { 5, 6 };
+        std::unordered_multimap<std::string, int> umulti = { { "a", 1 }, { "a", 2 } };
+        std::array<int, 3> iarr = { { 7, 8, 9 } };
+        std::array<std::string, 2> sarr = { { "x", "yz" } };
+        std::pair<int, std::string> pr(10, "pair");
+        std::tuple<char, std::string, std::vector<double>> tp('t', "tuple", std::vector<double>{ 1.5, 2.5 });
+        WriteStream ws(0);
+        ws << ints << uset << umulti << iarr << sarr << pr << tp;
+
+        WriteStream wsLoop(0);
+        wsLoop << (Integer)3 << 1 << -2 << 3;
+        if (memcmp(ws.getStreamBody(), wsLoop.getStreamBody(), wsLoop.getStreamBodyLen()) != 0)
+        {
+            cout << "error: bulk vector stream not equal element stream." << endl;
+        }
+
+        std::vector<int> ints2;
+        std::unordered_set<unsigned int> uset2;
+        std::unordered_multimap<std::string, int> umulti2;
+        std::array<int, 3> iarr2;
+        std::array<std::string, 2> sarr2;
+        std::pair<int, std::string> pr2;
+        std::tuple<char, std::string, std::vector<double>> tp2;
+        ReadStream rs(ws.getStream(), ws.getStreamLen());
+        rs >> ints2 >> uset2 >> umulti2 >> iarr2 >> sarr2 >> pr2 >> tp2;
+        if (ints2 != ints || uset2 != uset || umulti2.count("a") != 2 || iarr2 != iarr || sarr2 != sarr || pr2 != pr || tp2 != tp
+            || rs.getStreamUnreadLen() != 0)
+        {
+            cout << "error: std containers decode error." << endl;
+        }
+
+        std::array<int, 4> wrongCount;
+        ReadStream rsWrong(ws.getStream(), ws.getStreamLen());
+        std::vector<int> skip;
+        std::unordered_set<unsigned int> skipSet;
+        std::unordered_multimap<std::string, int> skipMulti;
+        rsWrong >> skip >> skipSet >> skipMulti;
+        bool rejected = false;
+        try { rsWrong >> wrongCount; } catch (const std::exception &) { rejected = true; }
+        if (!rejected)
+        {
+            cout << "error: std::array count not checked." << endl;
+        }
+#ifdef PROTO4Z_HAS_CXX17
+        std::optional<int> some = 3;
+        std::optional<std::string> none;
+        WriteStream ws17(0);
+        ws17 << some << none << std::string_view("view");
+        std::optional<int> some2;
+        std::optional<std::string> none2 = std::string("x");
+        std::string_view view;
+        ReadStream rs17(ws17.getStream(), ws17.getStreamLen());
+        rs17 >> some2 >> none2 >> view;
+        if (some2 != some || none2.has_value() || view != "view")
+        {
+            cout << "error: optional and string_view decode error." << endl;
+        }
+#endif
+        cout << "success" << endl;
+
+        std::vector<unsigned int> big(200 * 1000, 7);
+        unsigned int now = getSteadyTime();
+        size_t count = 0;
+        for (int loop = 0; loop < 100; loop++)
+        {
+            WriteStream wsBig(0);
+            wsBig << big;
+            ReadStream rsBig(wsBig.getStream(), wsBig.getStreamLen());
+            std::vector<unsigned int> decoded;
+            rsBig >> decoded;
+            count += decoded.size();
+        }
+        std::cout << "bulk vector encode and decode used time: " << getSteadyTime() - now << ", count=" << count << std::endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+
+    cout << "check memory usage" << endl;
+    try
+    {
+        SimplePack simple;
+        simple.name = "short";
+        size_t shortUsage = simple.memoryUsage();
+        simple.name = std::string(200, 'n');
+        EchoPack echo;
+        size_t emptyEcho = echo.memoryUsage();
+        echo._iarray.resize(100);
+        echo._smap["key"]._string = std::string(100, 's');
+        size_t expectEcho = emptyEcho + echo._iarray.capacity() * sizeof(IntegerData)
+            + sizeof(std::pair<const std::string, StringData>) + zsummer::proto4z::TreeNodeOverhead + 101;
+        if (shortUsage != sizeof(SimplePack) || simple.memoryUsage() < sizeof(SimplePack) + 201 || echo.memoryUsage() != expectEcho)
+        {
+            cout << "error: memoryUsage error. " << shortUsage << ", " << simple.memoryUsage() << ", " << echo.memoryUsage() << ", " << expectEcho << endl;
+        }
+
+        size_t usage = MemoryBudgetCache<unsigned int, SimplePack>::entryUsage(0, simple);
+        size_t longKey = MemoryBudgetCache<std::string, SimplePack>::entryUsage(std::string(100, 'k'), simple);
+        size_t shortKey = MemoryBudgetCache<std::string, SimplePack>::entryUsage("k", simple);
+        if (usage < simple.memoryUsage() + sizeof(unsigned int) + ListNodeOverhead + HashNodeOverhead + sizeof(void*) || longKey != shortKey + 2 * 101)
+        {
+            cout << "error: memory budget cache entry usage error." << endl;
+        }
+        MemoryBudgetCache<unsigned int, SimplePack> cache(usage * 10);
+        for (unsigned int i = 0; i < 100; i++)
+        {
+            simple.id = i;
+            cache.put(i, simple);
+            if (i == 95)
+            {
+                cache.get(90); //touch, 90 is the newest now
+            }
+        }
+        if (cache.size() != 10 || cache.usedBytes() > cache.budget() || cache.get(89) != nullptr || cache.get(90) == nullptr
+            || cache.get(99)->id != 99 || cache.evictCount() != 90)
+        {
+            cout << "error: memory budget cache error." << endl;
+        }
+        cache.setBudget(usage * 2);
+        if (cache.size() != 2 || cache.get(99) == nullptr)
+        {
+            cout << "error: memory budget cache setBudget error." << endl;
+        }
+        cout << "success" << endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+
+    {
+        //every packet of the file is registered, so the map lookup is not a one node tree.
+        //the traffic rotate over the small fixed width packets, the time is the lookup and the call more than the decode. best of several rounds.
+        DispatchBench bench;
+        addDispatchBench<IntegerData>(bench, true);
+        addDispatchBench<FloatData>(bench, true);
+        addDispatchBench<StringData>(bench, false);
+        addDispatchBench<EchoPack>(bench, false);
+        addDispatchBench<MoneyTree>(bench, true);
+        addDispatchBench<SimplePack>(bench, false);
+        addDispatchBench<SparsePack>(bench, false);
+        addDispatchBench<SparsePackNext>(bench, false);
+        addDispatchBench<BoundedPack>(bench, false);
+        addDispatchBench<FlagsPack>(bench, true);
+        addDispatchBench<MovePack>(bench, true);
+        addDispatchBench<PathPack>(bench, false);
+        addDispatchBench<BagPack>(bench, false);
+        //the two loops alternate in short slices, the noise of the machine fall on both sides.
+        const int DispatchCount = 100 * 1000;
+        const int Rounds = 80;
+        long long mapTime = 0;
+        long long tableTime = 0;
+        for (int round = 0; round < Rounds; round++)
+        {
+            long long begin = benchNow();
+            for (int i = 0; i < DispatchCount; i++)
+            {
+                const std::string & msg = bench.traffic[i % bench.traffic.size()];
+                ReadStream rs(msg.c_str(), (Integer)msg.length());
+                auto founder = bench.handlers.find(rs.getProtoID());
+                if (founder != bench.handlers.end())
+                {
+                    founder->second(rs);
+                }
+            }
+            mapTime += benchNow() - begin;
+            begin = benchNow();
+            for (int i = 0; i < DispatchCount; i++)
+            {
+                const std::string & msg = bench.traffic[i % bench.traffic.size()];
+                ReadStream rs(msg.c_str(), (Integer)msg.length());
+                bench.dispatcher.dispatch(rs);
+            }
+            tableTime += benchNow() - begin;
+        }
+        std::cout << "map dispatch used time: " << mapTime / 1000 << "ms, table dispatch used time: " << tableTime / 1000 << "ms" << std::endl;
+        if (bench.count != (unsigned long long)DispatchCount * Rounds * 2)
+        {
+            cout << "error: dispatch bench count error." << endl;
+        }
+
+        std::map<std::string, unsigned short> nameMap;
+        for (unsigned short id = TestProtoProtoIndex::MinProtoID; id <= TestProtoProtoIndex::MaxProtoID; id++)
+        {
+            nameMap[TestProtoProtoIndex::getProtoName(id)] = id;
+        }
+        std::vector<std::string> names;
+        for (auto & kv : nameMap)
+        {
+            names.push_back(kv.first);
+        }
+        names.push_back("NotAProto");
+        long long mapNameTime = 0;
+        long long hashNameTime = 0;
+        unsigned long long idSum = 0;
+        for (int round = 0; round < Rounds; round++)
+        {
+            long long begin = benchNow();
+            for (int i = 0; i < DispatchCount; i++)
+            {
+                auto founder = nameMap.find(names[i % names.size()]);
+                idSum += founder == nameMap.end() ? InvalidProtoID : founder->second;
+            }
+            mapNameTime += benchNow() - begin;
+            begin = benchNow();
+            for (int i = 0; i < DispatchCount; i++)
+            {
+                const std::string & name = names[i % names.size()];
+                idSum -= TestProtoProtoIndex::getProtoID(name.c_str(), name.length());
+            }
+            hashNameTime += benchNow() - begin;
+        }
+        std::cout << "map name lookup used time: " << mapNameTime / 1000 << "ms, perfect hash name lookup used time: " << hashNameTime / 1000 << "ms" << std::endl;
+        if (idSum != 0)
+        {
+            cout << "error: perfect hash name lookup error." << endl;
+        }
+    }
+
+    cout << "check object pool" << endl;
+    try
+    {
+        SparsePack sparse;
+        sparse.name = std::string(100, 's');
+        sparse.iarray.resize(10);
+        size_t capacity = sparse.iarray.capacity();
+        sparse.reset();
+        if (!sparse.name.empty() || !sparse.iarray.empty() || sparse.iarray.capacity() != capacity || sparse.id != 0 || !sparse.testTag(5))
+        {
+            cout << "error: reset error." << endl;
+        }
+        {
+            auto handle = ProtoPool<SparsePack>::instance().acquire();
+            handle->id = 5;
+            handle->clearTag().setTag(1);
+        }
+        auto again = ProtoPool<SparsePack>::instance().acquire();
+        if (again->id != 0 || !again->testTag(2) || ProtoPool<SparsePack>::instance().createCount() != 1)
+        {
+            cout << "error: pool not reuse a clean object." << endl;
+        }
+
+        //the thread_local handle is created before the pool, it is destroyed after the pool when the thread exit.
+        bool deleted = false;
+        std::thread([&deleted]()
+        {
+            static thread_local ProtoPool<SparsePack>::Handle holder;
+            holder = ProtoPool<SparsePack>::instance().acquire();
+            deleted = ProtoPool<SparsePack>::destroyed();
+        }).join();
+        if (deleted || ProtoPool<SparsePack>::destroyed())
+        {
+            cout << "error: pool destroyed flag error." << endl;
+        }
+        cout << "success" << endl;
+
+        //replay mixed traffic
+        EchoPack echo;
+        fillOnePack(echo);
+        PathPack path;
+        path.path.resize(200, 1.0f);
+        SimplePack simple;
+        simple.name = std::string(64, 'n');
+        std::vector<std::string> traffic;
+        WriteStream wsEcho(EchoPack::getProtoID());
+        wsEcho << echo;
+        WriteStream wsPath(PathPack::getProtoID());
+        wsPath << path;
+        WriteStream wsSimple(SimplePack::getProtoID());
+        wsSimple << simple;
+        traffic.push_back(std::string(wsEcho.getStream(), wsEcho.getStreamLen()));
+        traffic.push_back(std::string(wsPath.getStream(), wsPath.getStreamLen()));
+        traffic.push_back(std::string(wsSimple.getStream(), wsSimple.getStreamLen()));
+        size_t handled = 0;
+        TestProtoDispatcher plain;
+        plain.registerHandler<EchoPack>([&handled](EchoPack & p){ handled += p._iarray.size(); });
+        plain.registerHandler<PathPack>([&handled](PathPack & p){ handled += p.path.size(); });
+        plain.registerHandler<SimplePack>([&handled](SimplePack & p){ handled += p.name.size(); });
+        TestProtoDispatcher pooled;
+        pooled.registerPooledHandler<EchoPack>([&handled](EchoPack & p){ handled += p._iarray.size(); });
+        pooled.registerPooledHandler<PathPack>([&handled](PathPack & p){ handled += p.path.size(); });
+        pooled.registerPooledHandler<SimplePack>([&handled](SimplePack & p){ handled += p.name.size(); });
+        const int ReplayCount = 300000;
+        unsigned long long allocBegin = g_allocCount;
+        now = getSteadyTime();
+        for (int i = 0; i < ReplayCount; i++)
+        {
+            const std::string & msg = traffic[i % traffic.size()];
+            ReadStream rs(msg.c_str(), (Integer)msg.length());
+            plain.dispatch(rs);
+        }
+        std::cout << "dispatch used time: " << getSteadyTime() - now << ", alloc count: " << g_allocCount - allocBegin << std::endl;
+        allocBegin = g_allocCount;
+        now = getSteadyTime();
+        for (int i = 0; i < ReplayCount; i++)
+        {
+            const std::string & msg = traffic[i % traffic.size()];
+            ReadStream rs(msg.c_str(), (Integer)msg.length());
+            pooled.dispatch(rs);
+        }
+        std::cout << "pooled dispatch used time: " << getSteadyTime() - now << ", alloc count: " << g_allocCount - allocBegin << ", handled=" << handled << std::endl;
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+    cout << "check lua bridge" << endl;
+    lua_State * L = luaL_newstate();
+    try
+    {
+        luaL_openlibs(L);
+        luaopen_proto4z_util(L);
+        if (luaL_dostring(L, "package.path = package.path .. ';../../?.lua;../genCode/lua/?.lua' require('proto4z') require('TestProto')") != LUA_OK
+            || luaL_dostring(L, "local codecs = {} "
+                "for name, desc in pairs(Proto4z) do if type(desc) == 'table' and desc.__encoder then codecs[name] = {desc.__encoder, desc.__decoder} end end "
+                "function useProto4zCodec(on) for name, codec in pairs(codecs) do Proto4z[name].__encoder = on and codec[1] or nil Proto4z[name].__decoder = on and codec[2] or nil end end") != LUA_OK)
+        {
+            PROTO4Z_THROW("load proto4z.lua error: " << lua_tostring(L, -1));
+        }
+
+        EchoPack echo;
+        fillOnePack(echo);
+        EchoPack echoResult;
+        luaRoundTrip(L, echo, echoResult);
+        if (encodeBody(echoResult) != encodeBody(echo))
+        {
+            cout << "error: lua bridge EchoPack error." << endl;
+        }
+
+        FlagsPack flags;
+        flags.online = true;
+        flags.level = 99;
+        flags.camp = 5;
+        flags.id = 12345;
+        flags.exp = 1ULL << 39;
+        FlagsPack flagsResult;
+        luaRoundTrip(L, flags, flagsResult);
+        pushLua(L, flags);
+        lua_getfield(L, -1, "online");
+        lua_getfield(L, -2, "muted");
+        if (encodeBody(flagsResult) != encodeBody(flags) || lua_type(L, -2) != LUA_TBOOLEAN || lua_toboolean(L, -1))
+        {
+            cout << "error: lua bridge FlagsPack error." << endl;
+        }
+        lua_pop(L, 3);
+
+        MovePack move;
+        move.eid = 1;
+        move.x = -1234.56f;
+        move.y = 99999.99f;
+        move.z = 12.34f;
+        move.speed = 5.5f;
+        move.yaw = 270.0f;
+        move.pitch = 45.0f;
+        MovePack moveResult;
+        luaRoundTrip(L, move, moveResult);
+        PathPack path;
+        path.path.assign({ 1.0f, -2.5f, 299.99f });
+        PathPack pathResult;
+        luaRoundTrip(L, path, pathResult);
+        if (encodeBody(moveResult) != encodeBody(move) || encodeBody(pathResult) != encodeBody(path))
+        {
+            cout << "error: lua bridge quantized error." << endl;
+        }
+
+        //the absent member of tagged packet is nil in lua.
+        SparsePack sparse;
+        sparse.id = 7;
+        sparse.value = 2.5;
+        sparse.clearTag().setTag(1).setTag(5);
+        SparsePack sparseResult;
+        luaRoundTrip(L, sparse, sparseResult);
+        if (sparseResult.__tag != sparse.__tag || sparseResult.id != 7 || sparseResult.value != 2.5)
+        {
+            cout << "error: lua bridge tagged error." << endl;
+        }
+
+        BagPack bag;
+        bag.emplaceItems(3, 'a', 1, 2, 3, 4, 5, 6, 7);
+        bag.emplaceItems(1, 'b', 1, 2, 3, 4, 5, 6, 7);
+        bag.attrs["hp"] = 100;
+        bag.attrs["mp"] = 50;
+        BoundedPack bounded;
+        bounded.name = "bounded";
+        bounded.buffs.push_back(8);
+        bounded.party.push_back(IntegerData());
+        BagPack bagResult;
+        luaRoundTrip(L, bag, bagResult);
+        BoundedPack boundedResult;
+        luaRoundTrip(L, bounded, boundedResult);
+        if (encodeBody(bagResult.items) != encodeBody(bag.items) || bagResult.attrs != bag.attrs || encodeBody(boundedResult) != encodeBody(bounded))
+        {
+            cout << "error: lua bridge container error." << endl;
+        }
+
+        //decode from the host memory and encode into it, no lua string between.
+        std::string echoBody = encodeBody(echo);
+        lua_getglobal(L, "Proto4zUtil");
+        lua_getfield(L, -1, "decode");
+        lua_pushlightuserdata(L, (void *)echoBody.data());
+        lua_pushstring(L, "EchoPack");
+        lua_pushinteger(L, 1);
+        lua_pushinteger(L, (lua_Integer)echoBody.length());
+        if (lua_pcall(L, 4, 2, 0) != LUA_OK)
+        {
+            PROTO4Z_THROW("Proto4zUtil.decode light userdata error: " << lua_tostring(L, -1));
+        }
+        readLua(L, -2, echoResult);
+        if (lua_tointeger(L, -1) != (lua_Integer)echoBody.length() + 1 || encodeBody(echoResult) != echoBody)
+        {
+            cout << "error: lua decode light userdata error." << endl;
+        }
+        lua_pop(L, 2);
+        lua_newuserdata(L, echoBody.length());
+        lua_getfield(L, -2, "decode");
+        lua_pushvalue(L, -2);
+        lua_pushstring(L, "EchoPack");
+        if (lua_pcall(L, 2, 1, 0) == LUA_OK)
+        {
+            cout << "error: lua decode userdata of other type not rejected." << endl;
+        }
+        lua_pop(L, 2);
+        char * hostBody = (char *)lua_newuserdata(L, echoBody.length());
+        luaL_setmetatable(L, "proto4z.bytes");
+        memcpy(hostBody, echoBody.data(), echoBody.length());
+        lua_getfield(L, -2, "decode");
+        lua_pushvalue(L, -2);
+        lua_pushstring(L, "EchoPack");
+        if (lua_pcall(L, 2, 1, 0) != LUA_OK)
+        {
+            PROTO4Z_THROW("Proto4zUtil.decode full userdata error: " << lua_tostring(L, -1));
+        }
+        readLua(L, -1, echoResult);
+        if (encodeBody(echoResult) != echoBody)
+        {
+            cout << "error: lua decode full userdata error." << endl;
+        }
+        lua_pop(L, 2);
+        std::vector<char> hostBuffer(echoBody.length() + 8, 'x');
+        lua_getfield(L, -1, "encodeTo");
+        pushLua(L, echo);
+        lua_pushstring(L, "EchoPack");
+        lua_pushlightuserdata(L, hostBuffer.data());
+        lua_pushinteger(L, 5);
+        lua_pushinteger(L, (lua_Integer)hostBuffer.size());
+        if (lua_pcall(L, 5, 1, 0) != LUA_OK)
+        {
+            PROTO4Z_THROW("Proto4zUtil.encodeTo error: " << lua_tostring(L, -1));
+        }
+        ReadStream hostStream(hostBuffer.data() + 4, (Integer)echoBody.length(), false);
+        hostStream >> echoResult;
+        if (lua_tointeger(L, -1) != (lua_Integer)echoBody.length() + 5 || hostBuffer[3] != 'x' || hostBuffer[echoBody.length() + 4] != 'x'
+            || encodeBody(echoResult) != echoBody)
+        {
+            cout << "error: lua encodeTo light userdata error." << endl;
+        }
+        lua_pop(L, 1);
+        lua_getfield(L, -1, "encodeTo");
+        pushLua(L, echo);
+        lua_pushstring(L, "EchoPack");
+        lua_pushlightuserdata(L, hostBuffer.data());
+        lua_pushinteger(L, 1);
+        lua_pushinteger(L, (lua_Integer)echoBody.length() - 1);
+        if (lua_pcall(L, 5, 1, 0) == LUA_OK)
+        {
+            cout << "error: lua encodeTo overflow not rejected." << endl;
+        }
+        lua_pop(L, 1);
+        lua_getfield(L, -1, "encodeTo");
+        pushLua(L, echo);
+        lua_pushstring(L, "EchoPack");
+        lua_pushlightuserdata(L, hostBuffer.data());
+        lua_pushinteger(L, 1);
+        lua_pushinteger(L, -1);
+        if (lua_pcall(L, 5, 1, 0) == LUA_OK)
+        {
+            cout << "error: lua encodeTo negative len not rejected." << endl;
+        }
+        lua_pop(L, 2);
+
+        //type mismatch is rejected.
+        bool rejected = false;
+        int top = lua_gettop(L);
+        luaL_dostring(L, "return {id='abc'}");
+        try
+        {
+            readLua(L, -1, sparse);
+        }
+        catch (const std::exception &)
+        {
+            rejected = true;
+        }
+        lua_settop(L, top);
+        if (!rejected)
+        {
+            cout << "error: lua bridge type mismatch not rejected." << endl;
+        }
+        if (lua_gettop(L) != 0)
+        {
+            cout << "error: lua bridge stack not balance." << endl;
+        }
+        cout << "success" << endl;
+
+        const int loop = 20000;
+        unsigned int now = getSteadyTime();
+        for (int i = 0; i < loop; i++)
+        {
+            pushLua(L, echo);
+            readLua(L, -1, echoResult);
+            lua_pop(L, 1);
+        }
+        std::cout << "lua bridge push and read used time: " << getSteadyTime() - now << std::endl;
+        now = getSteadyTime();
+        for (int i = 0; i < loop; i++)
+        {
+            WriteStream ws(EchoPack::getProtoID());
+            ws << echo;
+            lua_getglobal(L, "Proto4z");
+            lua_getfield(L, -1, "encode");
+            lua_getfield(L, -2, "decode");
+            lua_pushlstring(L, ws.getStreamBody(), ws.getStreamBodyLen());
+            lua_pushstring(L, "EchoPack");
+            lua_call(L, 2, 1);
+            lua_pushstring(L, "EchoPack");
+            lua_call(L, 2, 1);
+            ReadStream rs(lua_tostring(L, -1), (Integer)lua_rawlen(L, -1), false);
+            rs >> echoResult;
+            lua_pop(L, 2);
+        }
+        std::cout << "lua binary round trip used time: " << getSteadyTime() - now << std::endl;
+        for (int host = 0; host < 2; host++)
+        {
+            std::vector<char> frame(64 * 1024);
+            now = getSteadyTime();
+            for (int i = 0; i < loop; i++)
+            {
+                WriteStream ws(EchoPack::getProtoID());
+                ws << echo;
+                lua_getglobal(L, "Proto4zUtil");
+                lua_getfield(L, -1, host ? "encodeTo" : "encode");
+                lua_getfield(L, -2, "decode");
+                if (host)
+                {
+                    lua_pushlightuserdata(L, (void *)ws.getStreamBody());
+                }
+                else
+                {
+                    lua_pushlstring(L, ws.getStreamBody(), ws.getStreamBodyLen());
+                }
+                lua_pushstring(L, "EchoPack");
+                lua_pushinteger(L, 1);
+                lua_pushinteger(L, ws.getStreamBodyLen());
+                lua_call(L, 4, 1);
+                lua_pushstring(L, "EchoPack");
+                if (host)
+                {
+                    lua_pushlightuserdata(L, frame.data());
+                    lua_pushinteger(L, 1);
+                    lua_pushinteger(L, (lua_Integer)frame.size());
+                    lua_call(L, 5, 1);
+                    ReadStream rs(frame.data(), (Integer)lua_tointeger(L, -1) - 1, false);
+                    rs >> echoResult;
+                }
+                else
+                {
+                    lua_call(L, 2, 1);
+                    ReadStream rs(lua_tostring(L, -1), (Integer)lua_rawlen(L, -1), false);
+                    rs >> echoResult;
+                }
+                lua_pop(L, 2);
+            }
+            std::cout << "lua c codec round trip " << (host ? "with host buffer" : "with lua string") << " used time: " << getSteadyTime() - now << std::endl;
+        }
+
+        //every packet of TestProto.xml, the same random corpus through c++, proto4z.lua and Proto4zUtil.
+        cout << "check cross language conformance" << endl;
+        CorpusRandom rnd(20150601);
+        ConformanceStat total;
+        const int samples = 64;
+        const int rounds = 20;
+        int errors = 0;
+        errors += checkConformance<IntegerData>(L, rnd, samples, rounds, total);
+        errors += checkConformance<FloatData>(L, rnd, samples, rounds, total);
+        errors += checkConformance<StringData>(L, rnd, samples, rounds, total);
+        errors += checkConformance<EchoPack>(L, rnd, samples, rounds, total);
+        errors += checkConformance<MoneyTree>(L, rnd, samples, rounds, total);
+        errors += checkConformance<SimplePack>(L, rnd, samples, rounds, total);
+        errors += checkConformance<SparsePack>(L, rnd, samples, rounds, total);
+        errors += checkConformance<SparsePackNext>(L, rnd, samples, rounds, total);
+        errors += checkConformance<BoundedPack>(L, rnd, samples, rounds, total);
+        errors += checkConformance<FlagsPack>(L, rnd, samples, rounds, total);
+        errors += checkConformance<MovePack>(L, rnd, samples, rounds, total);
+        errors += checkConformance<PathPack>(L, rnd, samples, rounds, total);
+        errors += checkConformance<BagPack>(L, rnd, samples, rounds, total);
+        for (int codec = 0; codec < CC_MAX; codec++)
+        {
+            cout << ConformanceCodecName[codec] << " encode " << conformanceSpeed(total.bytes, total.encodeTime[codec]) << "MB/s, decode "
+                << conformanceSpeed(total.bytes, total.decodeTime[codec]) << "MB/s" << endl;
+        }
+        if (errors != 0 || lua_gettop(L) != 0)
+        {
+            cout << "error: cross language conformance errors=" << errors << endl;
+        }
+        else
+        {
+            cout << "success" << endl;
+        }
+    }
+    catch (const std::exception & e)
+    {
+        cout << "error:" << e.what() << endl;
+    }
+    lua_close(L);
+
 
 
 
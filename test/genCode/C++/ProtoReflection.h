@@ -0,0 +1,107 @@
+﻿
+#ifndef _ProtoReflection_H_ 
+#define _ProtoReflection_H_ 
+class ProtoReflection
+{
+public:
+    static std::string getProtoName(ui16 protoID)
+    {
+        switch (protoID)
+        {
+            case 0:
+            {
+                return "InvalidProtoID";
+            }
+            break;
+            case 30000:
+            {
+                   return "IntegerData";
+            }
+            break;
+            case 30001:
+            {
+                   return "FloatData";
+            }
+            break;
+            case 30002:
+            {
+                   return "StringData";
+            }
+            break;
+            case 30003:
+            {
+                   return "EchoPack";
+            }
+            break;
+            case 30004:
+            {
+                   return "MoneyTree";
+            }
+            break;
+            case 30005:
+            {
+                   return "SimplePack";
+            }
+            break;
+            case 30006:
+            {
+                   return "SparsePack";
+            }
+            break;
+            case 30007:
+            {
+                   return "SparsePackNext";
+            }
+            break;
+            case 30008:
+            {
+                   return "BoundedPack";
+            }
+            break;
+            case 30009:
+            {
+                   return "FlagsPack";
+            }
+            break;
+            case 30010:
+            {
+                   return "MovePack";
+            }
+            break;
+            case 30011:
+            {
+                   return "PathPack";
+            }
+            break;
+            case 30012:
+            {
+                   return "BagPack";
+            }
+            break;
+            case 32001:
+            {
+                   return "LogPack";
+            }
+            break;
+
+        }
+        char buf[20];
+        sprintf(buf, "%u", (unsigned int)protoID);
+        return std::string("UnknownProtoID_") + buf;
+    }
+
+    static std::string getErrorDesc(ui16 errCode)
+    {
+        switch (errCode)
+        {
+
+        }
+        char buf[20];
+        sprintf(buf, "%u", (unsigned int)errCode);
+        return std::string("UnknownErrorCode_") + buf;
+    }
+};
+
+#endif
+
+
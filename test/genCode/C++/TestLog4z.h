@@ -0,0 +1,150 @@
+ 
+#ifndef _TESTLOG4Z_H_ 
+#define _TESTLOG4Z_H_ 
+ 
+ 
+ 
+typedef zsummer::proto4z::FixedVector<unsigned int, 4> LogBuffArray; //内联存储  
+ 
+ 
+typedef zsummer::proto4z::FlatMap<unsigned int, std::string> LogFlatMap; //有序数组  
+ 
+ 
+typedef std::unordered_map<std::string, unsigned int> LogHashMap; //哈希表  
+ 
+struct LogPack 
+{ 
+    static const unsigned short getProtoID() { return 32001;} 
+    static const std::string getProtoName() { return "LogPack";} 
+    unsigned int id;  
+    zsummer::proto4z::FixedString<16> name; //内联存储  
+    LogBuffArray buffs;  
+    LogFlatMap flat;  
+    LogHashMap hash;  
+    LogPack() 
+    { 
+        id = 0; 
+    } 
+    LogPack(unsigned int id, zsummer::proto4z::FixedString<16> name, LogBuffArray buffs, LogFlatMap flat, LogHashMap hash) : id(id), name(std::move(name)), buffs(std::move(buffs)), flat(std::move(flat)), hash(std::move(hash)) 
+    { 
+    } 
+    LogPack(const LogPack &) = default; 
+    LogPack(LogPack &&) noexcept = default; 
+    LogPack & operator = (const LogPack &) = default; 
+    LogPack & operator = (LogPack &&) noexcept = default; 
+    template<class ... Args> 
+    inline unsigned int & emplaceBuffs(Args && ... args) { buffs.emplace_back(std::forward<Args>(args)...); return buffs.back(); } 
+    template<class Key, class ... Args> 
+    inline LogFlatMap::mapped_type & emplaceFlat(Key && key, Args && ... args) { return flat.emplace(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...)).first->second; } 
+    template<class Key, class ... Args> 
+    inline LogHashMap::mapped_type & emplaceHash(Key && key, Args && ... args) { return hash.emplace(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...)).first->second; } 
+    static constexpr unsigned int getMemberCount() { return 5;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("id", "ui32", 0, &LogPack::id)); 
+        visitor(zsummer::proto4z::makeProtoMember("name", "string", 0, &LogPack::name)); 
+        visitor(zsummer::proto4z::makeProtoMember("buffs", "LogBuffArray", 0, &LogPack::buffs)); 
+        visitor(zsummer::proto4z::makeProtoMember("flat", "LogFlatMap", 0, &LogPack::flat)); 
+        visitor(zsummer::proto4z::makeProtoMember("hash", "LogHashMap", 0, &LogPack::hash)); 
+    } 
+    inline void reset() 
+    { 
+        zsummer::proto4z::resetMember(id); 
+        zsummer::proto4z::resetMember(name); 
+        zsummer::proto4z::resetMember(buffs); 
+        zsummer::proto4z::resetMember(flat); 
+        zsummer::proto4z::resetMember(hash); 
+    } 
+    inline size_t memoryUsage() const 
+    { 
+        return sizeof(*this) + zsummer::proto4z::heapUsage(name) + zsummer::proto4z::heapUsage(buffs) + zsummer::proto4z::heapUsage(flat) + zsummer::proto4z::heapUsage(hash); 
+    } 
+}; 
+inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const LogPack & data) 
+{ 
+    ws << data.id;  
+    ws << data.name;  
+    ws << data.buffs;  
+    ws << data.flat;  
+    ws << data.hash;  
+    return ws; 
+} 
+inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, LogPack & data) 
+{ 
+    rs >> data.id;  
+    rs >> data.name;  
+    rs >> data.buffs;  
+    rs >> data.flat;  
+    rs >> data.hash;  
+    return rs; 
+} 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const LogPack & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 5); 
+    pushLua(L, data.id); lua_setfield(L, -2, "id"); 
+    pushLua(L, data.name); lua_setfield(L, -2, "name"); 
+    pushLua(L, data.buffs); lua_setfield(L, -2, "buffs"); 
+    pushLua(L, data.flat); lua_setfield(L, -2, "flat"); 
+    pushLua(L, data.hash); lua_setfield(L, -2, "hash"); 
+} 
+inline void readLua(lua_State * L, int index, LogPack & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "id"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.id); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "name"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.name); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "buffs"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.buffs); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "flat"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.flat); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "hash"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.hash); 
+    lua_pop(L, 1); 
+} 
+#endif 
+inline zsummer::log4z::Log4zStream & operator << (zsummer::log4z::Log4zStream & stm, const LogPack & info) 
+{ 
+    stm << "["; 
+    stm << "id=" << info.id << ","; 
+    stm << "name=" << info.name << ","; 
+    stm << "buffs=" << info.buffs << ","; 
+    stm << "flat=" << info.flat << ","; 
+    stm << "hash=" << info.hash << ","; 
+    stm << "]"; 
+    return stm; 
+} 
+ 
+typedef zsummer::proto4z::ProtoDispatcher<32001, 1> TestLog4zDispatcher; 
+ 
+struct TestLog4zProtoIndex //protoID <-> protoName lookup 
+{ 
+    static const unsigned short MinProtoID = 32001; 
+    static const unsigned short MaxProtoID = 32001; 
+    static const char * getProtoName(unsigned short protoID) 
+    { 
+        static const char * names[] = { "LogPack" }; 
+        if (protoID < MinProtoID || protoID > MaxProtoID) return nullptr; 
+        return names[protoID - MinProtoID]; 
+    } 
+    static unsigned short getProtoID(const char * name, size_t len) 
+    { 
+        struct Slot { const char * name; size_t len; unsigned short protoID; }; 
+        static const Slot slots[2] = { { "", 0, zsummer::proto4z::InvalidProtoID }, { "LogPack", 7, 32001 } }; 
+        const Slot & slot = slots[zsummer::proto4z::protoNameHash(name, len, 0U) & 1]; 
+        return slot.len == len && memcmp(slot.name, name, len) == 0 ? slot.protoID : zsummer::proto4z::InvalidProtoID; 
+    } 
+}; 
+ 
+#endif 
@@ -36,42 +36,126 @@ struct IntegerData //测试
         _i64 = 0; 
         _ui64 = 0; 
     } 
-    IntegerData(const char & _char, const unsigned char & _uchar, const short & _short, const unsigned short & _ushort, const int & _int, const unsigned int & _uint, const long long & _i64, const unsigned long long & _ui64) 
+    IntegerData(char _char, unsigned char _uchar, short _short, unsigned short _ushort, int _int, unsigned int _uint, long long _i64, unsigned long long _ui64) : _char(_char), _uchar(_uchar), _short(_short), _ushort(_ushort), _int(_int), _uint(_uint), _i64(_i64), _ui64(_ui64) 
     { 
-        this->_char = _char; 
-        this->_uchar = _uchar; 
-        this->_short = _short; 
-        this->_ushort = _ushort; 
-        this->_int = _int; 
-        this->_uint = _uint; 
-        this->_i64 = _i64; 
-        this->_ui64 = _ui64; 
+    } 
+    IntegerData(const IntegerData &) = default; 
+    IntegerData(IntegerData &&) noexcept = default; 
+    IntegerData & operator = (const IntegerData &) = default; 
+    IntegerData & operator = (IntegerData &&) noexcept = default; 
+    static constexpr unsigned int getMemberCount() { return 8;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("_char", "i8", 0, &IntegerData::_char)); 
+        visitor(zsummer::proto4z::makeProtoMember("_uchar", "ui8", 0, &IntegerData::_uchar)); 
+        visitor(zsummer::proto4z::makeProtoMember("_short", "i16", 0, &IntegerData::_short)); 
+        visitor(zsummer::proto4z::makeProtoMember("_ushort", "ui16", 0, &IntegerData::_ushort)); 
+        visitor(zsummer::proto4z::makeProtoMember("_int", "i32", 0, &IntegerData::_int)); 
+        visitor(zsummer::proto4z::makeProtoMember("_uint", "ui32", 0, &IntegerData::_uint)); 
+        visitor(zsummer::proto4z::makeProtoMember("_i64", "i64", 0, &IntegerData::_i64)); 
+        visitor(zsummer::proto4z::makeProtoMember("_ui64", "ui64", 0, &IntegerData::_ui64)); 
+    } 
+    inline void reset() 
+    { 
+        zsummer::proto4z::resetMember(_char); 
+        zsummer::proto4z::resetMember(_uchar); 
+        zsummer::proto4z::resetMember(_short); 
+        zsummer::proto4z::resetMember(_ushort); 
+        zsummer::proto4z::resetMember(_int); 
+        zsummer::proto4z::resetMember(_uint); 
+        zsummer::proto4z::resetMember(_i64); 
+        zsummer::proto4z::resetMember(_ui64); 
+    } 
+    inline size_t memoryUsage() const 
+    { 
+        return sizeof(*this); 
+    } 
+    static const zsummer::proto4z::Integer FixedWireSize = 30; 
+    inline void fixedEncode(char * stream) const 
+    { 
+        memcpy(stream + 0, &_char, 1); 
+        memcpy(stream + 1, &_uchar, 1); 
+        memcpy(stream + 2, &_short, 2); 
+        memcpy(stream + 4, &_ushort, 2); 
+        memcpy(stream + 6, &_int, 4); 
+        memcpy(stream + 10, &_uint, 4); 
+        memcpy(stream + 14, &_i64, 8); 
+        memcpy(stream + 22, &_ui64, 8); 
+    } 
+    inline void fixedDecode(const char * stream) 
+    { 
+        memcpy(&_char, stream + 0, 1); 
+        memcpy(&_uchar, stream + 1, 1); 
+        memcpy(&_short, stream + 2, 2); 
+        memcpy(&_ushort, stream + 4, 2); 
+        memcpy(&_int, stream + 6, 4); 
+        memcpy(&_uint, stream + 10, 4); 
+        memcpy(&_i64, stream + 14, 8); 
+        memcpy(&_ui64, stream + 22, 8); 
     } 
 }; 
+static_assert(sizeof(IntegerData::_char) + sizeof(IntegerData::_uchar) + sizeof(IntegerData::_short) + sizeof(IntegerData::_ushort) + sizeof(IntegerData::_int) + sizeof(IntegerData::_uint) + sizeof(IntegerData::_i64) + sizeof(IntegerData::_ui64) == IntegerData::FixedWireSize, "IntegerData fixed wire layout error."); 
 inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const IntegerData & data) 
 { 
-    ws << data._char;  
-    ws << data._uchar;  
-    ws << data._short;  
-    ws << data._ushort;  
-    ws << data._int;  
-    ws << data._uint;  
-    ws << data._i64;  
-    ws << data._ui64;  
+    char stream[IntegerData::FixedWireSize]; 
+    data.fixedEncode(stream); 
+    ws.appendOriginalData(stream, IntegerData::FixedWireSize); 
     return ws; 
 } 
 inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, IntegerData & data) 
 { 
-    rs >> data._char;  
-    rs >> data._uchar;  
-    rs >> data._short;  
-    rs >> data._ushort;  
-    rs >> data._int;  
-    rs >> data._uint;  
-    rs >> data._i64;  
-    rs >> data._ui64;  
+    data.fixedDecode(rs.peekOriginalData(IntegerData::FixedWireSize)); 
+    rs.skipOriginalData(IntegerData::FixedWireSize); 
     return rs; 
 } 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const IntegerData & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 8); 
+    pushLua(L, data._char); lua_setfield(L, -2, "_char"); 
+    pushLua(L, data._uchar); lua_setfield(L, -2, "_uchar"); 
+    pushLua(L, data._short); lua_setfield(L, -2, "_short"); 
+    pushLua(L, data._ushort); lua_setfield(L, -2, "_ushort"); 
+    pushLua(L, data._int); lua_setfield(L, -2, "_int"); 
+    pushLua(L, data._uint); lua_setfield(L, -2, "_uint"); 
+    pushLua(L, data._i64); lua_setfield(L, -2, "_i64"); 
+    pushLua(L, data._ui64); lua_setfield(L, -2, "_ui64"); 
+} 
+inline void readLua(lua_State * L, int index, IntegerData & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "_char"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._char); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "_uchar"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._uchar); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "_short"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._short); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "_ushort"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._ushort); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "_int"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._int); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "_uint"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._uint); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "_i64"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._i64); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "_ui64"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._ui64); 
+    lua_pop(L, 1); 
+} 
+#endif 
  
 struct FloatData //测试  
 { 
@@ -84,24 +168,78 @@ struct FloatData //测试
         _float = 0.0; 
         _double = 0.0; 
     } 
-    FloatData(const float & _float, const double & _double) 
+    FloatData(float _float, double _double) : _float(_float), _double(_double) 
+    { 
+    } 
+    FloatData(const FloatData &) = default; 
+    FloatData(FloatData &&) noexcept = default; 
+    FloatData & operator = (const FloatData &) = default; 
+    FloatData & operator = (FloatData &&) noexcept = default; 
+    static constexpr unsigned int getMemberCount() { return 2;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("_float", "float", 0, &FloatData::_float)); 
+        visitor(zsummer::proto4z::makeProtoMember("_double", "double", 0, &FloatData::_double)); 
+    } 
+    inline void reset() 
+    { 
+        zsummer::proto4z::resetMember(_float); 
+        zsummer::proto4z::resetMember(_double); 
+    } 
+    inline size_t memoryUsage() const 
+    { 
+        return sizeof(*this); 
+    } 
+    static const zsummer::proto4z::Integer FixedWireSize = 12; 
+    inline void fixedEncode(char * stream) const 
+    { 
+        memcpy(stream + 0, &_float, 4); 
+        memcpy(stream + 4, &_double, 8); 
+    } 
+    inline void fixedDecode(const char * stream) 
     { 
-        this->_float = _float; 
-        this->_double = _double; 
+        memcpy(&_float, stream + 0, 4); 
+        memcpy(&_double, stream + 4, 8); 
     } 
 }; 
+static_assert(sizeof(FloatData::_float) + sizeof(FloatData::_double) == FloatData::FixedWireSize, "FloatData fixed wire layout error."); 
 inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const FloatData & data) 
 { 
-    ws << data._float;  
-    ws << data._double;  
+    char stream[FloatData::FixedWireSize]; 
+    data.fixedEncode(stream); 
+    ws.appendOriginalData(stream, FloatData::FixedWireSize); 
     return ws; 
 } 
 inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, FloatData & data) 
 { 
-    rs >> data._float;  
-    rs >> data._double;  
+    data.fixedDecode(rs.peekOriginalData(FloatData::FixedWireSize)); 
+    rs.skipOriginalData(FloatData::FixedWireSize); 
     return rs; 
 } 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const FloatData & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 2); 
+    pushLua(L, data._float); lua_setfield(L, -2, "_float"); 
+    pushLua(L, data._double); lua_setfield(L, -2, "_double"); 
+} 
+inline void readLua(lua_State * L, int index, FloatData & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "_float"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._float); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "_double"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._double); 
+    lua_pop(L, 1); 
+} 
+#endif 
  
 struct StringData //测试  
 { 
@@ -111,9 +249,26 @@ struct StringData //测试
     StringData() 
     { 
     } 
-    StringData(const std::string & _string) 
+    StringData(std::string _string) : _string(std::move(_string)) 
     { 
-        this->_string = _string; 
+    } 
+    StringData(const StringData &) = default; 
+    StringData(StringData &&) noexcept = default; 
+    StringData & operator = (const StringData &) = default; 
+    StringData & operator = (StringData &&) noexcept = default; 
+    static constexpr unsigned int getMemberCount() { return 1;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("_string", "string", 0, &StringData::_string)); 
+    } 
+    inline void reset() 
+    { 
+        zsummer::proto4z::resetMember(_string); 
+    } 
+    inline size_t memoryUsage() const 
+    { 
+        return sizeof(*this) + zsummer::proto4z::heapUsage(_string); 
     } 
 }; 
 inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const StringData & data) 
@@ -126,6 +281,25 @@ inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream
     rs >> data._string;  
     return rs; 
 } 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const StringData & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 1); 
+    pushLua(L, data._string); lua_setfield(L, -2, "_string"); 
+} 
+inline void readLua(lua_State * L, int index, StringData & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "_string"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._string); 
+    lua_pop(L, 1); 
+} 
+#endif 
  
  
 typedef std::vector<unsigned int> IntArray;  
@@ -161,14 +335,48 @@ struct EchoPack
     EchoPack() 
     { 
     } 
-    EchoPack(const IntegerDataArray & _iarray, const FloatDataArray & _farray, const StringDataArray & _sarray, const IntegerDataMap & _imap, const FloatDataMap & _fmap, const StringDataMap & _smap) 
+    EchoPack(IntegerDataArray _iarray, FloatDataArray _farray, StringDataArray _sarray, IntegerDataMap _imap, FloatDataMap _fmap, StringDataMap _smap) : _iarray(std::move(_iarray)), _farray(std::move(_farray)), _sarray(std::move(_sarray)), _imap(std::move(_imap)), _fmap(std::move(_fmap)), _smap(std::move(_smap)) 
+    { 
+    } 
+    EchoPack(const EchoPack &) = default; 
+    EchoPack(EchoPack &&) noexcept = default; 
+    EchoPack & operator = (const EchoPack &) = default; 
+    EchoPack & operator = (EchoPack &&) noexcept = default; 
+    template<class ... Args> 
+    inline IntegerData & emplaceIarray(Args && ... args) { _iarray.emplace_back(std::forward<Args>(args)...); return _iarray.back(); } 
+    template<class ... Args> 
+    inline FloatData & emplaceFarray(Args && ... args) { _farray.emplace_back(std::forward<Args>(args)...); return _farray.back(); } 
+    template<class ... Args> 
+    inline StringData & emplaceSarray(Args && ... args) { _sarray.emplace_back(std::forward<Args>(args)...); return _sarray.back(); } 
+    template<class Key, class ... Args> 
+    inline IntegerDataMap::mapped_type & emplaceImap(Key && key, Args && ... args) { return _imap.emplace(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...)).first->second; } 
+    template<class Key, class ... Args> 
+    inline FloatDataMap::mapped_type & emplaceFmap(Key && key, Args && ... args) { return _fmap.emplace(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...)).first->second; } 
+    template<class Key, class ... Args> 
+    inline StringDataMap::mapped_type & emplaceSmap(Key && key, Args && ... args) { return _smap.emplace(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...)).first->second; } 
+    static constexpr unsigned int getMemberCount() { return 6;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("_iarray", "IntegerDataArray", 0, &EchoPack::_iarray)); 
+        visitor(zsummer::proto4z::makeProtoMember("_farray", "FloatDataArray", 0, &EchoPack::_farray)); 
+        visitor(zsummer::proto4z::makeProtoMember("_sarray", "StringDataArray", 0, &EchoPack::_sarray)); 
+        visitor(zsummer::proto4z::makeProtoMember("_imap", "IntegerDataMap", 0, &EchoPack::_imap)); 
+        visitor(zsummer::proto4z::makeProtoMember("_fmap", "FloatDataMap", 0, &EchoPack::_fmap)); 
+        visitor(zsummer::proto4z::makeProtoMember("_smap", "StringDataMap", 0, &EchoPack::_smap)); 
+    } 
+    inline void reset() 
     { 
-        this->_iarray = _iarray; 
-        this->_farray = _farray; 
-        this->_sarray = _sarray; 
-        this->_imap = _imap; 
-        this->_fmap = _fmap; 
-        this->_smap = _smap; 
+        zsummer::proto4z::resetMember(_iarray); 
+        zsummer::proto4z::resetMember(_farray); 
+        zsummer::proto4z::resetMember(_sarray); 
+        zsummer::proto4z::resetMember(_imap); 
+        zsummer::proto4z::resetMember(_fmap); 
+        zsummer::proto4z::resetMember(_smap); 
+    } 
+    inline size_t memoryUsage() const 
+    { 
+        return sizeof(*this) + zsummer::proto4z::heapUsage(_iarray) + zsummer::proto4z::heapUsage(_farray) + zsummer::proto4z::heapUsage(_sarray) + zsummer::proto4z::heapUsage(_imap) + zsummer::proto4z::heapUsage(_fmap) + zsummer::proto4z::heapUsage(_smap); 
     } 
 }; 
 inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const EchoPack & data) 
@@ -191,6 +399,45 @@ inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream
     rs >> data._smap;  
     return rs; 
 } 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const EchoPack & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 6); 
+    pushLua(L, data._iarray); lua_setfield(L, -2, "_iarray"); 
+    pushLua(L, data._farray); lua_setfield(L, -2, "_farray"); 
+    pushLua(L, data._sarray); lua_setfield(L, -2, "_sarray"); 
+    pushLua(L, data._imap); lua_setfield(L, -2, "_imap"); 
+    pushLua(L, data._fmap); lua_setfield(L, -2, "_fmap"); 
+    pushLua(L, data._smap); lua_setfield(L, -2, "_smap"); 
+} 
+inline void readLua(lua_State * L, int index, EchoPack & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "_iarray"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._iarray); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "_farray"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._farray); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "_sarray"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._sarray); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "_imap"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._imap); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "_fmap"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._fmap); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "_smap"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data._smap); 
+    lua_pop(L, 1); 
+} 
+#endif 
  
 struct MoneyTree //摇钱树功能模块  
 { 
@@ -209,33 +456,102 @@ struct MoneyTree //摇钱树功能模块
         statSum = 0; 
         statCount = 0; 
     } 
-    MoneyTree(const unsigned int & lastTime, const unsigned int & freeCount, const unsigned int & payCount, const unsigned int & statSum, const unsigned int & statCount) 
+    MoneyTree(unsigned int lastTime, unsigned int freeCount, unsigned int payCount, unsigned int statSum, unsigned int statCount) : lastTime(lastTime), freeCount(freeCount), payCount(payCount), statSum(statSum), statCount(statCount) 
+    { 
+    } 
+    MoneyTree(const MoneyTree &) = default; 
+    MoneyTree(MoneyTree &&) noexcept = default; 
+    MoneyTree & operator = (const MoneyTree &) = default; 
+    MoneyTree & operator = (MoneyTree &&) noexcept = default; 
+    static constexpr unsigned int getMemberCount() { return 5;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("lastTime", "ui32", 0, &MoneyTree::lastTime)); 
+        visitor(zsummer::proto4z::makeProtoMember("freeCount", "ui32", 0, &MoneyTree::freeCount)); 
+        visitor(zsummer::proto4z::makeProtoMember("payCount", "ui32", 0, &MoneyTree::payCount)); 
+        visitor(zsummer::proto4z::makeProtoMember("statSum", "ui32", 0, &MoneyTree::statSum)); 
+        visitor(zsummer::proto4z::makeProtoMember("statCount", "ui32", 0, &MoneyTree::statCount)); 
+    } 
+    inline void reset() 
+    { 
+        zsummer::proto4z::resetMember(lastTime); 
+        zsummer::proto4z::resetMember(freeCount); 
+        zsummer::proto4z::resetMember(payCount); 
+        zsummer::proto4z::resetMember(statSum); 
+        zsummer::proto4z::resetMember(statCount); 
+    } 
+    inline size_t memoryUsage() const 
+    { 
+        return sizeof(*this); 
+    } 
+    static const zsummer::proto4z::Integer FixedWireSize = 20; 
+    inline void fixedEncode(char * stream) const 
     { 
-        this->lastTime = lastTime; 
-        this->freeCount = freeCount; 
-        this->payCount = payCount; 
-        this->statSum = statSum; 
-        this->statCount = statCount; 
+        memcpy(stream + 0, &lastTime, 4); 
+        memcpy(stream + 4, &freeCount, 4); 
+        memcpy(stream + 8, &payCount, 4); 
+        memcpy(stream + 12, &statSum, 4); 
+        memcpy(stream + 16, &statCount, 4); 
+    } 
+    inline void fixedDecode(const char * stream) 
+    { 
+        memcpy(&lastTime, stream + 0, 4); 
+        memcpy(&freeCount, stream + 4, 4); 
+        memcpy(&payCount, stream + 8, 4); 
+        memcpy(&statSum, stream + 12, 4); 
+        memcpy(&statCount, stream + 16, 4); 
     } 
 }; 
+static_assert(sizeof(MoneyTree::lastTime) + sizeof(MoneyTree::freeCount) + sizeof(MoneyTree::payCount) + sizeof(MoneyTree::statSum) + sizeof(MoneyTree::statCount) == MoneyTree::FixedWireSize, "MoneyTree fixed wire layout error."); 
 inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const MoneyTree & data) 
 { 
-    ws << data.lastTime;  
-    ws << data.freeCount;  
-    ws << data.payCount;  
-    ws << data.statSum;  
-    ws << data.statCount;  
+    char stream[MoneyTree::FixedWireSize]; 
+    data.fixedEncode(stream); 
+    ws.appendOriginalData(stream, MoneyTree::FixedWireSize); 
     return ws; 
 } 
 inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, MoneyTree & data) 
 { 
-    rs >> data.lastTime;  
-    rs >> data.freeCount;  
-    rs >> data.payCount;  
-    rs >> data.statSum;  
-    rs >> data.statCount;  
+    data.fixedDecode(rs.peekOriginalData(MoneyTree::FixedWireSize)); 
+    rs.skipOriginalData(MoneyTree::FixedWireSize); 
     return rs; 
 } 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const MoneyTree & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 5); 
+    pushLua(L, data.lastTime); lua_setfield(L, -2, "lastTime"); 
+    pushLua(L, data.freeCount); lua_setfield(L, -2, "freeCount"); 
+    pushLua(L, data.payCount); lua_setfield(L, -2, "payCount"); 
+    pushLua(L, data.statSum); lua_setfield(L, -2, "statSum"); 
+    pushLua(L, data.statCount); lua_setfield(L, -2, "statCount"); 
+} 
+inline void readLua(lua_State * L, int index, MoneyTree & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "lastTime"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.lastTime); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "freeCount"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.freeCount); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "payCount"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.payCount); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "statSum"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.statSum); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "statCount"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.statCount); 
+    lua_pop(L, 1); 
+} 
+#endif 
  
 struct SimplePack //简单示例  
 { 
@@ -250,12 +566,32 @@ struct SimplePack //简单示例
         id = 0; 
         createTime = 0; 
     } 
-    SimplePack(const unsigned int & id, const std::string & name, const unsigned int & createTime, const MoneyTree & moneyTree) 
+    SimplePack(unsigned int id, std::string name, unsigned int createTime, MoneyTree moneyTree) : id(id), name(std::move(name)), createTime(createTime), moneyTree(std::move(moneyTree)) 
+    { 
+    } 
+    SimplePack(const SimplePack &) = default; 
+    SimplePack(SimplePack &&) noexcept = default; 
+    SimplePack & operator = (const SimplePack &) = default; 
+    SimplePack & operator = (SimplePack &&) noexcept = default; 
+    static constexpr unsigned int getMemberCount() { return 4;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("id", "ui32", 9, &SimplePack::id)); 
+        visitor(zsummer::proto4z::makeProtoMember("name", "string", 2, &SimplePack::name)); 
+        visitor(zsummer::proto4z::makeProtoMember("createTime", "ui32", 4, &SimplePack::createTime)); 
+        visitor(zsummer::proto4z::makeProtoMember("moneyTree", "MoneyTree", 0, &SimplePack::moneyTree)); 
+    } 
+    inline void reset() 
+    { 
+        zsummer::proto4z::resetMember(id); 
+        zsummer::proto4z::resetMember(name); 
+        zsummer::proto4z::resetMember(createTime); 
+        zsummer::proto4z::resetMember(moneyTree); 
+    } 
+    inline size_t memoryUsage() const 
     { 
-        this->id = id; 
-        this->name = name; 
-        this->createTime = createTime; 
-        this->moneyTree = moneyTree; 
+        return sizeof(*this) + zsummer::proto4z::heapUsage(name) + zsummer::proto4z::heapUsage(moneyTree); 
     } 
 }; 
 inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const SimplePack & data) 
@@ -274,5 +610,894 @@ inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream
     rs >> data.moneyTree;  
     return rs; 
 } 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const SimplePack & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 4); 
+    pushLua(L, data.id); lua_setfield(L, -2, "id"); 
+    pushLua(L, data.name); lua_setfield(L, -2, "name"); 
+    pushLua(L, data.createTime); lua_setfield(L, -2, "createTime"); 
+    pushLua(L, data.moneyTree); lua_setfield(L, -2, "moneyTree"); 
+} 
+inline void readLua(lua_State * L, int index, SimplePack & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "id"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.id); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "name"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.name); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "createTime"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.createTime); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "moneyTree"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.moneyTree); 
+    lua_pop(L, 1); 
+} 
+#endif 
+ 
+struct SparsePack //tagged示例, 只编码tag中存在的成员  
+{ 
+    static const unsigned short getProtoID() { return 30006;} 
+    static const std::string getProtoName() { return "SparsePack";} 
+    unsigned int id;  
+    std::string name;  
+    IntegerDataArray iarray;  
+    MoneyTree moneyTree;  
+    double value;  
+    zsummer::proto4z::ProtoTag __tag = 31ULL; //member presence, bit n-1 for member n  
+    SparsePack() 
+    { 
+        id = 0; 
+        value = 0.0; 
+    } 
+    SparsePack(unsigned int id, std::string name, IntegerDataArray iarray, MoneyTree moneyTree, double value) : id(id), name(std::move(name)), iarray(std::move(iarray)), moneyTree(std::move(moneyTree)), value(value) 
+    { 
+    } 
+    SparsePack(const SparsePack &) = default; 
+    SparsePack(SparsePack &&) noexcept = default; 
+    SparsePack & operator = (const SparsePack &) = default; 
+    SparsePack & operator = (SparsePack &&) noexcept = default; 
+    template<class ... Args> 
+    inline IntegerData & emplaceIarray(Args && ... args) { iarray.emplace_back(std::forward<Args>(args)...); return iarray.back(); } 
+    inline SparsePack & setTag(int n) { __tag |= (1ULL << (n - 1)); return *this; } 
+    inline SparsePack & unsetTag(int n) { __tag &= ~(1ULL << (n - 1)); return *this; } 
+    inline SparsePack & clearTag() { __tag = 0; return *this; } 
+    inline bool testTag(int n) const { return (__tag & (1ULL << (n - 1))) != 0; } 
+    static const bool MemberWise = false; //wire layout is not one value per member, reflectWrite/reflectRead not usable 
+    static constexpr unsigned int getMemberCount() { return 5;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("id", "ui32", 0, &SparsePack::id)); 
+        visitor(zsummer::proto4z::makeProtoMember("name", "string", 0, &SparsePack::name)); 
+        visitor(zsummer::proto4z::makeProtoMember("iarray", "IntegerDataArray", 0, &SparsePack::iarray)); 
+        visitor(zsummer::proto4z::makeProtoMember("moneyTree", "MoneyTree", 0, &SparsePack::moneyTree)); 
+        visitor(zsummer::proto4z::makeProtoMember("value", "double", 0, &SparsePack::value)); 
+    } 
+    inline void reset() 
+    { 
+        zsummer::proto4z::resetMember(id); 
+        zsummer::proto4z::resetMember(name); 
+        zsummer::proto4z::resetMember(iarray); 
+        zsummer::proto4z::resetMember(moneyTree); 
+        zsummer::proto4z::resetMember(value); 
+        __tag = 31ULL; 
+    } 
+    inline size_t memoryUsage() const 
+    { 
+        return sizeof(*this) + zsummer::proto4z::heapUsage(name) + zsummer::proto4z::heapUsage(iarray) + zsummer::proto4z::heapUsage(moneyTree); 
+    } 
+}; 
+inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const SparsePack & data) 
+{ 
+    zsummer::proto4z::Integer pos = zsummer::proto4z::beginTaggedWrite(ws, data.__tag & 31ULL); 
+    if (data.testTag(1)) ws << data.id; 
+    if (data.testTag(2)) ws << data.name; 
+    if (data.testTag(3)) ws << data.iarray; 
+    if (data.testTag(4)) ws << data.moneyTree; 
+    if (data.testTag(5)) ws << data.value; 
+    zsummer::proto4z::endTaggedWrite(ws, pos); 
+    return ws; 
+} 
+inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, SparsePack & data) 
+{ 
+    zsummer::proto4z::Integer tail = zsummer::proto4z::beginTaggedRead(rs, data.__tag); 
+    if (data.testTag(1)) rs >> data.id; 
+    if (data.testTag(2)) rs >> data.name; 
+    if (data.testTag(3)) rs >> data.iarray; 
+    if (data.testTag(4)) rs >> data.moneyTree; 
+    if (data.testTag(5)) rs >> data.value; 
+    zsummer::proto4z::endTaggedRead(rs, tail); 
+    return rs; 
+} 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const SparsePack & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 5); 
+    if (data.testTag(1)) { pushLua(L, data.id); lua_setfield(L, -2, "id"); } 
+    if (data.testTag(2)) { pushLua(L, data.name); lua_setfield(L, -2, "name"); } 
+    if (data.testTag(3)) { pushLua(L, data.iarray); lua_setfield(L, -2, "iarray"); } 
+    if (data.testTag(4)) { pushLua(L, data.moneyTree); lua_setfield(L, -2, "moneyTree"); } 
+    if (data.testTag(5)) { pushLua(L, data.value); lua_setfield(L, -2, "value"); } 
+} 
+inline void readLua(lua_State * L, int index, SparsePack & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "id"); 
+    if (lua_isnil(L, -1)) data.unsetTag(1); else { readLua(L, -1, data.id); data.setTag(1); } 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "name"); 
+    if (lua_isnil(L, -1)) data.unsetTag(2); else { readLua(L, -1, data.name); data.setTag(2); } 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "iarray"); 
+    if (lua_isnil(L, -1)) data.unsetTag(3); else { readLua(L, -1, data.iarray); data.setTag(3); } 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "moneyTree"); 
+    if (lua_isnil(L, -1)) data.unsetTag(4); else { readLua(L, -1, data.moneyTree); data.setTag(4); } 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "value"); 
+    if (lua_isnil(L, -1)) data.unsetTag(5); else { readLua(L, -1, data.value); data.setTag(5); } 
+    lua_pop(L, 1); 
+} 
+#endif 
+ 
+struct SparsePackNext //SparsePack的新版本, 追加了成员  
+{ 
+    static const unsigned short getProtoID() { return 30007;} 
+    static const std::string getProtoName() { return "SparsePackNext";} 
+    unsigned int id;  
+    std::string name;  
+    IntegerDataArray iarray;  
+    MoneyTree moneyTree;  
+    double value;  
+    unsigned long long extra;  
+    zsummer::proto4z::ProtoTag __tag = 63ULL; //member presence, bit n-1 for member n  
+    SparsePackNext() 
+    { 
+        id = 0; 
+        value = 0.0; 
+        extra = 0; 
+    } 
+    SparsePackNext(unsigned int id, std::string name, IntegerDataArray iarray, MoneyTree moneyTree, double value, unsigned long long extra) : id(id), name(std::move(name)), iarray(std::move(iarray)), moneyTree(std::move(moneyTree)), value(value), extra(extra) 
+    { 
+    } 
+    SparsePackNext(const SparsePackNext &) = default; 
+    SparsePackNext(SparsePackNext &&) noexcept = default; 
+    SparsePackNext & operator = (const SparsePackNext &) = default; 
+    SparsePackNext & operator = (SparsePackNext &&) noexcept = default; 
+    template<class ... Args> 
+    inline IntegerData & emplaceIarray(Args && ... args) { iarray.emplace_back(std::forward<Args>(args)...); return iarray.back(); } 
+    inline SparsePackNext & setTag(int n) { __tag |= (1ULL << (n - 1)); return *this; } 
+    inline SparsePackNext & unsetTag(int n) { __tag &= ~(1ULL << (n - 1)); return *this; } 
+    inline SparsePackNext & clearTag() { __tag = 0; return *this; } 
+    inline bool testTag(int n) const { return (__tag & (1ULL << (n - 1))) != 0; } 
+    static const bool MemberWise = false; //wire layout is not one value per member, reflectWrite/reflectRead not usable 
+    static constexpr unsigned int getMemberCount() { return 6;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("id", "ui32", 0, &SparsePackNext::id)); 
+        visitor(zsummer::proto4z::makeProtoMember("name", "string", 0, &SparsePackNext::name)); 
+        visitor(zsummer::proto4z::makeProtoMember("iarray", "IntegerDataArray", 0, &SparsePackNext::iarray)); 
+        visitor(zsummer::proto4z::makeProtoMember("moneyTree", "MoneyTree", 0, &SparsePackNext::moneyTree)); 
+        visitor(zsummer::proto4z::makeProtoMember("value", "double", 0, &SparsePackNext::value)); 
+        visitor(zsummer::proto4z::makeProtoMember("extra", "ui64", 0, &SparsePackNext::extra)); 
+    } 
+    inline void reset() 
+    { 
+        zsummer::proto4z::resetMember(id); 
+        zsummer::proto4z::resetMember(name); 
+        zsummer::proto4z::resetMember(iarray); 
+        zsummer::proto4z::resetMember(moneyTree); 
+        zsummer::proto4z::resetMember(value); 
+        zsummer::proto4z::resetMember(extra); 
+        __tag = 63ULL; 
+    } 
+    inline size_t memoryUsage() const 
+    { 
+        return sizeof(*this) + zsummer::proto4z::heapUsage(name) + zsummer::proto4z::heapUsage(iarray) + zsummer::proto4z::heapUsage(moneyTree); 
+    } 
+}; 
+inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const SparsePackNext & data) 
+{ 
+    zsummer::proto4z::Integer pos = zsummer::proto4z::beginTaggedWrite(ws, data.__tag & 63ULL); 
+    if (data.testTag(1)) ws << data.id; 
+    if (data.testTag(2)) ws << data.name; 
+    if (data.testTag(3)) ws << data.iarray; 
+    if (data.testTag(4)) ws << data.moneyTree; 
+    if (data.testTag(5)) ws << data.value; 
+    if (data.testTag(6)) ws << data.extra; 
+    zsummer::proto4z::endTaggedWrite(ws, pos); 
+    return ws; 
+} 
+inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, SparsePackNext & data) 
+{ 
+    zsummer::proto4z::Integer tail = zsummer::proto4z::beginTaggedRead(rs, data.__tag); 
+    if (data.testTag(1)) rs >> data.id; 
+    if (data.testTag(2)) rs >> data.name; 
+    if (data.testTag(3)) rs >> data.iarray; 
+    if (data.testTag(4)) rs >> data.moneyTree; 
+    if (data.testTag(5)) rs >> data.value; 
+    if (data.testTag(6)) rs >> data.extra; 
+    zsummer::proto4z::endTaggedRead(rs, tail); 
+    return rs; 
+} 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const SparsePackNext & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 6); 
+    if (data.testTag(1)) { pushLua(L, data.id); lua_setfield(L, -2, "id"); } 
+    if (data.testTag(2)) { pushLua(L, data.name); lua_setfield(L, -2, "name"); } 
+    if (data.testTag(3)) { pushLua(L, data.iarray); lua_setfield(L, -2, "iarray"); } 
+    if (data.testTag(4)) { pushLua(L, data.moneyTree); lua_setfield(L, -2, "moneyTree"); } 
+    if (data.testTag(5)) { pushLua(L, data.value); lua_setfield(L, -2, "value"); } 
+    if (data.testTag(6)) { pushLua(L, data.extra); lua_setfield(L, -2, "extra"); } 
+} 
+inline void readLua(lua_State * L, int index, SparsePackNext & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "id"); 
+    if (lua_isnil(L, -1)) data.unsetTag(1); else { readLua(L, -1, data.id); data.setTag(1); } 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "name"); 
+    if (lua_isnil(L, -1)) data.unsetTag(2); else { readLua(L, -1, data.name); data.setTag(2); } 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "iarray"); 
+    if (lua_isnil(L, -1)) data.unsetTag(3); else { readLua(L, -1, data.iarray); data.setTag(3); } 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "moneyTree"); 
+    if (lua_isnil(L, -1)) data.unsetTag(4); else { readLua(L, -1, data.moneyTree); data.setTag(4); } 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "value"); 
+    if (lua_isnil(L, -1)) data.unsetTag(5); else { readLua(L, -1, data.value); data.setTag(5); } 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "extra"); 
+    if (lua_isnil(L, -1)) data.unsetTag(6); else { readLua(L, -1, data.extra); data.setTag(6); } 
+    lua_pop(L, 1); 
+} 
+#endif 
+ 
+ 
+struct IntegerDataColumns : public std::vector<IntegerData> //按列编码  
+{ 
+    using std::vector<IntegerData>::vector; 
+}; 
+inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const IntegerDataColumns & data) 
+{ 
+    ws << (zsummer::proto4z::Integer)data.size(); 
+    zsummer::proto4z::writeColumn(ws, data, &IntegerData::_char); 
+    zsummer::proto4z::writeColumn(ws, data, &IntegerData::_uchar); 
+    zsummer::proto4z::writeColumn(ws, data, &IntegerData::_short); 
+    zsummer::proto4z::writeColumn(ws, data, &IntegerData::_ushort); 
+    zsummer::proto4z::writeColumn(ws, data, &IntegerData::_int); 
+    zsummer::proto4z::writeColumn(ws, data, &IntegerData::_uint); 
+    zsummer::proto4z::writeColumn(ws, data, &IntegerData::_i64); 
+    zsummer::proto4z::writeColumn(ws, data, &IntegerData::_ui64); 
+    return ws; 
+} 
+inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, IntegerDataColumns & data) 
+{ 
+    zsummer::proto4z::Integer totalCount = 0; 
+    rs >> totalCount; 
+    if (totalCount > rs.getStreamUnreadLen() / 30) 
+    { 
+        PROTO4Z_THROW("IntegerDataColumns column count over stream. totalCount=" << totalCount); 
+    } 
+    data.clear(); 
+    data.resize(totalCount); 
+    auto column0 = zsummer::proto4z::peekColumn(rs, data, &IntegerData::_char); 
+    auto column1 = zsummer::proto4z::peekColumn(rs, data, &IntegerData::_uchar); 
+    auto column2 = zsummer::proto4z::peekColumn(rs, data, &IntegerData::_short); 
+    auto column3 = zsummer::proto4z::peekColumn(rs, data, &IntegerData::_ushort); 
+    auto column4 = zsummer::proto4z::peekColumn(rs, data, &IntegerData::_int); 
+    auto column5 = zsummer::proto4z::peekColumn(rs, data, &IntegerData::_uint); 
+    auto column6 = zsummer::proto4z::peekColumn(rs, data, &IntegerData::_i64); 
+    auto column7 = zsummer::proto4z::peekColumn(rs, data, &IntegerData::_ui64); 
+    zsummer::proto4z::scatterColumns(data, column0, column1, column2, column3, column4, column5, column6, column7); 
+    return rs; 
+} 
+ 
+ 
+struct StringDataColumns : public std::vector<StringData> //按列编码  
+{ 
+    using std::vector<StringData>::vector; 
+}; 
+inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const StringDataColumns & data) 
+{ 
+    ws << (zsummer::proto4z::Integer)data.size(); 
+    zsummer::proto4z::writeColumn(ws, data, &StringData::_string); 
+    return ws; 
+} 
+inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, StringDataColumns & data) 
+{ 
+    zsummer::proto4z::Integer totalCount = 0; 
+    rs >> totalCount; 
+    if (totalCount > rs.getStreamUnreadLen() / 4) 
+    { 
+        PROTO4Z_THROW("StringDataColumns column count over stream. totalCount=" << totalCount); 
+    } 
+    data.clear(); 
+    data.resize(totalCount); 
+    auto column0 = zsummer::proto4z::peekColumn(rs, data, &StringData::_string); 
+    zsummer::proto4z::scatterColumns(data, column0); 
+    return rs; 
+} 
+ 
+ 
+typedef zsummer::proto4z::FixedVector<unsigned int, 8> BuffArray; //最多8个, 内联存储  
+ 
+ 
+typedef zsummer::proto4z::FixedVector<IntegerData, 4> PartyArray; //最多4个, 内联存储  
+ 
+struct BoundedPack //无堆内存分配的示例  
+{ 
+    static const unsigned short getProtoID() { return 30008;} 
+    static const std::string getProtoName() { return "BoundedPack";} 
+    zsummer::proto4z::FixedString<32> name; //最长32字节, 内联存储  
+    BuffArray buffs;  
+    PartyArray party;  
+    BoundedPack() 
+    { 
+    } 
+    BoundedPack(zsummer::proto4z::FixedString<32> name, BuffArray buffs, PartyArray party) : name(std::move(name)), buffs(std::move(buffs)), party(std::move(party)) 
+    { 
+    } 
+    BoundedPack(const BoundedPack &) = default; 
+    BoundedPack(BoundedPack &&) noexcept = default; 
+    BoundedPack & operator = (const BoundedPack &) = default; 
+    BoundedPack & operator = (BoundedPack &&) noexcept = default; 
+    template<class ... Args> 
+    inline unsigned int & emplaceBuffs(Args && ... args) { buffs.emplace_back(std::forward<Args>(args)...); return buffs.back(); } 
+    template<class ... Args> 
+    inline IntegerData & emplaceParty(Args && ... args) { party.emplace_back(std::forward<Args>(args)...); return party.back(); } 
+    static constexpr unsigned int getMemberCount() { return 3;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("name", "string", 0, &BoundedPack::name)); 
+        visitor(zsummer::proto4z::makeProtoMember("buffs", "BuffArray", 0, &BoundedPack::buffs)); 
+        visitor(zsummer::proto4z::makeProtoMember("party", "PartyArray", 0, &BoundedPack::party)); 
+    } 
+    inline void reset() 
+    { 
+        zsummer::proto4z::resetMember(name); 
+        zsummer::proto4z::resetMember(buffs); 
+        zsummer::proto4z::resetMember(party); 
+    } 
+    inline size_t memoryUsage() const 
+    { 
+        return sizeof(*this) + zsummer::proto4z::heapUsage(name) + zsummer::proto4z::heapUsage(buffs) + zsummer::proto4z::heapUsage(party); 
+    } 
+}; 
+inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const BoundedPack & data) 
+{ 
+    ws << data.name;  
+    ws << data.buffs;  
+    ws << data.party;  
+    return ws; 
+} 
+inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, BoundedPack & data) 
+{ 
+    rs >> data.name;  
+    rs >> data.buffs;  
+    rs >> data.party;  
+    return rs; 
+} 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const BoundedPack & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 3); 
+    pushLua(L, data.name); lua_setfield(L, -2, "name"); 
+    pushLua(L, data.buffs); lua_setfield(L, -2, "buffs"); 
+    pushLua(L, data.party); lua_setfield(L, -2, "party"); 
+} 
+inline void readLua(lua_State * L, int index, BoundedPack & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "name"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.name); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "buffs"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.buffs); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "party"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.party); 
+    lua_pop(L, 1); 
+} 
+#endif 
+ 
+struct FlagsPack //bool和bits:N按位打包的示例  
+{ 
+    static const unsigned short getProtoID() { return 30009;} 
+    static const std::string getProtoName() { return "FlagsPack";} 
+    bool online;  
+    unsigned char level; //0~127  
+    unsigned char camp;  
+    bool muted;  
+    unsigned int id; //打断位图  
+    bool hidden;  
+    unsigned long long exp;  
+    FlagsPack() 
+    { 
+        online = false; 
+        level = 0; 
+        camp = 0; 
+        muted = false; 
+        id = 0; 
+        hidden = false; 
+        exp = 0; 
+    } 
+    FlagsPack(bool online, unsigned char level, unsigned char camp, bool muted, unsigned int id, bool hidden, unsigned long long exp) : online(online), level(level), camp(camp), muted(muted), id(id), hidden(hidden), exp(exp) 
+    { 
+    } 
+    FlagsPack(const FlagsPack &) = default; 
+    FlagsPack(FlagsPack &&) noexcept = default; 
+    FlagsPack & operator = (const FlagsPack &) = default; 
+    FlagsPack & operator = (FlagsPack &&) noexcept = default; 
+    static const bool MemberWise = false; //wire layout is not one value per member, reflectWrite/reflectRead not usable 
+    static constexpr unsigned int getMemberCount() { return 7;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("online", "bool", 0, &FlagsPack::online)); 
+        visitor(zsummer::proto4z::makeProtoMember("level", "bits:7", 0, &FlagsPack::level)); 
+        visitor(zsummer::proto4z::makeProtoMember("camp", "bits:3", 0, &FlagsPack::camp)); 
+        visitor(zsummer::proto4z::makeProtoMember("muted", "bool", 0, &FlagsPack::muted)); 
+        visitor(zsummer::proto4z::makeProtoMember("id", "ui32", 0, &FlagsPack::id)); 
+        visitor(zsummer::proto4z::makeProtoMember("hidden", "bool", 0, &FlagsPack::hidden)); 
+        visitor(zsummer::proto4z::makeProtoMember("exp", "bits:40", 0, &FlagsPack::exp)); 
+    } 
+    inline void reset() 
+    { 
+        zsummer::proto4z::resetMember(online); 
+        zsummer::proto4z::resetMember(level); 
+        zsummer::proto4z::resetMember(camp); 
+        zsummer::proto4z::resetMember(muted); 
+        zsummer::proto4z::resetMember(id); 
+        zsummer::proto4z::resetMember(hidden); 
+        zsummer::proto4z::resetMember(exp); 
+    } 
+    inline size_t memoryUsage() const 
+    { 
+        return sizeof(*this); 
+    } 
+}; 
+inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const FlagsPack & data) 
+{ 
+    { 
+        char bits[2] = { 0 }; 
+        zsummer::proto4z::packBits(bits, 0, (unsigned long long)data.online, 1); 
+        zsummer::proto4z::packBits(bits, 1, (unsigned long long)data.level, 7); 
+        zsummer::proto4z::packBits(bits, 8, (unsigned long long)data.camp, 3); 
+        zsummer::proto4z::packBits(bits, 11, (unsigned long long)data.muted, 1); 
+        ws.appendOriginalData(bits, 2); 
+    } 
+    ws << data.id;  
+    { 
+        char bits[6] = { 0 }; 
+        zsummer::proto4z::packBits(bits, 0, (unsigned long long)data.hidden, 1); 
+        zsummer::proto4z::packBits(bits, 1, (unsigned long long)data.exp, 40); 
+        ws.appendOriginalData(bits, 6); 
+    } 
+    return ws; 
+} 
+inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, FlagsPack & data) 
+{ 
+    { 
+        const char * bits = rs.peekOriginalData(2); 
+        data.online = zsummer::proto4z::unpackBits(bits, 0, 1) != 0; 
+        data.level = (unsigned char)zsummer::proto4z::unpackBits(bits, 1, 7); 
+        data.camp = (unsigned char)zsummer::proto4z::unpackBits(bits, 8, 3); 
+        data.muted = zsummer::proto4z::unpackBits(bits, 11, 1) != 0; 
+        rs.skipOriginalData(2); 
+    } 
+    rs >> data.id;  
+    { 
+        const char * bits = rs.peekOriginalData(6); 
+        data.hidden = zsummer::proto4z::unpackBits(bits, 0, 1) != 0; 
+        data.exp = (unsigned long long)zsummer::proto4z::unpackBits(bits, 1, 40); 
+        rs.skipOriginalData(6); 
+    } 
+    return rs; 
+} 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const FlagsPack & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 7); 
+    pushLua(L, data.online); lua_setfield(L, -2, "online"); 
+    pushLua(L, data.level); lua_setfield(L, -2, "level"); 
+    pushLua(L, data.camp); lua_setfield(L, -2, "camp"); 
+    pushLua(L, data.muted); lua_setfield(L, -2, "muted"); 
+    pushLua(L, data.id); lua_setfield(L, -2, "id"); 
+    pushLua(L, data.hidden); lua_setfield(L, -2, "hidden"); 
+    pushLua(L, data.exp); lua_setfield(L, -2, "exp"); 
+} 
+inline void readLua(lua_State * L, int index, FlagsPack & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "online"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.online); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "level"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.level); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "camp"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.camp); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "muted"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.muted); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "id"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.id); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "hidden"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.hidden); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "exp"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.exp); 
+    lua_pop(L, 1); 
+} 
+#endif 
+ 
+struct MovePack //量化坐标和朝向的示例  
+{ 
+    static const unsigned short getProtoID() { return 30010;} 
+    static const std::string getProtoName() { return "MovePack";} 
+    unsigned int eid;  
+    float x; //厘米精度, fixed32最多2^24个刻度  
+    float y;  
+    float z;  
+    float speed;  
+    float yaw; //角度  
+    float pitch;  
+    MovePack() 
+    { 
+        eid = 0; 
+        x = 0.0; 
+        y = 0.0; 
+        z = 0.0; 
+        speed = 0.0; 
+        yaw = 0.0; 
+        pitch = 0.0; 
+    } 
+    MovePack(unsigned int eid, float x, float y, float z, float speed, float yaw, float pitch) : eid(eid), x(x), y(y), z(z), speed(speed), yaw(yaw), pitch(pitch) 
+    { 
+    } 
+    MovePack(const MovePack &) = default; 
+    MovePack(MovePack &&) noexcept = default; 
+    MovePack & operator = (const MovePack &) = default; 
+    MovePack & operator = (MovePack &&) noexcept = default; 
+    static const bool MemberWise = false; //wire layout is not one value per member, reflectWrite/reflectRead not usable 
+    static constexpr unsigned int getMemberCount() { return 7;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("eid", "ui32", 0, &MovePack::eid)); 
+        visitor(zsummer::proto4z::makeProtoMember("x", "fixed32(100000,0.01)", 0, &MovePack::x)); 
+        visitor(zsummer::proto4z::makeProtoMember("y", "fixed32(100000,0.01)", 0, &MovePack::y)); 
+        visitor(zsummer::proto4z::makeProtoMember("z", "fixed16(300,0.01)", 0, &MovePack::z)); 
+        visitor(zsummer::proto4z::makeProtoMember("speed", "fixed8(12.7,0.1)", 0, &MovePack::speed)); 
+        visitor(zsummer::proto4z::makeProtoMember("yaw", "angle16", 0, &MovePack::yaw)); 
+        visitor(zsummer::proto4z::makeProtoMember("pitch", "angle8", 0, &MovePack::pitch)); 
+    } 
+    inline void reset() 
+    { 
+        zsummer::proto4z::resetMember(eid); 
+        zsummer::proto4z::resetMember(x); 
+        zsummer::proto4z::resetMember(y); 
+        zsummer::proto4z::resetMember(z); 
+        zsummer::proto4z::resetMember(speed); 
+        zsummer::proto4z::resetMember(yaw); 
+        zsummer::proto4z::resetMember(pitch); 
+    } 
+    inline size_t memoryUsage() const 
+    { 
+        return sizeof(*this); 
+    } 
+    static const zsummer::proto4z::Integer FixedWireSize = 18; 
+    inline void fixedEncode(char * stream) const 
+    { 
+        memcpy(stream + 0, &eid, 4); 
+        zsummer::proto4z::encodeQuantized(stream + 4, x, zsummer::proto4z::FixedQuantizer<int>(0.01, 10000000)); 
+        zsummer::proto4z::encodeQuantized(stream + 8, y, zsummer::proto4z::FixedQuantizer<int>(0.01, 10000000)); 
+        zsummer::proto4z::encodeQuantized(stream + 12, z, zsummer::proto4z::FixedQuantizer<short>(0.01, 30000)); 
+        zsummer::proto4z::encodeQuantized(stream + 14, speed, zsummer::proto4z::FixedQuantizer<signed char>(0.1, 127)); 
+        zsummer::proto4z::encodeQuantized(stream + 15, yaw, zsummer::proto4z::AngleQuantizer<unsigned short>()); 
+        zsummer::proto4z::encodeQuantized(stream + 17, pitch, zsummer::proto4z::AngleQuantizer<unsigned char>()); 
+    } 
+    inline void fixedDecode(const char * stream) 
+    { 
+        memcpy(&eid, stream + 0, 4); 
+        x = zsummer::proto4z::decodeQuantized(stream + 4, zsummer::proto4z::FixedQuantizer<int>(0.01, 10000000)); 
+        y = zsummer::proto4z::decodeQuantized(stream + 8, zsummer::proto4z::FixedQuantizer<int>(0.01, 10000000)); 
+        z = zsummer::proto4z::decodeQuantized(stream + 12, zsummer::proto4z::FixedQuantizer<short>(0.01, 30000)); 
+        speed = zsummer::proto4z::decodeQuantized(stream + 14, zsummer::proto4z::FixedQuantizer<signed char>(0.1, 127)); 
+        yaw = zsummer::proto4z::decodeQuantized(stream + 15, zsummer::proto4z::AngleQuantizer<unsigned short>()); 
+        pitch = zsummer::proto4z::decodeQuantized(stream + 17, zsummer::proto4z::AngleQuantizer<unsigned char>()); 
+    } 
+}; 
+static_assert(sizeof(MovePack::eid) + sizeof(int) + sizeof(int) + sizeof(short) + sizeof(char) + sizeof(unsigned short) + sizeof(unsigned char) == MovePack::FixedWireSize, "MovePack fixed wire layout error."); 
+inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const MovePack & data) 
+{ 
+    char stream[MovePack::FixedWireSize]; 
+    data.fixedEncode(stream); 
+    ws.appendOriginalData(stream, MovePack::FixedWireSize); 
+    return ws; 
+} 
+inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, MovePack & data) 
+{ 
+    data.fixedDecode(rs.peekOriginalData(MovePack::FixedWireSize)); 
+    rs.skipOriginalData(MovePack::FixedWireSize); 
+    return rs; 
+} 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const MovePack & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 7); 
+    pushLua(L, data.eid); lua_setfield(L, -2, "eid"); 
+    pushLua(L, data.x); lua_setfield(L, -2, "x"); 
+    pushLua(L, data.y); lua_setfield(L, -2, "y"); 
+    pushLua(L, data.z); lua_setfield(L, -2, "z"); 
+    pushLua(L, data.speed); lua_setfield(L, -2, "speed"); 
+    pushLua(L, data.yaw); lua_setfield(L, -2, "yaw"); 
+    pushLua(L, data.pitch); lua_setfield(L, -2, "pitch"); 
+} 
+inline void readLua(lua_State * L, int index, MovePack & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "eid"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.eid); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "x"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.x); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "y"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.y); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "z"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.z); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "speed"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.speed); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "yaw"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.yaw); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "pitch"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.pitch); 
+    lua_pop(L, 1); 
+} 
+#endif 
+ 
+ 
+struct PathArray : public std::vector<float> //量化数组  
+{ 
+    using std::vector<float>::vector; 
+}; 
+inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const PathArray & data) 
+{ 
+    zsummer::proto4z::writeQuantizedArray(ws, data, zsummer::proto4z::FixedQuantizer<short>(0.01, 30000)); 
+    return ws; 
+} 
+inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, PathArray & data) 
+{ 
+    zsummer::proto4z::readQuantizedArray(rs, data, zsummer::proto4z::FixedQuantizer<short>(0.01, 30000)); 
+    return rs; 
+} 
+ 
+struct PathPack 
+{ 
+    static const unsigned short getProtoID() { return 30011;} 
+    static const std::string getProtoName() { return "PathPack";} 
+    unsigned int eid;  
+    PathArray path;  
+    float heading;  
+    PathPack() 
+    { 
+        eid = 0; 
+        heading = 0.0; 
+    } 
+    PathPack(unsigned int eid, PathArray path, float heading) : eid(eid), path(std::move(path)), heading(heading) 
+    { 
+    } 
+    PathPack(const PathPack &) = default; 
+    PathPack(PathPack &&) noexcept = default; 
+    PathPack & operator = (const PathPack &) = default; 
+    PathPack & operator = (PathPack &&) noexcept = default; 
+    template<class ... Args> 
+    inline float & emplacePath(Args && ... args) { path.emplace_back(std::forward<Args>(args)...); return path.back(); } 
+    static const bool MemberWise = false; //wire layout is not one value per member, reflectWrite/reflectRead not usable 
+    static constexpr unsigned int getMemberCount() { return 3;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("eid", "ui32", 0, &PathPack::eid)); 
+        visitor(zsummer::proto4z::makeProtoMember("path", "PathArray", 0, &PathPack::path)); 
+        visitor(zsummer::proto4z::makeProtoMember("heading", "angle16", 0, &PathPack::heading)); 
+    } 
+    inline void reset() 
+    { 
+        zsummer::proto4z::resetMember(eid); 
+        zsummer::proto4z::resetMember(path); 
+        zsummer::proto4z::resetMember(heading); 
+    } 
+    inline size_t memoryUsage() const 
+    { 
+        return sizeof(*this) + zsummer::proto4z::heapUsage(path); 
+    } 
+}; 
+inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const PathPack & data) 
+{ 
+    ws << data.eid;  
+    ws << data.path;  
+    zsummer::proto4z::writeQuantized(ws, data.heading, zsummer::proto4z::AngleQuantizer<unsigned short>());  
+    return ws; 
+} 
+inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, PathPack & data) 
+{ 
+    rs >> data.eid;  
+    rs >> data.path;  
+    data.heading = zsummer::proto4z::readQuantized(rs, zsummer::proto4z::AngleQuantizer<unsigned short>());  
+    return rs; 
+} 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const PathPack & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 3); 
+    pushLua(L, data.eid); lua_setfield(L, -2, "eid"); 
+    pushLua(L, data.path); lua_setfield(L, -2, "path"); 
+    pushLua(L, data.heading); lua_setfield(L, -2, "heading"); 
+} 
+inline void readLua(lua_State * L, int index, PathPack & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "eid"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.eid); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "path"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.path); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "heading"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.heading); 
+    lua_pop(L, 1); 
+} 
+#endif 
+ 
+ 
+typedef zsummer::proto4z::FlatMap<unsigned int, IntegerData> ItemFlatMap; //有序数组实现, 读多写少  
+ 
+ 
+typedef std::unordered_map<std::string, unsigned int> AttrHashMap; //哈希表实现  
+ 
+struct BagPack 
+{ 
+    static const unsigned short getProtoID() { return 30012;} 
+    static const std::string getProtoName() { return "BagPack";} 
+    ItemFlatMap items;  
+    AttrHashMap attrs;  
+    BagPack() 
+    { 
+    } 
+    BagPack(ItemFlatMap items, AttrHashMap attrs) : items(std::move(items)), attrs(std::move(attrs)) 
+    { 
+    } 
+    BagPack(const BagPack &) = default; 
+    BagPack(BagPack &&) noexcept = default; 
+    BagPack & operator = (const BagPack &) = default; 
+    BagPack & operator = (BagPack &&) noexcept = default; 
+    template<class Key, class ... Args> 
+    inline ItemFlatMap::mapped_type & emplaceItems(Key && key, Args && ... args) { return items.emplace(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...)).first->second; } 
+    template<class Key, class ... Args> 
+    inline AttrHashMap::mapped_type & emplaceAttrs(Key && key, Args && ... args) { return attrs.emplace(std::piecewise_construct, std::forward_as_tuple(std::forward<Key>(key)), std::forward_as_tuple(std::forward<Args>(args)...)).first->second; } 
+    static constexpr unsigned int getMemberCount() { return 2;} 
+    template<class Visitor> 
+    static void forEachMember(Visitor && visitor) 
+    { 
+        visitor(zsummer::proto4z::makeProtoMember("items", "ItemFlatMap", 0, &BagPack::items)); 
+        visitor(zsummer::proto4z::makeProtoMember("attrs", "AttrHashMap", 0, &BagPack::attrs)); 
+    } 
+    inline void reset() 
+    { 
+        zsummer::proto4z::resetMember(items); 
+        zsummer::proto4z::resetMember(attrs); 
+    } 
+    inline size_t memoryUsage() const 
+    { 
+        return sizeof(*this) + zsummer::proto4z::heapUsage(items) + zsummer::proto4z::heapUsage(attrs); 
+    } 
+}; 
+inline zsummer::proto4z::WriteStream & operator << (zsummer::proto4z::WriteStream & ws, const BagPack & data) 
+{ 
+    ws << data.items;  
+    ws << data.attrs;  
+    return ws; 
+} 
+inline zsummer::proto4z::ReadStream & operator >> (zsummer::proto4z::ReadStream & rs, BagPack & data) 
+{ 
+    rs >> data.items;  
+    rs >> data.attrs;  
+    return rs; 
+} 
+#ifdef PROTO4Z_WITH_LUA 
+inline void pushLua(lua_State * L, const BagPack & data) 
+{ 
+    using zsummer::proto4z::pushLua; 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_createtable(L, 0, 2); 
+    pushLua(L, data.items); lua_setfield(L, -2, "items"); 
+    pushLua(L, data.attrs); lua_setfield(L, -2, "attrs"); 
+} 
+inline void readLua(lua_State * L, int index, BagPack & data) 
+{ 
+    using zsummer::proto4z::readLua; 
+    if (!lua_istable(L, index)) zsummer::proto4z::throwLuaType(L, index, "table"); 
+    index = lua_absindex(L, index); 
+    zsummer::proto4z::checkLuaStack(L, 3); 
+    lua_getfield(L, index, "items"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.items); 
+    lua_pop(L, 1); 
+    lua_getfield(L, index, "attrs"); 
+    if (!lua_isnil(L, -1)) readLua(L, -1, data.attrs); 
+    lua_pop(L, 1); 
+} 
+#endif 
+ 
+typedef zsummer::proto4z::ProtoDispatcher<30000, 13> TestProtoDispatcher; 
+ 
+struct TestProtoProtoIndex //protoID <-> protoName lookup 
+{ 
+    static const unsigned short MinProtoID = 30000; 
+    static const unsigned short MaxProtoID = 30012; 
+    static const char * getProtoName(unsigned short protoID) 
+    { 
+        static const char * names[] = { "IntegerData", "FloatData", "StringData", "EchoPack", "MoneyTree", "SimplePack", "SparsePack", "SparsePackNext", "BoundedPack", "FlagsPack", "MovePack", "PathPack", "BagPack" }; 
+        if (protoID < MinProtoID || protoID > MaxProtoID) return nullptr; 
+        return names[protoID - MinProtoID]; 
+    } 
+    static unsigned short getProtoID(const char * name, size_t len) 
+    { 
+        struct Slot { const char * name; size_t len; unsigned short protoID; }; 
+        static const Slot slots[32] = { { "MoneyTree", 9, 30004 }, { "SimplePack", 10, 30005 }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "PathPack", 8, 30011 }, { "BoundedPack", 11, 30008 }, { "MovePack", 8, 30010 }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "SparsePack", 10, 30006 }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "BagPack", 7, 30012 }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "EchoPack", 8, 30003 }, { "FlagsPack", 9, 30009 }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "FloatData", 9, 30001 }, { "SparsePackNext", 14, 30007 }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "", 0, zsummer::proto4z::InvalidProtoID }, { "IntegerData", 11, 30000 }, { "StringData", 10, 30002 }, { "", 0, zsummer::proto4z::InvalidProtoID } }; 
+        const Slot & slot = slots[zsummer::proto4z::protoNameHash(name, len, 9U) & 31]; 
+        return slot.len == len && memcmp(slot.name, name, len) == 0 ? slot.protoID : zsummer::proto4z::InvalidProtoID; 
+    } 
+}; 
  
 #endif 
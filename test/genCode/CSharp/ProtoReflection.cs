@@ -0,0 +1,80 @@
+
+namespace Proto4z
+{
+    static class Reflection
+    {
+        public static ushort getProtoID(string protoName)
+        {
+            try
+            {
+                return _nameToID[protoName];
+            }
+            catch (System.Exception)
+            {
+            }
+            return 0;
+        }
+        public static string getProtoName(ushort protoID)
+        {
+            try
+            {
+                return _idToName[protoID];
+            }
+            catch (System.Exception)
+            {
+            }
+            return "UnknownProtoID_" + protoID;
+        }
+        public static string getErrorDesc(ushort errCode)
+        {
+            try
+            {
+                return _errCodes[errCode];
+            }
+            catch (System.Exception)
+            {
+            }
+            return "UnknownErrorCode_" + errCode;
+        }
+        static System.Collections.Generic.Dictionary<string, ushort> _nameToID = new System.Collections.Generic.Dictionary<string, ushort>();
+        static System.Collections.Generic.Dictionary<ushort, string> _idToName = new System.Collections.Generic.Dictionary<ushort, string>();
+        static System.Collections.Generic.Dictionary<ushort, string> _errCodes = new System.Collections.Generic.Dictionary<ushort, string>();
+        static Reflection()
+        {
+        
+
+                    
+            _nameToID.Add("IntegerData", 30000);
+            _idToName.Add(30000, "IntegerData");
+            _nameToID.Add("FloatData", 30001);
+            _idToName.Add(30001, "FloatData");
+            _nameToID.Add("StringData", 30002);
+            _idToName.Add(30002, "StringData");
+            _nameToID.Add("EchoPack", 30003);
+            _idToName.Add(30003, "EchoPack");
+            _nameToID.Add("MoneyTree", 30004);
+            _idToName.Add(30004, "MoneyTree");
+            _nameToID.Add("SimplePack", 30005);
+            _idToName.Add(30005, "SimplePack");
+            _nameToID.Add("SparsePack", 30006);
+            _idToName.Add(30006, "SparsePack");
+            _nameToID.Add("SparsePackNext", 30007);
+            _idToName.Add(30007, "SparsePackNext");
+            _nameToID.Add("BoundedPack", 30008);
+            _idToName.Add(30008, "BoundedPack");
+            _nameToID.Add("FlagsPack", 30009);
+            _idToName.Add(30009, "FlagsPack");
+            _nameToID.Add("MovePack", 30010);
+            _idToName.Add(30010, "MovePack");
+            _nameToID.Add("PathPack", 30011);
+            _idToName.Add(30011, "PathPack");
+            _nameToID.Add("BagPack", 30012);
+            _idToName.Add(30012, "BagPack");
+            _nameToID.Add("LogPack", 32001);
+            _idToName.Add(32001, "LogPack");
+
+        }
+    }
+}
+
+
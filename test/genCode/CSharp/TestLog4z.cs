@@ -0,0 +1,155 @@
+ 
+namespace Proto4z  
+{ 
+ 
+ 
+    public class LogBuffArray : System.Collections.Generic.List<uint>, Proto4z.IProtoObject //内联存储  
+    { 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var ret = new System.Collections.Generic.List<byte>(); 
+            int len = (int)this.Count; 
+            ret.AddRange(Proto4z.BaseProtoObject.encodeI32(len)); 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeUI32(this[i]));  
+            } 
+            return ret; 
+        } 
+ 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            int len = Proto4z.BaseProtoObject.decodeI32(binData, ref pos); 
+            if(len > 0) 
+            { 
+                for (int i=0; i<len; i++) 
+                { 
+                    this.Add(Proto4z.BaseProtoObject.decodeUI32(binData, ref pos)); 
+                } 
+            } 
+            return pos; 
+        } 
+    } 
+ 
+ 
+    public class LogFlatMap : System.Collections.Generic.Dictionary<uint, string>, Proto4z.IProtoObject //有序数组  
+    { 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var ret = new System.Collections.Generic.List<byte>(); 
+            int len = (int)this.Count; 
+            ret.AddRange(Proto4z.BaseProtoObject.encodeI32(len)); 
+            foreach(var kv in this) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeUI32(kv.Key)); 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeString(kv.Value)); 
+            } 
+            return ret; 
+        } 
+ 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            int len = Proto4z.BaseProtoObject.decodeI32(binData, ref pos); 
+            if(len > 0) 
+            { 
+                for (int i=0; i<len; i++) 
+                { 
+                    var key = Proto4z.BaseProtoObject.decodeUI32(binData, ref pos); 
+                    var val = Proto4z.BaseProtoObject.decodeString(binData, ref pos); 
+                    this.Add(key, val); 
+                } 
+            } 
+            return pos; 
+        } 
+    } 
+ 
+ 
+    public class LogHashMap : System.Collections.Generic.Dictionary<string, uint>, Proto4z.IProtoObject //哈希表  
+    { 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var ret = new System.Collections.Generic.List<byte>(); 
+            int len = (int)this.Count; 
+            ret.AddRange(Proto4z.BaseProtoObject.encodeI32(len)); 
+            foreach(var kv in this) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeString(kv.Key)); 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeUI32(kv.Value)); 
+            } 
+            return ret; 
+        } 
+ 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            int len = Proto4z.BaseProtoObject.decodeI32(binData, ref pos); 
+            if(len > 0) 
+            { 
+                for (int i=0; i<len; i++) 
+                { 
+                    var key = Proto4z.BaseProtoObject.decodeString(binData, ref pos); 
+                    var val = Proto4z.BaseProtoObject.decodeUI32(binData, ref pos); 
+                    this.Add(key, val); 
+                } 
+            } 
+            return pos; 
+        } 
+    } 
+ 
+    public class LogPack: Proto4z.IProtoObject 
+    {     
+        //proto id   
+        public const ushort protoID = 32001;  
+        static public ushort getProtoID() { return 32001; } 
+        static public string getProtoName() { return "LogPack"; } 
+        //members   
+        public uint id;  
+        public string name; //内联存储  
+        public LogBuffArray buffs;  
+        public LogFlatMap flat;  
+        public LogHashMap hash;  
+        public LogPack()  
+        { 
+            id = 0;  
+            name = "";  
+            buffs = new LogBuffArray();  
+            flat = new LogFlatMap();  
+            hash = new LogHashMap();  
+        } 
+        public LogPack(uint id, string name, LogBuffArray buffs, LogFlatMap flat, LogHashMap hash) 
+        { 
+            this.id = id; 
+            this.name = name; 
+            this.buffs = buffs; 
+            this.flat = flat; 
+            this.hash = hash; 
+        } 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var data = new System.Collections.Generic.List<byte>(); 
+            data.AddRange(Proto4z.BaseProtoObject.encodeUI32(this.id)); 
+            data.AddRange(Proto4z.BaseProtoObject.encodeString(this.name)); 
+            if (this.buffs == null) this.buffs = new LogBuffArray(); 
+            data.AddRange(this.buffs.__encode()); 
+            if (this.flat == null) this.flat = new LogFlatMap(); 
+            data.AddRange(this.flat.__encode()); 
+            if (this.hash == null) this.hash = new LogHashMap(); 
+            data.AddRange(this.hash.__encode()); 
+            return data; 
+        } 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            this.id = Proto4z.BaseProtoObject.decodeUI32(binData, ref pos); 
+            this.name = Proto4z.BaseProtoObject.decodeString(binData, ref pos); 
+            this.buffs = new LogBuffArray(); 
+            this.buffs.__decode(binData, ref pos); 
+            this.flat = new LogFlatMap(); 
+            this.flat.__decode(binData, ref pos); 
+            this.hash = new LogHashMap(); 
+            this.hash.__decode(binData, ref pos); 
+            return pos; 
+        } 
+    } 
+ 
+} 
+ 
+ 
@@ -524,6 +524,741 @@ public int __decode(byte[] binData, ref int pos)
         } 
     } 
  
+    public class SparsePack: Proto4z.IProtoObject //tagged示例, 只编码tag中存在的成员  
+    {     
+        //proto id   
+        public const ushort protoID = 30006;  
+        static public ushort getProtoID() { return 30006; } 
+        static public string getProtoName() { return "SparsePack"; } 
+        //members   
+        public uint id;  
+        public string name;  
+        public IntegerDataArray iarray;  
+        public MoneyTree moneyTree;  
+        public double value;  
+        public ulong __tag = 31UL; //member presence, bit n-1 for member n  
+        public void setTag(int n) { __tag |= (1UL << (n - 1)); } 
+        public void unsetTag(int n) { __tag &= ~(1UL << (n - 1)); } 
+        public void clearTag() { __tag = 0; } 
+        public bool testTag(int n) { return (__tag & (1UL << (n - 1))) != 0; } 
+        public SparsePack()  
+        { 
+            id = 0;  
+            name = "";  
+            iarray = new IntegerDataArray();  
+            moneyTree = new MoneyTree();  
+            value = 0.0;  
+        } 
+        public SparsePack(uint id, string name, IntegerDataArray iarray, MoneyTree moneyTree, double value) 
+        { 
+            this.id = id; 
+            this.name = name; 
+            this.iarray = iarray; 
+            this.moneyTree = moneyTree; 
+            this.value = value; 
+        } 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var data = new System.Collections.Generic.List<byte>(); 
+            if (testTag(1)) 
+            { 
+                data.AddRange(Proto4z.BaseProtoObject.encodeUI32(this.id)); 
+            } 
+            if (testTag(2)) 
+            { 
+                data.AddRange(Proto4z.BaseProtoObject.encodeString(this.name)); 
+            } 
+            if (testTag(3)) 
+            { 
+                if (this.iarray == null) this.iarray = new IntegerDataArray(); 
+                data.AddRange(this.iarray.__encode()); 
+            } 
+            if (testTag(4)) 
+            { 
+                if (this.moneyTree == null) this.moneyTree = new MoneyTree(); 
+                data.AddRange(this.moneyTree.__encode()); 
+            } 
+            if (testTag(5)) 
+            { 
+                data.AddRange(Proto4z.BaseProtoObject.encodeDouble(this.value)); 
+            } 
+            var tagged = new System.Collections.Generic.List<byte>(); 
+            tagged.AddRange(Proto4z.BaseProtoObject.encodeUI32((uint)data.Count + 8)); 
+            tagged.AddRange(Proto4z.BaseProtoObject.encodeUI64(__tag & 31UL)); 
+            tagged.AddRange(data); 
+            return tagged; 
+        } 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            int end = (int)Proto4z.BaseProtoObject.decodeUI32(binData, ref pos); 
+            end += pos; 
+            __tag = Proto4z.BaseProtoObject.decodeUI64(binData, ref pos); 
+            if (testTag(1)) 
+            { 
+                this.id = Proto4z.BaseProtoObject.decodeUI32(binData, ref pos); 
+            } 
+            if (testTag(2)) 
+            { 
+                this.name = Proto4z.BaseProtoObject.decodeString(binData, ref pos); 
+            } 
+            if (testTag(3)) 
+            { 
+                this.iarray = new IntegerDataArray(); 
+                this.iarray.__decode(binData, ref pos); 
+            } 
+            if (testTag(4)) 
+            { 
+                this.moneyTree = new MoneyTree(); 
+                this.moneyTree.__decode(binData, ref pos); 
+            } 
+            if (testTag(5)) 
+            { 
+                this.value = Proto4z.BaseProtoObject.decodeDouble(binData, ref pos); 
+            } 
+            pos = end; 
+            return pos; 
+        } 
+    } 
+ 
+    public class SparsePackNext: Proto4z.IProtoObject //SparsePack的新版本, 追加了成员  
+    {     
+        //proto id   
+        public const ushort protoID = 30007;  
+        static public ushort getProtoID() { return 30007; } 
+        static public string getProtoName() { return "SparsePackNext"; } 
+        //members   
+        public uint id;  
+        public string name;  
+        public IntegerDataArray iarray;  
+        public MoneyTree moneyTree;  
+        public double value;  
+        public ulong extra;  
+        public ulong __tag = 63UL; //member presence, bit n-1 for member n  
+        public void setTag(int n) { __tag |= (1UL << (n - 1)); } 
+        public void unsetTag(int n) { __tag &= ~(1UL << (n - 1)); } 
+        public void clearTag() { __tag = 0; } 
+        public bool testTag(int n) { return (__tag & (1UL << (n - 1))) != 0; } 
+        public SparsePackNext()  
+        { 
+            id = 0;  
+            name = "";  
+            iarray = new IntegerDataArray();  
+            moneyTree = new MoneyTree();  
+            value = 0.0;  
+            extra = 0;  
+        } 
+        public SparsePackNext(uint id, string name, IntegerDataArray iarray, MoneyTree moneyTree, double value, ulong extra) 
+        { 
+            this.id = id; 
+            this.name = name; 
+            this.iarray = iarray; 
+            this.moneyTree = moneyTree; 
+            this.value = value; 
+            this.extra = extra; 
+        } 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var data = new System.Collections.Generic.List<byte>(); 
+            if (testTag(1)) 
+            { 
+                data.AddRange(Proto4z.BaseProtoObject.encodeUI32(this.id)); 
+            } 
+            if (testTag(2)) 
+            { 
+                data.AddRange(Proto4z.BaseProtoObject.encodeString(this.name)); 
+            } 
+            if (testTag(3)) 
+            { 
+                if (this.iarray == null) this.iarray = new IntegerDataArray(); 
+                data.AddRange(this.iarray.__encode()); 
+            } 
+            if (testTag(4)) 
+            { 
+                if (this.moneyTree == null) this.moneyTree = new MoneyTree(); 
+                data.AddRange(this.moneyTree.__encode()); 
+            } 
+            if (testTag(5)) 
+            { 
+                data.AddRange(Proto4z.BaseProtoObject.encodeDouble(this.value)); 
+            } 
+            if (testTag(6)) 
+            { 
+                data.AddRange(Proto4z.BaseProtoObject.encodeUI64(this.extra)); 
+            } 
+            var tagged = new System.Collections.Generic.List<byte>(); 
+            tagged.AddRange(Proto4z.BaseProtoObject.encodeUI32((uint)data.Count + 8)); 
+            tagged.AddRange(Proto4z.BaseProtoObject.encodeUI64(__tag & 63UL)); 
+            tagged.AddRange(data); 
+            return tagged; 
+        } 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            int end = (int)Proto4z.BaseProtoObject.decodeUI32(binData, ref pos); 
+            end += pos; 
+            __tag = Proto4z.BaseProtoObject.decodeUI64(binData, ref pos); 
+            if (testTag(1)) 
+            { 
+                this.id = Proto4z.BaseProtoObject.decodeUI32(binData, ref pos); 
+            } 
+            if (testTag(2)) 
+            { 
+                this.name = Proto4z.BaseProtoObject.decodeString(binData, ref pos); 
+            } 
+            if (testTag(3)) 
+            { 
+                this.iarray = new IntegerDataArray(); 
+                this.iarray.__decode(binData, ref pos); 
+            } 
+            if (testTag(4)) 
+            { 
+                this.moneyTree = new MoneyTree(); 
+                this.moneyTree.__decode(binData, ref pos); 
+            } 
+            if (testTag(5)) 
+            { 
+                this.value = Proto4z.BaseProtoObject.decodeDouble(binData, ref pos); 
+            } 
+            if (testTag(6)) 
+            { 
+                this.extra = Proto4z.BaseProtoObject.decodeUI64(binData, ref pos); 
+            } 
+            pos = end; 
+            return pos; 
+        } 
+    } 
+ 
+ 
+    public class IntegerDataColumns : System.Collections.Generic.List<IntegerData>, Proto4z.IProtoObject //按列编码  
+    { 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var ret = new System.Collections.Generic.List<byte>(); 
+            int len = (int)this.Count; 
+            ret.AddRange(Proto4z.BaseProtoObject.encodeI32(len)); 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeI8(this[i]._char)); 
+            } 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeUI8(this[i]._uchar)); 
+            } 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeI16(this[i]._short)); 
+            } 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeUI16(this[i]._ushort)); 
+            } 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeI32(this[i]._int)); 
+            } 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeUI32(this[i]._uint)); 
+            } 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeI64(this[i]._i64)); 
+            } 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeUI64(this[i]._ui64)); 
+            } 
+            return ret; 
+        } 
+ 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            int len = Proto4z.BaseProtoObject.decodeI32(binData, ref pos); 
+            int begin = this.Count; 
+            for (int i = 0; i < len; i++) 
+            { 
+                this.Add(new IntegerData()); 
+            } 
+            for (int i = 0; i < len; i++) 
+            { 
+                this[begin + i]._char = Proto4z.BaseProtoObject.decodeI8(binData, ref pos); 
+            } 
+            for (int i = 0; i < len; i++) 
+            { 
+                this[begin + i]._uchar = Proto4z.BaseProtoObject.decodeUI8(binData, ref pos); 
+            } 
+            for (int i = 0; i < len; i++) 
+            { 
+                this[begin + i]._short = Proto4z.BaseProtoObject.decodeI16(binData, ref pos); 
+            } 
+            for (int i = 0; i < len; i++) 
+            { 
+                this[begin + i]._ushort = Proto4z.BaseProtoObject.decodeUI16(binData, ref pos); 
+            } 
+            for (int i = 0; i < len; i++) 
+            { 
+                this[begin + i]._int = Proto4z.BaseProtoObject.decodeI32(binData, ref pos); 
+            } 
+            for (int i = 0; i < len; i++) 
+            { 
+                this[begin + i]._uint = Proto4z.BaseProtoObject.decodeUI32(binData, ref pos); 
+            } 
+            for (int i = 0; i < len; i++) 
+            { 
+                this[begin + i]._i64 = Proto4z.BaseProtoObject.decodeI64(binData, ref pos); 
+            } 
+            for (int i = 0; i < len; i++) 
+            { 
+                this[begin + i]._ui64 = Proto4z.BaseProtoObject.decodeUI64(binData, ref pos); 
+            } 
+            return pos; 
+        } 
+    } 
+ 
+ 
+    public class StringDataColumns : System.Collections.Generic.List<StringData>, Proto4z.IProtoObject //按列编码  
+    { 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var ret = new System.Collections.Generic.List<byte>(); 
+            int len = (int)this.Count; 
+            ret.AddRange(Proto4z.BaseProtoObject.encodeI32(len)); 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeI32(System.Text.Encoding.UTF8.GetByteCount(this[i]._string))); 
+            } 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(System.Text.Encoding.UTF8.GetBytes(this[i]._string)); 
+            } 
+            return ret; 
+        } 
+ 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            int len = Proto4z.BaseProtoObject.decodeI32(binData, ref pos); 
+            int begin = this.Count; 
+            for (int i = 0; i < len; i++) 
+            { 
+                this.Add(new StringData()); 
+            } 
+            var _stringLens = new int[len]; 
+            for (int i = 0; i < len; i++) 
+            { 
+                _stringLens[i] = Proto4z.BaseProtoObject.decodeI32(binData, ref pos); 
+            } 
+            for (int i = 0; i < len; i++) 
+            { 
+                this[begin + i]._string = System.Text.Encoding.UTF8.GetString(binData, pos, _stringLens[i]); 
+                pos += _stringLens[i]; 
+            } 
+            return pos; 
+        } 
+    } 
+ 
+ 
+    public class BuffArray : System.Collections.Generic.List<uint>, Proto4z.IProtoObject //最多8个, 内联存储  
+    { 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var ret = new System.Collections.Generic.List<byte>(); 
+            int len = (int)this.Count; 
+            ret.AddRange(Proto4z.BaseProtoObject.encodeI32(len)); 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeUI32(this[i]));  
+            } 
+            return ret; 
+        } 
+ 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            int len = Proto4z.BaseProtoObject.decodeI32(binData, ref pos); 
+            if(len > 0) 
+            { 
+                for (int i=0; i<len; i++) 
+                { 
+                    this.Add(Proto4z.BaseProtoObject.decodeUI32(binData, ref pos)); 
+                } 
+            } 
+            return pos; 
+        } 
+    } 
+ 
+ 
+    public class PartyArray : System.Collections.Generic.List<IntegerData>, Proto4z.IProtoObject //最多4个, 内联存储  
+    { 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var ret = new System.Collections.Generic.List<byte>(); 
+            int len = (int)this.Count; 
+            ret.AddRange(Proto4z.BaseProtoObject.encodeI32(len)); 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(this[i].__encode()); 
+            } 
+            return ret; 
+        } 
+ 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            int len = Proto4z.BaseProtoObject.decodeI32(binData, ref pos); 
+            if(len > 0) 
+            { 
+                for (int i=0; i<len; i++) 
+                { 
+                    var data = new IntegerData(); 
+                    data.__decode(binData, ref pos); 
+                    this.Add(data); 
+                } 
+            } 
+            return pos; 
+        } 
+    } 
+ 
+    public class BoundedPack: Proto4z.IProtoObject //无堆内存分配的示例  
+    {     
+        //proto id   
+        public const ushort protoID = 30008;  
+        static public ushort getProtoID() { return 30008; } 
+        static public string getProtoName() { return "BoundedPack"; } 
+        //members   
+        public string name; //最长32字节, 内联存储  
+        public BuffArray buffs;  
+        public PartyArray party;  
+        public BoundedPack()  
+        { 
+            name = "";  
+            buffs = new BuffArray();  
+            party = new PartyArray();  
+        } 
+        public BoundedPack(string name, BuffArray buffs, PartyArray party) 
+        { 
+            this.name = name; 
+            this.buffs = buffs; 
+            this.party = party; 
+        } 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var data = new System.Collections.Generic.List<byte>(); 
+            data.AddRange(Proto4z.BaseProtoObject.encodeString(this.name)); 
+            if (this.buffs == null) this.buffs = new BuffArray(); 
+            data.AddRange(this.buffs.__encode()); 
+            if (this.party == null) this.party = new PartyArray(); 
+            data.AddRange(this.party.__encode()); 
+            return data; 
+        } 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            this.name = Proto4z.BaseProtoObject.decodeString(binData, ref pos); 
+            this.buffs = new BuffArray(); 
+            this.buffs.__decode(binData, ref pos); 
+            this.party = new PartyArray(); 
+            this.party.__decode(binData, ref pos); 
+            return pos; 
+        } 
+    } 
+ 
+    public class FlagsPack: Proto4z.IProtoObject //bool和bits:N按位打包的示例  
+    {     
+        //proto id   
+        public const ushort protoID = 30009;  
+        static public ushort getProtoID() { return 30009; } 
+        static public string getProtoName() { return "FlagsPack"; } 
+        //members   
+        public bool online;  
+        public byte level; //0~127  
+        public byte camp;  
+        public bool muted;  
+        public uint id; //打断位图  
+        public bool hidden;  
+        public ulong exp;  
+        public FlagsPack()  
+        { 
+            online = false;  
+            level = 0;  
+            camp = 0;  
+            muted = false;  
+            id = 0;  
+            hidden = false;  
+            exp = 0;  
+        } 
+        public FlagsPack(bool online, byte level, byte camp, bool muted, uint id, bool hidden, ulong exp) 
+        { 
+            this.online = online; 
+            this.level = level; 
+            this.camp = camp; 
+            this.muted = muted; 
+            this.id = id; 
+            this.hidden = hidden; 
+            this.exp = exp; 
+        } 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var data = new System.Collections.Generic.List<byte>(); 
+            { 
+                var bits = new byte[2]; 
+                Proto4z.BaseProtoObject.encodeBits(bits, 0, (this.online ? 1UL : 0UL), 1); 
+                Proto4z.BaseProtoObject.encodeBits(bits, 1, (ulong)this.level, 7); 
+                Proto4z.BaseProtoObject.encodeBits(bits, 8, (ulong)this.camp, 3); 
+                Proto4z.BaseProtoObject.encodeBits(bits, 11, (this.muted ? 1UL : 0UL), 1); 
+                data.AddRange(bits); 
+            } 
+            data.AddRange(Proto4z.BaseProtoObject.encodeUI32(this.id)); 
+            { 
+                var bits = new byte[6]; 
+                Proto4z.BaseProtoObject.encodeBits(bits, 0, (this.hidden ? 1UL : 0UL), 1); 
+                Proto4z.BaseProtoObject.encodeBits(bits, 1, (ulong)this.exp, 40); 
+                data.AddRange(bits); 
+            } 
+            return data; 
+        } 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            this.online = Proto4z.BaseProtoObject.decodeBits(binData, pos, 0, 1) != 0; 
+            this.level = (byte)Proto4z.BaseProtoObject.decodeBits(binData, pos, 1, 7); 
+            this.camp = (byte)Proto4z.BaseProtoObject.decodeBits(binData, pos, 8, 3); 
+            this.muted = Proto4z.BaseProtoObject.decodeBits(binData, pos, 11, 1) != 0; 
+            pos += 2; 
+            this.id = Proto4z.BaseProtoObject.decodeUI32(binData, ref pos); 
+            this.hidden = Proto4z.BaseProtoObject.decodeBits(binData, pos, 0, 1) != 0; 
+            this.exp = (ulong)Proto4z.BaseProtoObject.decodeBits(binData, pos, 1, 40); 
+            pos += 6; 
+            return pos; 
+        } 
+    } 
+ 
+    public class MovePack: Proto4z.IProtoObject //量化坐标和朝向的示例  
+    {     
+        //proto id   
+        public const ushort protoID = 30010;  
+        static public ushort getProtoID() { return 30010; } 
+        static public string getProtoName() { return "MovePack"; } 
+        //members   
+        public uint eid;  
+        public float x; //厘米精度, fixed32最多2^24个刻度  
+        public float y;  
+        public float z;  
+        public float speed;  
+        public float yaw; //角度  
+        public float pitch;  
+        public MovePack()  
+        { 
+            eid = 0;  
+            x = 0.0f;  
+            y = 0.0f;  
+            z = 0.0f;  
+            speed = 0.0f;  
+            yaw = 0.0f;  
+            pitch = 0.0f;  
+        } 
+        public MovePack(uint eid, float x, float y, float z, float speed, float yaw, float pitch) 
+        { 
+            this.eid = eid; 
+            this.x = x; 
+            this.y = y; 
+            this.z = z; 
+            this.speed = speed; 
+            this.yaw = yaw; 
+            this.pitch = pitch; 
+        } 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var data = new System.Collections.Generic.List<byte>(); 
+            data.AddRange(Proto4z.BaseProtoObject.encodeUI32(this.eid)); 
+            data.AddRange(Proto4z.BaseProtoObject.encodeFixed(this.x, 0.01, 10000000, 4)); 
+            data.AddRange(Proto4z.BaseProtoObject.encodeFixed(this.y, 0.01, 10000000, 4)); 
+            data.AddRange(Proto4z.BaseProtoObject.encodeFixed(this.z, 0.01, 30000, 2)); 
+            data.AddRange(Proto4z.BaseProtoObject.encodeFixed(this.speed, 0.1, 127, 1)); 
+            data.AddRange(Proto4z.BaseProtoObject.encodeAngle(this.yaw, 2)); 
+            data.AddRange(Proto4z.BaseProtoObject.encodeAngle(this.pitch, 1)); 
+            return data; 
+        } 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            this.eid = Proto4z.BaseProtoObject.decodeUI32(binData, ref pos); 
+            this.x = Proto4z.BaseProtoObject.decodeFixed(binData, ref pos, 0.01, 4); 
+            this.y = Proto4z.BaseProtoObject.decodeFixed(binData, ref pos, 0.01, 4); 
+            this.z = Proto4z.BaseProtoObject.decodeFixed(binData, ref pos, 0.01, 2); 
+            this.speed = Proto4z.BaseProtoObject.decodeFixed(binData, ref pos, 0.1, 1); 
+            this.yaw = Proto4z.BaseProtoObject.decodeAngle(binData, ref pos, 2); 
+            this.pitch = Proto4z.BaseProtoObject.decodeAngle(binData, ref pos, 1); 
+            return pos; 
+        } 
+    } 
+ 
+ 
+    public class PathArray : System.Collections.Generic.List<float>, Proto4z.IProtoObject //量化数组  
+    { 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var ret = new System.Collections.Generic.List<byte>(); 
+            int len = (int)this.Count; 
+            ret.AddRange(Proto4z.BaseProtoObject.encodeI32(len)); 
+            for (int i = 0; i < this.Count; i++ ) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeFixed(this[i], 0.01, 30000, 2));  
+            } 
+            return ret; 
+        } 
+ 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            int len = Proto4z.BaseProtoObject.decodeI32(binData, ref pos); 
+            if(len > 0) 
+            { 
+                for (int i=0; i<len; i++) 
+                { 
+                    this.Add(Proto4z.BaseProtoObject.decodeFixed(binData, ref pos, 0.01, 2)); 
+                } 
+            } 
+            return pos; 
+        } 
+    } 
+ 
+    public class PathPack: Proto4z.IProtoObject 
+    {     
+        //proto id   
+        public const ushort protoID = 30011;  
+        static public ushort getProtoID() { return 30011; } 
+        static public string getProtoName() { return "PathPack"; } 
+        //members   
+        public uint eid;  
+        public PathArray path;  
+        public float heading;  
+        public PathPack()  
+        { 
+            eid = 0;  
+            path = new PathArray();  
+            heading = 0.0f;  
+        } 
+        public PathPack(uint eid, PathArray path, float heading) 
+        { 
+            this.eid = eid; 
+            this.path = path; 
+            this.heading = heading; 
+        } 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var data = new System.Collections.Generic.List<byte>(); 
+            data.AddRange(Proto4z.BaseProtoObject.encodeUI32(this.eid)); 
+            if (this.path == null) this.path = new PathArray(); 
+            data.AddRange(this.path.__encode()); 
+            data.AddRange(Proto4z.BaseProtoObject.encodeAngle(this.heading, 2)); 
+            return data; 
+        } 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            this.eid = Proto4z.BaseProtoObject.decodeUI32(binData, ref pos); 
+            this.path = new PathArray(); 
+            this.path.__decode(binData, ref pos); 
+            this.heading = Proto4z.BaseProtoObject.decodeAngle(binData, ref pos, 2); 
+            return pos; 
+        } 
+    } 
+ 
+ 
+    public class ItemFlatMap : System.Collections.Generic.Dictionary<uint, IntegerData>, Proto4z.IProtoObject //有序数组实现, 读多写少  
+    { 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var ret = new System.Collections.Generic.List<byte>(); 
+            int len = (int)this.Count; 
+            ret.AddRange(Proto4z.BaseProtoObject.encodeI32(len)); 
+            foreach(var kv in this) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeUI32(kv.Key)); 
+                ret.AddRange(kv.Value.__encode()); 
+            } 
+            return ret; 
+        } 
+ 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            int len = Proto4z.BaseProtoObject.decodeI32(binData, ref pos); 
+            if(len > 0) 
+            { 
+                for (int i=0; i<len; i++) 
+                { 
+                    var key = Proto4z.BaseProtoObject.decodeUI32(binData, ref pos); 
+                    var val = new IntegerData(); 
+                    val.__decode(binData, ref pos); 
+                    this.Add(key, val); 
+                } 
+            } 
+            return pos; 
+        } 
+    } 
+ 
+ 
+    public class AttrHashMap : System.Collections.Generic.Dictionary<string, uint>, Proto4z.IProtoObject //哈希表实现  
+    { 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var ret = new System.Collections.Generic.List<byte>(); 
+            int len = (int)this.Count; 
+            ret.AddRange(Proto4z.BaseProtoObject.encodeI32(len)); 
+            foreach(var kv in this) 
+            { 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeString(kv.Key)); 
+                ret.AddRange(Proto4z.BaseProtoObject.encodeUI32(kv.Value)); 
+            } 
+            return ret; 
+        } 
+ 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            int len = Proto4z.BaseProtoObject.decodeI32(binData, ref pos); 
+            if(len > 0) 
+            { 
+                for (int i=0; i<len; i++) 
+                { 
+                    var key = Proto4z.BaseProtoObject.decodeString(binData, ref pos); 
+                    var val = Proto4z.BaseProtoObject.decodeUI32(binData, ref pos); 
+                    this.Add(key, val); 
+                } 
+            } 
+            return pos; 
+        } 
+    } 
+ 
+    public class BagPack: Proto4z.IProtoObject 
+    {     
+        //proto id   
+        public const ushort protoID = 30012;  
+        static public ushort getProtoID() { return 30012; } 
+        static public string getProtoName() { return "BagPack"; } 
+        //members   
+        public ItemFlatMap items;  
+        public AttrHashMap attrs;  
+        public BagPack()  
+        { 
+            items = new ItemFlatMap();  
+            attrs = new AttrHashMap();  
+        } 
+        public BagPack(ItemFlatMap items, AttrHashMap attrs) 
+        { 
+            this.items = items; 
+            this.attrs = attrs; 
+        } 
+        public System.Collections.Generic.List<byte> __encode() 
+        { 
+            var data = new System.Collections.Generic.List<byte>(); 
+            if (this.items == null) this.items = new ItemFlatMap(); 
+            data.AddRange(this.items.__encode()); 
+            if (this.attrs == null) this.attrs = new AttrHashMap(); 
+            data.AddRange(this.attrs.__encode()); 
+            return data; 
+        } 
+        public int __decode(byte[] binData, ref int pos) 
+        { 
+            this.items = new ItemFlatMap(); 
+            this.items.__decode(binData, ref pos); 
+            this.attrs = new AttrHashMap(); 
+            this.attrs.__decode(binData, ref pos); 
+            return pos; 
+        } 
+    } 
+ 
 } 
  
  
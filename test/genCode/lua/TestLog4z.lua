@@ -0,0 +1,27 @@
+ 
+Proto4z.LogBuffArray = {} --内联存储 
+Proto4z.LogBuffArray.__protoName = "LogBuffArray" 
+Proto4z.LogBuffArray.__protoDesc = "array" 
+Proto4z.LogBuffArray.__protoTypeV = "ui32" 
+ 
+Proto4z.LogFlatMap = {} --有序数组 
+Proto4z.LogFlatMap.__protoName = "LogFlatMap" 
+Proto4z.LogFlatMap.__protoDesc = "map" 
+Proto4z.LogFlatMap.__protoTypeK = "ui32" 
+Proto4z.LogFlatMap.__protoTypeV = "string" 
+ 
+Proto4z.LogHashMap = {} --哈希表 
+Proto4z.LogHashMap.__protoName = "LogHashMap" 
+Proto4z.LogHashMap.__protoDesc = "map" 
+Proto4z.LogHashMap.__protoTypeK = "string" 
+Proto4z.LogHashMap.__protoTypeV = "ui32" 
+ 
+Proto4z.register(32001,"LogPack") 
+Proto4z.LogPack = {}  
+Proto4z.LogPack.__protoID = 32001 
+Proto4z.LogPack.__protoName = "LogPack" 
+Proto4z.LogPack[1] = {name="id", type="ui32" }  
+Proto4z.LogPack[2] = {name="name", type="string" } --内联存储 
+Proto4z.LogPack[3] = {name="buffs", type="LogBuffArray" }  
+Proto4z.LogPack[4] = {name="flat", type="LogFlatMap" }  
+Proto4z.LogPack[5] = {name="hash", type="LogHashMap" }  
@@ -1,4 +1,7 @@
  
+local spack, sunpack, concat = string.pack, string.unpack, table.concat 
+local toint, quantize, dequantize, empty = Proto4z.__toInteger, Proto4z.__quantize, Proto4z.__dequantize, {} 
+ 
 Proto4z.MAX_SESSIONS = 5000--max session count 
 Proto4z.SS_NONE = 0--不存在 
 Proto4z.SS_CREATED = 1--已创建 
@@ -17,6 +20,16 @@ Proto4z.IntegerData[5] = {name="_int", type="i32" }
 Proto4z.IntegerData[6] = {name="_uint", type="ui32" }  
 Proto4z.IntegerData[7] = {name="_i64", type="i64" }  
 Proto4z.IntegerData[8] = {name="_ui64", type="ui64" }  
+do 
+    Proto4z.IntegerData.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        return spack("<I1I1I2I2I4I4i8I8", ((obj._char or 0) & 0xff), ((obj._uchar or 0) & 0xff), ((obj._short or 0) & 0xffff), ((obj._ushort or 0) & 0xffff), ((obj._int or 0) & 0xffffffff), ((obj._uint or 0) & 0xffffffff), toint(obj._i64), toint(obj._ui64)) 
+    end 
+    Proto4z.IntegerData.__decoder = function(bin, pos, result) 
+        result._char, result._uchar, result._short, result._ushort, result._int, result._uint, result._i64, result._ui64, pos = sunpack("<i1I1i2I2i4I4i8I8", bin, pos) 
+        return pos 
+    end 
+end 
  
 Proto4z.register(30001,"FloatData") 
 Proto4z.FloatData = {} --测试 
@@ -24,50 +37,225 @@ Proto4z.FloatData.__protoID = 30001
 Proto4z.FloatData.__protoName = "FloatData" 
 Proto4z.FloatData[1] = {name="_float", type="float" }  
 Proto4z.FloatData[2] = {name="_double", type="double" }  
+do 
+    Proto4z.FloatData.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        return spack("<fd", (obj._float or 0), (obj._double or 0)) 
+    end 
+    Proto4z.FloatData.__decoder = function(bin, pos, result) 
+        result._float, result._double, pos = sunpack("<fd", bin, pos) 
+        return pos 
+    end 
+end 
  
 Proto4z.register(30002,"StringData") 
 Proto4z.StringData = {} --测试 
 Proto4z.StringData.__protoID = 30002 
 Proto4z.StringData.__protoName = "StringData" 
 Proto4z.StringData[1] = {name="_string", type="string" }  
+do 
+    Proto4z.StringData.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        return spack("<s4", (obj._string or "")) 
+    end 
+    Proto4z.StringData.__decoder = function(bin, pos, result) 
+        result._string, pos = sunpack("<s4", bin, pos) 
+        return pos 
+    end 
+end 
  
 Proto4z.IntArray = {}  
 Proto4z.IntArray.__protoName = "IntArray" 
 Proto4z.IntArray.__protoDesc = "array" 
 Proto4z.IntArray.__protoTypeV = "ui32" 
+do 
+    Proto4z.IntArray.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        local n = #obj 
+        local parts, i = {spack("<I4", n)}, 1 
+        while i + 7 <= n do 
+            parts[#parts + 1] = spack("<I4I4I4I4I4I4I4I4", ((obj[i] or 0) & 0xffffffff), ((obj[i + 1] or 0) & 0xffffffff), ((obj[i + 2] or 0) & 0xffffffff), ((obj[i + 3] or 0) & 0xffffffff), ((obj[i + 4] or 0) & 0xffffffff), ((obj[i + 5] or 0) & 0xffffffff), ((obj[i + 6] or 0) & 0xffffffff), ((obj[i + 7] or 0) & 0xffffffff)) 
+            i = i + 8 
+        end 
+        for i = i, n do 
+            parts[#parts + 1] = spack("<I4", ((obj[i] or 0) & 0xffffffff)) 
+        end 
+        return concat(parts) 
+    end 
+    Proto4z.IntArray.__decoder = function(bin, pos, result) 
+        local n, v 
+        n, pos = sunpack("<I4", bin, pos) 
+        for i = 1, n do 
+            result[i], pos = sunpack("<I4", bin, pos) 
+        end 
+        return pos 
+    end 
+end 
  
 Proto4z.IntegerDataArray = {}  
 Proto4z.IntegerDataArray.__protoName = "IntegerDataArray" 
 Proto4z.IntegerDataArray.__protoDesc = "array" 
 Proto4z.IntegerDataArray.__protoTypeV = "IntegerData" 
+do 
+    Proto4z.IntegerDataArray.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        local n = #obj 
+        local parts, i = {spack("<I4", n)}, 1 
+        for i = i, n do 
+            parts[#parts + 1] = Proto4z.IntegerData.__encoder(obj[i]) 
+        end 
+        return concat(parts) 
+    end 
+    Proto4z.IntegerDataArray.__decoder = function(bin, pos, result) 
+        local n, v 
+        n, pos = sunpack("<I4", bin, pos) 
+        for i = 1, n do 
+            v = {} 
+            pos = Proto4z.IntegerData.__decoder(bin, pos, v) 
+            result[i] = v 
+        end 
+        return pos 
+    end 
+end 
  
 Proto4z.FloatDataArray = {}  
 Proto4z.FloatDataArray.__protoName = "FloatDataArray" 
 Proto4z.FloatDataArray.__protoDesc = "array" 
 Proto4z.FloatDataArray.__protoTypeV = "FloatData" 
+do 
+    Proto4z.FloatDataArray.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        local n = #obj 
+        local parts, i = {spack("<I4", n)}, 1 
+        for i = i, n do 
+            parts[#parts + 1] = Proto4z.FloatData.__encoder(obj[i]) 
+        end 
+        return concat(parts) 
+    end 
+    Proto4z.FloatDataArray.__decoder = function(bin, pos, result) 
+        local n, v 
+        n, pos = sunpack("<I4", bin, pos) 
+        for i = 1, n do 
+            v = {} 
+            pos = Proto4z.FloatData.__decoder(bin, pos, v) 
+            result[i] = v 
+        end 
+        return pos 
+    end 
+end 
  
 Proto4z.StringDataArray = {}  
 Proto4z.StringDataArray.__protoName = "StringDataArray" 
 Proto4z.StringDataArray.__protoDesc = "array" 
 Proto4z.StringDataArray.__protoTypeV = "StringData" 
+do 
+    Proto4z.StringDataArray.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        local n = #obj 
+        local parts, i = {spack("<I4", n)}, 1 
+        for i = i, n do 
+            parts[#parts + 1] = Proto4z.StringData.__encoder(obj[i]) 
+        end 
+        return concat(parts) 
+    end 
+    Proto4z.StringDataArray.__decoder = function(bin, pos, result) 
+        local n, v 
+        n, pos = sunpack("<I4", bin, pos) 
+        for i = 1, n do 
+            v = {} 
+            pos = Proto4z.StringData.__decoder(bin, pos, v) 
+            result[i] = v 
+        end 
+        return pos 
+    end 
+end 
  
 Proto4z.IntegerDataMap = {}  
 Proto4z.IntegerDataMap.__protoName = "IntegerDataMap" 
 Proto4z.IntegerDataMap.__protoDesc = "map" 
 Proto4z.IntegerDataMap.__protoTypeK = "ui32" 
 Proto4z.IntegerDataMap.__protoTypeV = "IntegerData" 
+do 
+    Proto4z.IntegerDataMap.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        local parts, n = {false}, 0 
+        for k, v in pairs(obj) do 
+            n = n + 1 
+            parts[n + 1] = spack("<I4", ((k or 0) & 0xffffffff)) .. Proto4z.IntegerData.__encoder(v) 
+        end 
+        parts[1] = spack("<I4", n) 
+        return concat(parts) 
+    end 
+    Proto4z.IntegerDataMap.__decoder = function(bin, pos, result) 
+        local n, k, v 
+        n, pos = sunpack("<I4", bin, pos) 
+        for i = 1, n do 
+            k, pos = sunpack("<I4", bin, pos) 
+            v = {} 
+            pos = Proto4z.IntegerData.__decoder(bin, pos, v) 
+            result[k] = v 
+        end 
+        return pos 
+    end 
+end 
  
 Proto4z.FloatDataMap = {}  
 Proto4z.FloatDataMap.__protoName = "FloatDataMap" 
 Proto4z.FloatDataMap.__protoDesc = "map" 
 Proto4z.FloatDataMap.__protoTypeK = "double" 
 Proto4z.FloatDataMap.__protoTypeV = "FloatData" 
+do 
+    Proto4z.FloatDataMap.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        local parts, n = {false}, 0 
+        for k, v in pairs(obj) do 
+            n = n + 1 
+            parts[n + 1] = spack("<d", (k or 0)) .. Proto4z.FloatData.__encoder(v) 
+        end 
+        parts[1] = spack("<I4", n) 
+        return concat(parts) 
+    end 
+    Proto4z.FloatDataMap.__decoder = function(bin, pos, result) 
+        local n, k, v 
+        n, pos = sunpack("<I4", bin, pos) 
+        for i = 1, n do 
+            k, pos = sunpack("<d", bin, pos) 
+            v = {} 
+            pos = Proto4z.FloatData.__decoder(bin, pos, v) 
+            result[k] = v 
+        end 
+        return pos 
+    end 
+end 
  
 Proto4z.StringDataMap = {}  
 Proto4z.StringDataMap.__protoName = "StringDataMap" 
 Proto4z.StringDataMap.__protoDesc = "map" 
 Proto4z.StringDataMap.__protoTypeK = "string" 
 Proto4z.StringDataMap.__protoTypeV = "StringData" 
+do 
+    Proto4z.StringDataMap.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        local parts, n = {false}, 0 
+        for k, v in pairs(obj) do 
+            n = n + 1 
+            parts[n + 1] = spack("<s4", (k or "")) .. Proto4z.StringData.__encoder(v) 
+        end 
+        parts[1] = spack("<I4", n) 
+        return concat(parts) 
+    end 
+    Proto4z.StringDataMap.__decoder = function(bin, pos, result) 
+        local n, k, v 
+        n, pos = sunpack("<I4", bin, pos) 
+        for i = 1, n do 
+            k, pos = sunpack("<s4", bin, pos) 
+            v = {} 
+            pos = Proto4z.StringData.__decoder(bin, pos, v) 
+            result[k] = v 
+        end 
+        return pos 
+    end 
+end 
  
 Proto4z.register(30003,"EchoPack") 
 Proto4z.EchoPack = {}  
@@ -79,6 +267,32 @@ Proto4z.EchoPack[3] = {name="_sarray", type="StringDataArray" }
 Proto4z.EchoPack[4] = {name="_imap", type="IntegerDataMap" }  
 Proto4z.EchoPack[5] = {name="_fmap", type="FloatDataMap" }  
 Proto4z.EchoPack[6] = {name="_smap", type="StringDataMap" }  
+do 
+    Proto4z.EchoPack.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        return Proto4z.IntegerDataArray.__encoder(obj._iarray) 
+            .. Proto4z.FloatDataArray.__encoder(obj._farray) 
+            .. Proto4z.StringDataArray.__encoder(obj._sarray) 
+            .. Proto4z.IntegerDataMap.__encoder(obj._imap) 
+            .. Proto4z.FloatDataMap.__encoder(obj._fmap) 
+            .. Proto4z.StringDataMap.__encoder(obj._smap) 
+    end 
+    Proto4z.EchoPack.__decoder = function(bin, pos, result) 
+        result._iarray = {} 
+        pos = Proto4z.IntegerDataArray.__decoder(bin, pos, result._iarray) 
+        result._farray = {} 
+        pos = Proto4z.FloatDataArray.__decoder(bin, pos, result._farray) 
+        result._sarray = {} 
+        pos = Proto4z.StringDataArray.__decoder(bin, pos, result._sarray) 
+        result._imap = {} 
+        pos = Proto4z.IntegerDataMap.__decoder(bin, pos, result._imap) 
+        result._fmap = {} 
+        pos = Proto4z.FloatDataMap.__decoder(bin, pos, result._fmap) 
+        result._smap = {} 
+        pos = Proto4z.StringDataMap.__decoder(bin, pos, result._smap) 
+        return pos 
+    end 
+end 
  
 Proto4z.register(30004,"MoneyTree") 
 Proto4z.MoneyTree = {} --摇钱树功能模块 
@@ -89,6 +303,16 @@ Proto4z.MoneyTree[2] = {name="freeCount", type="ui32" } --今日剩余免费次
 Proto4z.MoneyTree[3] = {name="payCount", type="ui32" } --今日已购买次数 
 Proto4z.MoneyTree[4] = {name="statSum", type="ui32" } --历史总和 
 Proto4z.MoneyTree[5] = {name="statCount", type="ui32" } --历史总次数 
+do 
+    Proto4z.MoneyTree.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        return spack("<I4I4I4I4I4", ((obj.lastTime or 0) & 0xffffffff), ((obj.freeCount or 0) & 0xffffffff), ((obj.payCount or 0) & 0xffffffff), ((obj.statSum or 0) & 0xffffffff), ((obj.statCount or 0) & 0xffffffff)) 
+    end 
+    Proto4z.MoneyTree.__decoder = function(bin, pos, result) 
+        result.lastTime, result.freeCount, result.payCount, result.statSum, result.statCount, pos = sunpack("<I4I4I4I4I4", bin, pos) 
+        return pos 
+    end 
+end 
  
 Proto4z.register(30005,"SimplePack") 
 Proto4z.SimplePack = {} --简单示例 
@@ -98,3 +322,322 @@ Proto4z.SimplePack[1] = {name="id", type="ui32" } --id, 对应数据库的结构
 Proto4z.SimplePack[2] = {name="name", type="string" } --昵称, 唯一索引 
 Proto4z.SimplePack[3] = {name="createTime", type="ui32" } --创建时间, 普通索引 
 Proto4z.SimplePack[4] = {name="moneyTree", type="MoneyTree" }  
+do 
+    Proto4z.SimplePack.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        return spack("<I4s4I4", ((obj.id or 0) & 0xffffffff), (obj.name or ""), ((obj.createTime or 0) & 0xffffffff)) 
+            .. Proto4z.MoneyTree.__encoder(obj.moneyTree) 
+    end 
+    Proto4z.SimplePack.__decoder = function(bin, pos, result) 
+        result.id, result.name, result.createTime, pos = sunpack("<I4s4I4", bin, pos) 
+        result.moneyTree = {} 
+        pos = Proto4z.MoneyTree.__decoder(bin, pos, result.moneyTree) 
+        return pos 
+    end 
+end 
+ 
+Proto4z.register(30006,"SparsePack") 
+Proto4z.SparsePack = {} --tagged示例, 只编码tag中存在的成员 
+Proto4z.SparsePack.__protoID = 30006 
+Proto4z.SparsePack.__protoName = "SparsePack" 
+Proto4z.SparsePack.__withTag = true 
+Proto4z.SparsePack[1] = {name="id", type="ui32" }  
+Proto4z.SparsePack[2] = {name="name", type="string" }  
+Proto4z.SparsePack[3] = {name="iarray", type="IntegerDataArray" }  
+Proto4z.SparsePack[4] = {name="moneyTree", type="MoneyTree" }  
+Proto4z.SparsePack[5] = {name="value", type="double" }  
+ 
+Proto4z.register(30007,"SparsePackNext") 
+Proto4z.SparsePackNext = {} --SparsePack的新版本, 追加了成员 
+Proto4z.SparsePackNext.__protoID = 30007 
+Proto4z.SparsePackNext.__protoName = "SparsePackNext" 
+Proto4z.SparsePackNext.__withTag = true 
+Proto4z.SparsePackNext[1] = {name="id", type="ui32" }  
+Proto4z.SparsePackNext[2] = {name="name", type="string" }  
+Proto4z.SparsePackNext[3] = {name="iarray", type="IntegerDataArray" }  
+Proto4z.SparsePackNext[4] = {name="moneyTree", type="MoneyTree" }  
+Proto4z.SparsePackNext[5] = {name="value", type="double" }  
+Proto4z.SparsePackNext[6] = {name="extra", type="ui64" }  
+ 
+Proto4z.IntegerDataColumns = {} --按列编码 
+Proto4z.IntegerDataColumns.__protoName = "IntegerDataColumns" 
+Proto4z.IntegerDataColumns.__protoDesc = "array" 
+Proto4z.IntegerDataColumns.__protoTypeV = "IntegerData" 
+Proto4z.IntegerDataColumns.__columnar = true 
+ 
+Proto4z.StringDataColumns = {} --按列编码 
+Proto4z.StringDataColumns.__protoName = "StringDataColumns" 
+Proto4z.StringDataColumns.__protoDesc = "array" 
+Proto4z.StringDataColumns.__protoTypeV = "StringData" 
+Proto4z.StringDataColumns.__columnar = true 
+ 
+Proto4z.BuffArray = {} --最多8个, 内联存储 
+Proto4z.BuffArray.__protoName = "BuffArray" 
+Proto4z.BuffArray.__protoDesc = "array" 
+Proto4z.BuffArray.__protoTypeV = "ui32" 
+do 
+    Proto4z.BuffArray.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        local n = #obj 
+        local parts, i = {spack("<I4", n)}, 1 
+        while i + 7 <= n do 
+            parts[#parts + 1] = spack("<I4I4I4I4I4I4I4I4", ((obj[i] or 0) & 0xffffffff), ((obj[i + 1] or 0) & 0xffffffff), ((obj[i + 2] or 0) & 0xffffffff), ((obj[i + 3] or 0) & 0xffffffff), ((obj[i + 4] or 0) & 0xffffffff), ((obj[i + 5] or 0) & 0xffffffff), ((obj[i + 6] or 0) & 0xffffffff), ((obj[i + 7] or 0) & 0xffffffff)) 
+            i = i + 8 
+        end 
+        for i = i, n do 
+            parts[#parts + 1] = spack("<I4", ((obj[i] or 0) & 0xffffffff)) 
+        end 
+        return concat(parts) 
+    end 
+    Proto4z.BuffArray.__decoder = function(bin, pos, result) 
+        local n, v 
+        n, pos = sunpack("<I4", bin, pos) 
+        for i = 1, n do 
+            result[i], pos = sunpack("<I4", bin, pos) 
+        end 
+        return pos 
+    end 
+end 
+ 
+Proto4z.PartyArray = {} --最多4个, 内联存储 
+Proto4z.PartyArray.__protoName = "PartyArray" 
+Proto4z.PartyArray.__protoDesc = "array" 
+Proto4z.PartyArray.__protoTypeV = "IntegerData" 
+do 
+    Proto4z.PartyArray.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        local n = #obj 
+        local parts, i = {spack("<I4", n)}, 1 
+        for i = i, n do 
+            parts[#parts + 1] = Proto4z.IntegerData.__encoder(obj[i]) 
+        end 
+        return concat(parts) 
+    end 
+    Proto4z.PartyArray.__decoder = function(bin, pos, result) 
+        local n, v 
+        n, pos = sunpack("<I4", bin, pos) 
+        for i = 1, n do 
+            v = {} 
+            pos = Proto4z.IntegerData.__decoder(bin, pos, v) 
+            result[i] = v 
+        end 
+        return pos 
+    end 
+end 
+ 
+Proto4z.register(30008,"BoundedPack") 
+Proto4z.BoundedPack = {} --无堆内存分配的示例 
+Proto4z.BoundedPack.__protoID = 30008 
+Proto4z.BoundedPack.__protoName = "BoundedPack" 
+Proto4z.BoundedPack[1] = {name="name", type="string" } --最长32字节, 内联存储 
+Proto4z.BoundedPack[2] = {name="buffs", type="BuffArray" }  
+Proto4z.BoundedPack[3] = {name="party", type="PartyArray" }  
+do 
+    Proto4z.BoundedPack.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        return spack("<s4", (obj.name or "")) 
+            .. Proto4z.BuffArray.__encoder(obj.buffs) 
+            .. Proto4z.PartyArray.__encoder(obj.party) 
+    end 
+    Proto4z.BoundedPack.__decoder = function(bin, pos, result) 
+        result.name, pos = sunpack("<s4", bin, pos) 
+        result.buffs = {} 
+        pos = Proto4z.BuffArray.__decoder(bin, pos, result.buffs) 
+        result.party = {} 
+        pos = Proto4z.PartyArray.__decoder(bin, pos, result.party) 
+        return pos 
+    end 
+end 
+ 
+Proto4z.register(30009,"FlagsPack") 
+Proto4z.FlagsPack = {} --bool和bits:N按位打包的示例 
+Proto4z.FlagsPack.__protoID = 30009 
+Proto4z.FlagsPack.__protoName = "FlagsPack" 
+Proto4z.FlagsPack[1] = {name="online", type="bool", bits=1 }  
+Proto4z.FlagsPack[2] = {name="level", type="bits:7", bits=7 } --0~127 
+Proto4z.FlagsPack[3] = {name="camp", type="bits:3", bits=3 }  
+Proto4z.FlagsPack[4] = {name="muted", type="bool", bits=1 }  
+Proto4z.FlagsPack[5] = {name="id", type="ui32" } --打断位图 
+Proto4z.FlagsPack[6] = {name="hidden", type="bool", bits=1 }  
+Proto4z.FlagsPack[7] = {name="exp", type="bits:40", bits=40 }  
+do 
+    Proto4z.FlagsPack.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        return spack("<I2I4I6", ((obj.online == true and 1 or (obj.online or 0)) & 0x1) | (((obj.level or 0) & 0x7f) << 1) | (((obj.camp or 0) & 0x7) << 8) | (((obj.muted == true and 1 or (obj.muted or 0)) & 0x1) << 11), ((obj.id or 0) & 0xffffffff), ((obj.hidden == true and 1 or (obj.hidden or 0)) & 0x1) | (((obj.exp or 0) & 0xffffffffff) << 1)) 
+    end 
+    Proto4z.FlagsPack.__decoder = function(bin, pos, result) 
+        local b1, b6 
+        b1, result.id, b6, pos = sunpack("<I2I4I6", bin, pos) 
+        result.online = (b1 & 0x1) ~= 0 
+        result.level = ((b1 >> 1) & 0x7f) 
+        result.camp = ((b1 >> 8) & 0x7) 
+        result.muted = ((b1 >> 11) & 0x1) ~= 0 
+        result.hidden = (b6 & 0x1) ~= 0 
+        result.exp = ((b6 >> 1) & 0xffffffffff) 
+        return pos 
+    end 
+end 
+ 
+Proto4z.register(30010,"MovePack") 
+Proto4z.MovePack = {} --量化坐标和朝向的示例 
+Proto4z.MovePack.__protoID = 30010 
+Proto4z.MovePack.__protoName = "MovePack" 
+Proto4z.MovePack[1] = {name="eid", type="ui32" }  
+Proto4z.MovePack[2] = {name="x", type="fixed32(100000,0.01)", quant={wire="i32", precision=0.01, limit=10000000} } --厘米精度, fixed32最多2^24个刻度 
+Proto4z.MovePack[3] = {name="y", type="fixed32(100000,0.01)", quant={wire="i32", precision=0.01, limit=10000000} }  
+Proto4z.MovePack[4] = {name="z", type="fixed16(300,0.01)", quant={wire="i16", precision=0.01, limit=30000} }  
+Proto4z.MovePack[5] = {name="speed", type="fixed8(12.7,0.1)", quant={wire="i8", precision=0.1, limit=127} }  
+Proto4z.MovePack[6] = {name="yaw", type="angle16", quant={wire="ui16", angle=65536} } --角度 
+Proto4z.MovePack[7] = {name="pitch", type="angle8", quant={wire="ui8", angle=256} }  
+do 
+    local q2, q3, q4, q5, q6, q7 = Proto4z.MovePack[2].quant, Proto4z.MovePack[3].quant, Proto4z.MovePack[4].quant, Proto4z.MovePack[5].quant, Proto4z.MovePack[6].quant, Proto4z.MovePack[7].quant 
+    Proto4z.MovePack.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        return spack("<I4i4i4i2i1I2I1", ((obj.eid or 0) & 0xffffffff), quantize(obj.x, q2), quantize(obj.y, q3), quantize(obj.z, q4), quantize(obj.speed, q5), quantize(obj.yaw, q6), quantize(obj.pitch, q7)) 
+    end 
+    Proto4z.MovePack.__decoder = function(bin, pos, result) 
+        local q2v, q3v, q4v, q5v, q6v, q7v 
+        result.eid, q2v, q3v, q4v, q5v, q6v, q7v, pos = sunpack("<I4i4i4i2i1I2I1", bin, pos) 
+        result.x = dequantize(q2v, q2) 
+        result.y = dequantize(q3v, q3) 
+        result.z = dequantize(q4v, q4) 
+        result.speed = dequantize(q5v, q5) 
+        result.yaw = dequantize(q6v, q6) 
+        result.pitch = dequantize(q7v, q7) 
+        return pos 
+    end 
+end 
+ 
+Proto4z.PathArray = {} --量化数组 
+Proto4z.PathArray.__protoName = "PathArray" 
+Proto4z.PathArray.__protoDesc = "array" 
+Proto4z.PathArray.__protoTypeV = "fixed16(300,0.01)" 
+Proto4z.PathArray.__quant = {wire="i16", precision=0.01, limit=30000} 
+do 
+    local quant = Proto4z.PathArray.__quant 
+    Proto4z.PathArray.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        local n = #obj 
+        local parts, i = {spack("<I4", n)}, 1 
+        while i + 7 <= n do 
+            parts[#parts + 1] = spack("<i2i2i2i2i2i2i2i2", quantize(obj[i], quant), quantize(obj[i + 1], quant), quantize(obj[i + 2], quant), quantize(obj[i + 3], quant), quantize(obj[i + 4], quant), quantize(obj[i + 5], quant), quantize(obj[i + 6], quant), quantize(obj[i + 7], quant)) 
+            i = i + 8 
+        end 
+        for i = i, n do 
+            parts[#parts + 1] = spack("<i2", quantize(obj[i], quant)) 
+        end 
+        return concat(parts) 
+    end 
+    Proto4z.PathArray.__decoder = function(bin, pos, result) 
+        local n, v 
+        n, pos = sunpack("<I4", bin, pos) 
+        for i = 1, n do 
+            v, pos = sunpack("<i2", bin, pos) 
+            result[i] = dequantize(v, quant) 
+        end 
+        return pos 
+    end 
+end 
+ 
+Proto4z.register(30011,"PathPack") 
+Proto4z.PathPack = {}  
+Proto4z.PathPack.__protoID = 30011 
+Proto4z.PathPack.__protoName = "PathPack" 
+Proto4z.PathPack[1] = {name="eid", type="ui32" }  
+Proto4z.PathPack[2] = {name="path", type="PathArray" }  
+Proto4z.PathPack[3] = {name="heading", type="angle16", quant={wire="ui16", angle=65536} }  
+do 
+    local q3 = Proto4z.PathPack[3].quant 
+    Proto4z.PathPack.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        return spack("<I4", ((obj.eid or 0) & 0xffffffff)) 
+            .. Proto4z.PathArray.__encoder(obj.path) 
+            .. spack("<I2", quantize(obj.heading, q3)) 
+    end 
+    Proto4z.PathPack.__decoder = function(bin, pos, result) 
+        local q3v 
+        result.eid, pos = sunpack("<I4", bin, pos) 
+        result.path = {} 
+        pos = Proto4z.PathArray.__decoder(bin, pos, result.path) 
+        q3v, pos = sunpack("<I2", bin, pos) 
+        result.heading = dequantize(q3v, q3) 
+        return pos 
+    end 
+end 
+ 
+Proto4z.ItemFlatMap = {} --有序数组实现, 读多写少 
+Proto4z.ItemFlatMap.__protoName = "ItemFlatMap" 
+Proto4z.ItemFlatMap.__protoDesc = "map" 
+Proto4z.ItemFlatMap.__protoTypeK = "ui32" 
+Proto4z.ItemFlatMap.__protoTypeV = "IntegerData" 
+do 
+    Proto4z.ItemFlatMap.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        local parts, n = {false}, 0 
+        for k, v in pairs(obj) do 
+            n = n + 1 
+            parts[n + 1] = spack("<I4", ((k or 0) & 0xffffffff)) .. Proto4z.IntegerData.__encoder(v) 
+        end 
+        parts[1] = spack("<I4", n) 
+        return concat(parts) 
+    end 
+    Proto4z.ItemFlatMap.__decoder = function(bin, pos, result) 
+        local n, k, v 
+        n, pos = sunpack("<I4", bin, pos) 
+        for i = 1, n do 
+            k, pos = sunpack("<I4", bin, pos) 
+            v = {} 
+            pos = Proto4z.IntegerData.__decoder(bin, pos, v) 
+            result[k] = v 
+        end 
+        return pos 
+    end 
+end 
+ 
+Proto4z.AttrHashMap = {} --哈希表实现 
+Proto4z.AttrHashMap.__protoName = "AttrHashMap" 
+Proto4z.AttrHashMap.__protoDesc = "map" 
+Proto4z.AttrHashMap.__protoTypeK = "string" 
+Proto4z.AttrHashMap.__protoTypeV = "ui32" 
+do 
+    Proto4z.AttrHashMap.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        local parts, n = {false}, 0 
+        for k, v in pairs(obj) do 
+            n = n + 1 
+            parts[n + 1] = spack("<s4I4", (k or ""), ((v or 0) & 0xffffffff)) 
+        end 
+        parts[1] = spack("<I4", n) 
+        return concat(parts) 
+    end 
+    Proto4z.AttrHashMap.__decoder = function(bin, pos, result) 
+        local n, k, v 
+        n, pos = sunpack("<I4", bin, pos) 
+        for i = 1, n do 
+            k, v, pos = sunpack("<s4I4", bin, pos) 
+            result[k] = v 
+        end 
+        return pos 
+    end 
+end 
+ 
+Proto4z.register(30012,"BagPack") 
+Proto4z.BagPack = {}  
+Proto4z.BagPack.__protoID = 30012 
+Proto4z.BagPack.__protoName = "BagPack" 
+Proto4z.BagPack[1] = {name="items", type="ItemFlatMap" }  
+Proto4z.BagPack[2] = {name="attrs", type="AttrHashMap" }  
+do 
+    Proto4z.BagPack.__encoder = function(obj) 
+        if type(obj) ~= "table" then obj = empty end 
+        return Proto4z.ItemFlatMap.__encoder(obj.items) 
+            .. Proto4z.AttrHashMap.__encoder(obj.attrs) 
+    end 
+    Proto4z.BagPack.__decoder = function(bin, pos, result) 
+        result.items = {} 
+        pos = Proto4z.ItemFlatMap.__decoder(bin, pos, result.items) 
+        result.attrs = {} 
+        pos = Proto4z.AttrHashMap.__decoder(bin, pos, result.attrs) 
+        return pos 
+    end 
+end 